@@ -301,7 +301,13 @@ int HashTableErase(HashTable_t* table, const void* ukey, size_t ukey_size) {
 
 static int KeyCmp(const void *key1, size_t key1_size, const void *key2, size_t key2_size) {
     size_t min_size = MIN(key1_size, key2_size);
-    return memcmp(key1, key2, min_size);
+
+    int cmp = memcmp(key1, key2, min_size);
+    if (cmp != 0 || key1_size == key2_size) {
+        return cmp;
+    }
+
+    return key1_size < key2_size ? -1 : 1;
 }
 
 static uint32_t fnv_hash_to_index(const void* ukey, size_t ukey_size, uint32_t table_capacity) {
@@ -2,6 +2,7 @@
 #define AST_H
 
 #include <stddef.h>
+#include <stdbool.h>
 
 typedef enum AST_ElemType {
     AST_ELEM_TYPE_UNDEFINED,
@@ -31,6 +32,8 @@ typedef enum AST_ElemOperation {
     AST_ELEM_OPERATION_LAND,
     AST_ELEM_OPERATION_LOR,
 
+    AST_ELEM_OPERATION_SELECT,
+
     AST_ELEM_OPERATION_INPUT,
     AST_ELEM_OPERATION_PRINT,
 
@@ -79,9 +82,17 @@ typedef union AST_ElemData {
     Const constant;
 } AST_ElemData;
 
+typedef struct AST_Binding {
+    const struct AST_Node* declaration;     // identifier of the declaration, NULL if the name is not declared
+    unsigned int depth;                     // level of the scope, which frame keeps the cell
+    size_t slot;                            // offset of the cell in the frame
+} AST_Binding;
+
 typedef struct AST_Node {
     AST_ElemType type;
     AST_ElemData data;
+    ConstType value_type;   // type of the expression, filled by TypeInference
+    AST_Binding binding;    // cell of the variable, filled by VariableBinding
     struct AST_Node* parent;
     struct AST_Node* left;
     struct AST_Node* right;
@@ -103,7 +114,21 @@ AST_Err_t AST_Destroy(AST** ast);
 AST_Node* AST_NodeInit(AST_Node* parent, AST_Node* left, AST_Node* right, AST_ElemType type, ...);
 AST_Err_t AST_NodeDestroy(AST_Node** node_ptr);
 
+AST_Err_t AST_SubtreeDestroy(AST_Node* node);
+AST_Node* AST_SubtreeCopy(const AST_Node* node);
+
 size_t PostorderTraversal(AST_Node* node, AST_NodeFunc func);
 AST_Node** GetParentNodePointer(AST_Node* node);
 
+bool AST_IsOperation(const AST_Node* node, AST_ElemOperation operation);
+bool AST_IsFuncDec(const AST_Node* node);
+bool AST_IsVarDec(const AST_Node* node);
+
+AST_Node* AST_VarDecIdentifier(const AST_Node* var_dec);
+AST_Node* AST_VarDecInitializer(const AST_Node* var_dec);
+
+AST_Node* AST_ChainStatement(AST_Node* link);
+AST_Node* AST_ChainNext(const AST_Node* link);
+AST_Node* AST_ChainElse(const AST_Node* chain);
+
 #endif /* AST_H */
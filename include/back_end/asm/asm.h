@@ -108,7 +108,26 @@ typedef enum InstructionType {
     HLT     = 21,
     PUSHM   = 22,
     POPM    = 23,
-    MAIN    = 24
+    MAIN    = 24,
+    SHL     = 25,
+    SHR     = 26,
+    FADD    = 27,
+    FSUB    = 28,
+    FMUL    = 29,
+    FDIV    = 30,
+    FJA     = 31,
+    FJAE    = 32,
+    FJB     = 33,
+    FJBE    = 34,
+    FJE     = 35,
+    FJNE    = 36,
+    ITOF    = 37,
+    FTOI    = 38,
+    FPUSH   = 39,
+    FOUT    = 40,
+    SELECT  = 41,
+    PUSHL   = 42,
+    POPL    = 43
 } InstructionType;
 
 typedef enum RegsType {
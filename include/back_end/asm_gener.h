@@ -1,11 +1,17 @@
 #ifndef ASM_GENER_H
 #define ASM_GENER_H
 
+#include <stddef.h>
+#include <stdbool.h>
+
 #include "back_end.h"
 
 typedef struct AST AST;
 typedef struct Buffer_t Buffer_t;
+typedef struct CallGraph CallGraph;
+
+BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code, bool memoize, CallGraph* call_graph);
 
-BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code);
+char* CntLabel(const char* s, size_t cnt);
 
 #endif /* ASM_GENER_H */
\ No newline at end of file
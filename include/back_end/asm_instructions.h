@@ -5,88 +5,101 @@
 
 const int MAX_LEN = 256;
 
-const char* asm_base =              "PUSH 0\n"
-                                    "POPR RAX\n\n"
-                                    "PUSH 0\n"
-                                    "POPR RBX\n\n"
-                                    "PUSH 0\n"
-                                    "POPR RCX\n\n"
-                                    "CALL main\n"
-                                    "HLT\n\n\n";
-
-const char* move_rax_by_one =       ": move_rax_by_one\n"
-                                    "PUSH 1\n"
-                                    "PUSHR RAX\n"
-                                    "ADD\n"
-                                    "POPR RAX\n"
-                                    "RET\n\n\n";
-
-const char* move_rax_by_one_call =  "CALL move_rax_by_one\n";
-
-const char* enter_scope =           ": enter_scope\n"
-                                    "PUSHR RBX\n"
-                                    "POPM [RAX]\n"
-                                    "PUSHR RAX\n"
-                                    "POPR  RBX\n"
-                                    "CALL move_rax_by_one\n"
-                                    "RET\n\n\n";
-
-const char* enter_scope_call =      "CALL enter_scope\n";
-
-const char* exit_scope =            ": exit_scope\n"
-                                    "PUSHR RBX\n"
-                                    "POPR RAX\n"
-                                    "PUSHM [RBX]\n"
-                                    "POPR RBX\n"
-                                    "RET\n\n\n";
-
-const char* exit_scope_call =       "CALL exit_scope\n";
-
-const char* set_rcx_offset =        ": set_rcx_offset\n"
-                                    "PUSHR RCX\n"
-                                    "ADD\n"
-                                    "POPR RCX\n"
-                                    "RET\n\n\n";
-
-const char* get_rcx_by_offset =     ": get_rcx_by_offset\n"
-                                    "CALL set_rcx_offset\n"
-                                    "PUSHM [RCX]\n"
-                                    "RET\n\n\n";
-
-const char* set_rcx_by_offset =     ": set_rcx_by_offset\n"
-                                    "CALL set_rcx_offset\n"
-                                    "POPM [RCX]\n"
-                                    "RET\n\n\n";
-
-const char* bool_cmp =              " false_comparison_result#\n"
-                                    "PUSH 1\n"
-                                    "JMP truth_comparison_result#\n"
-                                    ":   false_comparison_result#\n"
-                                    "PUSH 0\n"
-                                    ":   truth_comparison_result#\n\n";
-
-const char* unary_bool_cmp =        "PUSH 1\n"
-                                    "JA false_comparison_result#\n"
-                                    "PUSH 1\n"
-                                    "JMP truth_comparison_result#\n"
-                                    ":   false_comparison_result#\n"
-                                    "PUSH 0\n"
-                                    ":   truth_comparison_result#\n\n";
-
-const char* ram_push =              "POPM [RAX]\n"
-                                    "CALL move_rax_by_one\n\n";
-
-const char* ret =                   "RET\n\n";
-
-const char* out =                   "OUT\n\n";
-
-const char* if_statement =          "PUSH 1\n"
-                                    "JA endif#\n\n";
-
-const char* begif =                 ": begif#\n\n";
-
-const char* begif_jmp =             "JMP begif#\n";
-
-const char* endif =                 ": endif#\n\n";
+const char* const asm_base =              "PUSH 0\n"
+                                          "POPR RAX\n\n"
+                                          "PUSH 0\n"
+                                          "POPR RBX\n\n"
+                                          "PUSH 0\n"
+                                          "POPR RCX\n\n";
+
+const char* const call_main =             "CALL main\n"
+                                          "HLT\n\n\n";
+
+const char* const move_rax_by_one =       ": move_rax_by_one\n"
+                                          "PUSH 1\n"
+                                          "PUSHR RAX\n"
+                                          "ADD\n"
+                                          "POPR RAX\n"
+                                          "RET\n\n\n";
+
+const char* const move_rax_by_one_call =  "CALL move_rax_by_one\n";
+
+const char* const enter_scope =           ": enter_scope\n"
+                                          "PUSHR RBX\n"
+                                          "POPM [RAX]\n"
+                                          "PUSHR RAX\n"
+                                          "POPR  RBX\n"
+                                          "CALL move_rax_by_one\n"
+                                          "RET\n\n\n";
+
+const char* const enter_scope_call =      "CALL enter_scope\n";
+
+const char* const exit_scope =            ": exit_scope\n"
+                                          "PUSHR RBX\n"
+                                          "POPR RAX\n"
+                                          "PUSHM [RBX]\n"
+                                          "POPR RBX\n"
+                                          "RET\n\n\n";
+
+const char* const exit_scope_call =       "CALL exit_scope\n";
+
+const char* const drop_scope_vars =       "PUSH 1\n"
+                                          "PUSHR RBX\n"
+                                          "ADD\n"
+                                          "POPR RAX\n";
+
+const char* const set_rcx_offset =        ": set_rcx_offset\n"
+                                          "PUSHR RCX\n"
+                                          "ADD\n"
+                                          "POPR RCX\n"
+                                          "RET\n\n\n";
+
+const char* const get_rcx_by_offset =     ": get_rcx_by_offset\n"
+                                          "CALL set_rcx_offset\n"
+                                          "PUSHM [RCX]\n"
+                                          "RET\n\n\n";
+
+const char* const set_rcx_by_offset =     ": set_rcx_by_offset\n"
+                                          "CALL set_rcx_offset\n"
+                                          "POPM [RCX]\n"
+                                          "RET\n\n\n";
+
+const char* const bool_cmp =              " false_comparison_result#\n"
+                                          "PUSH 1\n"
+                                          "JMP truth_comparison_result#\n"
+                                          ":   false_comparison_result#\n"
+                                          "PUSH 0\n"
+                                          ":   truth_comparison_result#\n\n";
+
+const char* const unary_bool_cmp =        "PUSH 1\n"
+                                          "JA false_comparison_result#\n"
+                                          "PUSH 1\n"
+                                          "JMP truth_comparison_result#\n"
+                                          ":   false_comparison_result#\n"
+                                          "PUSH 0\n"
+                                          ":   truth_comparison_result#\n\n";
+
+const char* const ram_push =              "POPM [RAX]\n"
+                                          "CALL move_rax_by_one\n\n";
+
+const char* const ret =                   "RET\n\n";
+
+const char* const out =                   "OUT\n\n";
+
+const char* const float_out =             "FOUT\n\n";
+
+const char* const endif_name =            "endif#";
+
+const char* const logic_name =            "logic#";
+
+const char* const begif =                 ": begif#\n\n";
+
+const char* const begif_jmp =             "JMP begif#\n";
+
+const char* const endif =                 ": endif#\n\n";
+
+const char* const endif_jmp =             "JMP endif#\n";
+
+const char* const else_name =             "else#";
 
 #endif /* ASM_INSTRUCTIONS_H */
\ No newline at end of file
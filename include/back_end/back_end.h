@@ -1,6 +1,11 @@
 #ifndef BACK_END_H
 #define BACK_END_H
 
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "../middle_end/call_graph.h"
+
 typedef enum BackEndErr_t {
     BACK_END_OK,
     BACK_END_ERROR,
@@ -9,7 +14,17 @@ typedef enum BackEndErr_t {
 } BackEndErr_t;
 
 typedef struct AST AST;
+typedef struct IR_Module IR_Module;
+
+typedef struct BackEndOptions {
+    bool memoize;               // the tree back end only
+    bool peephole;
+    CallGraph* call_graph;      // bounds of the program are written after the bytecode, may be NULL
+    long peephole_delta;        // filled by the back end: change of the instructions count by the peephole pass
+    StackBounds bounds;         // filled by the back end: the written bounds
+} BackEndOptions;
 
-BackEndErr_t BackEnd(AST* ast);
+BackEndErr_t BackEnd(AST* ast, BackEndOptions* options);
+BackEndErr_t BackEndIR(IR_Module* module, BackEndOptions* options);
 
-#endif /* BACK_END_H */
\ No newline at end of file
+#endif /* BACK_END_H */
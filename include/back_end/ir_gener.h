@@ -0,0 +1,12 @@
+#ifndef IR_GENER_H
+#define IR_GENER_H
+
+#include "back_end.h"
+
+typedef struct IR_Module IR_Module;
+typedef struct Buffer_t Buffer_t;
+typedef struct CallGraph CallGraph;
+
+BackEndErr_t IR_AssemblyCodeGeneration(IR_Module* module, Buffer_t* assembly_code, CallGraph* call_graph);
+
+#endif /* IR_GENER_H */
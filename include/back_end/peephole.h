@@ -0,0 +1,12 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stddef.h>
+
+#include "back_end.h"
+
+typedef struct Buffer_t Buffer_t;
+
+BackEndErr_t PeepholeOptimization(Buffer_t* assembly_code, long* size_delta);
+
+#endif /* PEEPHOLE_H */
@@ -0,0 +1,18 @@
+#ifndef SLOT_COLORING_H
+#define SLOT_COLORING_H
+
+#include <stddef.h>
+
+#include "back_end.h"
+
+typedef struct AST_Node AST_Node;
+typedef struct Buffer_t Buffer_t;
+
+typedef struct FrameSlot {
+    const AST_Node* var_dec;
+    size_t slot;                // index among the cells of the locals in the function frame
+} FrameSlot;
+
+BackEndErr_t StackSlotColoring(const AST_Node* func_dec, Buffer_t* frame_slots, size_t* slots_cnt);
+
+#endif /* SLOT_COLORING_H */
@@ -0,0 +1,19 @@
+#ifndef VARIABLE_BINDING_H
+#define VARIABLE_BINDING_H
+
+#include <stddef.h>
+
+#include "back_end.h"
+
+typedef struct AST_Node AST_Node;
+typedef struct Buffer_t Buffer_t;
+
+typedef struct FrameLayout {
+    const AST_Node* func_dec;
+    size_t hidden_cnt;          // cells of the generator between the parameters and the locals
+    size_t locals_cnt;          // colored cells of the locals
+} FrameLayout;
+
+BackEndErr_t VariableBinding(AST* ast, Buffer_t* frames);
+
+#endif /* VARIABLE_BINDING_H */
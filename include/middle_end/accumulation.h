@@ -0,0 +1,10 @@
+#ifndef ACCUMULATION_H
+#define ACCUMULATION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t AccumulatorTransformation(AST* ast, size_t* transformed_cnt);
+
+#endif /* ACCUMULATION_H */
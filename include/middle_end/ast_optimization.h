@@ -1,5 +1,14 @@
 #ifndef AST_OPTIMIZATION_H
 #define AST_OPTIMIZATION_H
 
+#include <stddef.h>
+#include <stdbool.h>
 
-#endif /* AST_OPTIMIZATION_H */
\ No newline at end of file
+#include "../ast/ast.h"
+#include "middle_end.h"
+
+MiddleEndErr_t ConstantFolding(AST* ast, size_t* folded_cnt);
+
+bool EvalOperation(AST_ElemOperation operation, int left, int right, int* result);
+
+#endif /* AST_OPTIMIZATION_H */
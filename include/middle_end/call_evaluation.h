@@ -0,0 +1,10 @@
+#ifndef CALL_EVALUATION_H
+#define CALL_EVALUATION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t CallEvaluation(AST* ast, size_t* evaluated_cnt);
+
+#endif /* CALL_EVALUATION_H */
@@ -0,0 +1,35 @@
+#ifndef CALL_GRAPH_H
+#define CALL_GRAPH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "middle_end.h"
+
+typedef struct CallGraphFunc {
+    const char* name;
+    AST_Node* func_dec;
+    Buffer_t* callees;      // size_t, indices of the called functions, each one once
+    size_t scc;             // strongly connected component, callees get the smaller ids
+    bool recursive;         // the function may call itself, directly or not
+    size_t frame_size;      // RAM cells of the frame: link to the caller frame, parameters and locals
+} CallGraphFunc;
+
+typedef struct CallGraph {
+    Buffer_t* funcs;        // CallGraphFunc, in the order of the declarations
+    size_t static_size;     // RAM cells before the first frame: globals and tables of the back end
+} CallGraph;
+
+typedef struct StackBounds {
+    bool bounded;           // no recursion is reachable from the entry, the sizes below are never exceeded
+    size_t call_depth;      // return addresses on the call stack of the VM
+    size_t ram_size;        // RAM cells, the static part and the frames of the deepest call chain
+} StackBounds;
+
+CallGraph*     CallGraphInit(AST* ast);
+MiddleEndErr_t CallGraphDestroy(CallGraph** graph);
+
+CallGraphFunc* CallGraphFind(CallGraph* graph, const char* name);
+MiddleEndErr_t CallGraphBounds(const CallGraph* graph, const char* entry, size_t helpers_depth, StackBounds* bounds);
+
+#endif /* CALL_GRAPH_H */
@@ -0,0 +1,10 @@
+#ifndef CONSTANT_PROPAGATION_H
+#define CONSTANT_PROPAGATION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t ConstantPropagation(AST* ast, size_t* propagated_cnt);
+
+#endif /* CONSTANT_PROPAGATION_H */
@@ -0,0 +1,10 @@
+#ifndef DEAD_CODE_ELIMINATION_H
+#define DEAD_CODE_ELIMINATION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t DeadCodeElimination(AST* ast, size_t* removed_cnt);
+
+#endif /* DEAD_CODE_ELIMINATION_H */
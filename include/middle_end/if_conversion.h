@@ -0,0 +1,10 @@
+#ifndef IF_CONVERSION_H
+#define IF_CONVERSION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t IfConversion(AST* ast, size_t* converted_cnt);
+
+#endif /* IF_CONVERSION_H */
@@ -0,0 +1,10 @@
+#ifndef INLINING_H
+#define INLINING_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t FunctionInlining(AST* ast, size_t* inlined_cnt);
+
+#endif /* INLINING_H */
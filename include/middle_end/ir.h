@@ -0,0 +1,149 @@
+#ifndef IR_H
+#define IR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "../ast/ast.h"
+#include "middle_end.h"
+
+#define IR_NO_VALUE ((size_t)-1)
+#define IR_NO_BLOCK ((size_t)-1)
+
+typedef enum IR_Opcode {
+    IR_OP_NOP,
+
+    IR_OP_PARAM,    // dst = parameter number imm
+    IR_OP_CONST,    // dst = imm
+    IR_OP_COPY,     // dst = a
+
+    IR_OP_ADD,      // dst = a op b
+    IR_OP_SUB,
+    IR_OP_MUL,
+    IR_OP_DIV,
+    IR_OP_SHL,      // a << b, b >= 0
+    IR_OP_SHR,      // a >> b, b >= 0
+
+    IR_OP_LT,
+    IR_OP_GT,
+    IR_OP_LE,
+    IR_OP_GE,
+    IR_OP_EE,
+    IR_OP_NE,
+
+    IR_OP_LAND,
+    IR_OP_LOR,
+
+    IR_OP_INPUT,    // dst = input
+    IR_OP_PRINT,    // print a
+    IR_OP_CALL,     // dst = callee(call_args)
+    IR_OP_PHI,      // dst = phi(phi_args)
+
+    IR_OP_JUMP,     // goto targets[0]
+    IR_OP_BRANCH,   // a != 0 ? goto targets[0] : goto targets[1]
+    IR_OP_RETURN    // return a
+} IR_Opcode;
+
+typedef struct IR_PhiArg {
+    size_t block;
+    size_t value;
+} IR_PhiArg;
+
+typedef struct IR_Instr {
+    IR_Opcode opcode;
+    ConstType type;
+    size_t dst;
+    size_t args[2];
+    int imm;
+    size_t targets[2];
+    char* callee;
+    Buffer_t* call_args;    // size_t
+    Buffer_t* phi_args;     // IR_PhiArg
+} IR_Instr;
+
+typedef struct IR_Block {
+    size_t id;
+    Buffer_t* instrs;       // IR_Instr
+    Buffer_t* preds;        // size_t
+    Buffer_t* succs;        // size_t
+    size_t idom;            // valid after IR_ComputeDominators
+} IR_Block;
+
+typedef struct IR_Value {
+    char* name;             // source variable, NULL for temporaries
+    ConstType type;
+} IR_Value;
+
+typedef struct IR_Function {
+    char* name;
+    size_t param_cnt;
+    Buffer_t* blocks;       // IR_Block*, blocks[i]->id == i, blocks[0] is the entry
+    Buffer_t* values;       // IR_Value
+    bool is_ssa;
+} IR_Function;
+
+typedef struct IR_Loop {
+    size_t header;
+    bool* body;             // body[id] is true for the blocks of the loop, the header included
+    size_t size;
+} IR_Loop;
+
+typedef struct IR_Module {
+    Buffer_t* functions;    // IR_Function*
+} IR_Module;
+
+IR_Module*      IR_ModuleInit();
+MiddleEndErr_t  IR_ModuleDestroy(IR_Module** module);
+
+IR_Function*    IR_FunctionInit(const char* name);
+MiddleEndErr_t  IR_FunctionDestroy(IR_Function** func);
+IR_Function*    IR_FindFunction(const IR_Module* module, const char* name);
+
+IR_Block*       IR_BlockAdd(IR_Function* func);
+IR_Block*       IR_GetBlock(const IR_Function* func, size_t id);
+size_t          IR_BlockCount(const IR_Function* func);
+size_t          IR_InstrCount(const IR_Block* block);
+IR_Instr*       IR_GetInstr(const IR_Block* block, size_t idx);
+IR_Instr*       IR_Terminator(const IR_Block* block);
+
+size_t          IR_ValueAdd(IR_Function* func, const char* name, ConstType type);
+size_t          IR_ValueCount(const IR_Function* func);
+IR_Value*       IR_GetValue(const IR_Function* func, size_t value);
+
+IR_Instr        IR_InstrMake(IR_Opcode opcode, ConstType type, size_t dst, size_t a, size_t b);
+MiddleEndErr_t  IR_Emit(IR_Block* block, IR_Instr instr);
+MiddleEndErr_t  IR_Insert(IR_Block* block, size_t idx, IR_Instr instr);
+void            IR_InstrClear(IR_Instr* instr);
+void            IR_RemoveNops(IR_Function* func);
+void            IR_ReplaceUses(IR_Function* func, size_t old_value, size_t new_value);
+
+bool            IR_IsTerminator(IR_Opcode opcode);
+bool            IR_IsBinary(IR_Opcode opcode);
+bool            IR_IsCommutative(IR_Opcode opcode);
+bool            IR_HasSideEffects(const IR_Instr* instr);
+size_t          IR_OperandCount(const IR_Instr* instr);
+size_t*         IR_Operand(IR_Instr* instr, size_t idx);
+size_t          IR_SuccCount(const IR_Instr* terminator);
+
+MiddleEndErr_t  IR_BuildCFG(IR_Function* func);
+MiddleEndErr_t  IR_ComputeDominators(IR_Function* func);
+bool            IR_Dominates(const IR_Function* func, size_t dominator, size_t block);
+
+// ir_builder.c
+MiddleEndErr_t  IR_Build(AST* ast, IR_Module** module);
+
+// ir_ssa.c
+MiddleEndErr_t  IR_ConstructSSA(IR_Function* func);
+MiddleEndErr_t  IR_DestructSSA(IR_Function* func);
+MiddleEndErr_t  IR_ModuleToSSA(IR_Module* module);
+MiddleEndErr_t  IR_ModuleFromSSA(IR_Module* module);
+
+// ir_loops.c
+MiddleEndErr_t  IR_FindLoops(IR_Function* func, Buffer_t* loops);
+size_t          IR_LoopPreheader(const IR_Function* func, const IR_Loop* loop);
+void            IR_LoopsDestroy(Buffer_t** loops);
+
+// ir_verifier.c
+MiddleEndErr_t  IR_Verify(const IR_Module* module);
+
+#endif /* IR_H */
@@ -0,0 +1,13 @@
+#ifndef IR_DUMP_H
+#define IR_DUMP_H
+
+#include <stdio.h>
+
+#include "ir.h"
+
+const char* IR_GetStrOpcode(IR_Opcode opcode);
+
+void IR_DumpFunction(const IR_Function* func, FILE* fp);
+MiddleEndErr_t IR_Dump(const IR_Module* module, const char* file_name);
+
+#endif /* IR_DUMP_H */
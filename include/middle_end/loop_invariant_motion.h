@@ -0,0 +1,12 @@
+#ifndef LOOP_INVARIANT_MOTION_H
+#define LOOP_INVARIANT_MOTION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+typedef struct IR_Module IR_Module;
+
+MiddleEndErr_t LoopInvariantMotion(IR_Module* module, size_t* hoisted_cnt);
+
+#endif /* LOOP_INVARIANT_MOTION_H */
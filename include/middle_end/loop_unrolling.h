@@ -0,0 +1,10 @@
+#ifndef LOOP_UNROLLING_H
+#define LOOP_UNROLLING_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t LoopUnrolling(AST* ast, size_t* unrolled_cnt);
+
+#endif /* LOOP_UNROLLING_H */
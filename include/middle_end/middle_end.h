@@ -1,5 +1,32 @@
 #ifndef MIDDLE_END_H
 #define MIDDLE_END_H
 
+#include <stddef.h>
+#include <stdbool.h>
 
-#endif /* MIDDLE_END_H */
\ No newline at end of file
+typedef enum MiddleEndErr_t {
+    MIDDLE_END_OK,
+    MIDDLE_END_ERROR,
+    MIDDLE_END_BUFFER_FAILED,
+    MIDDLE_END_TYPE_ERROR
+} MiddleEndErr_t;
+
+typedef struct AST AST;
+typedef struct AST_Node AST_Node;
+typedef struct Buffer_t Buffer_t;
+typedef struct IR_Module IR_Module;
+
+bool HasSideEffects(const AST_Node* node);
+bool ContainsDivision(const AST_Node* node);
+AST_Node* FindFuncDec(AST* ast, const char* func_name);
+MiddleEndErr_t CollectCallees(AST* ast, AST_Node* node, Buffer_t* callees);
+bool ContainsNode(const Buffer_t* nodes, const AST_Node* node);
+
+bool IsIntConst(const AST_Node* node);
+bool IsVariable(const AST_Node* node, const char* name);
+AST_Node* ChainAppend(AST_Node* chain, AST_Node* tail);
+bool IsCallName(const AST_Node* node);
+size_t CountUses(const AST_Node* node, const char* name);
+size_t SubtreeSize(const AST_Node* node);
+
+#endif /* MIDDLE_END_H */
@@ -0,0 +1,38 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "middle_end.h"
+
+typedef enum OptLevel {
+    OPT_LEVEL_0,    // no optimizations, only the analyses the back ends need
+    OPT_LEVEL_1,    // cheap local passes
+    OPT_LEVEL_2     // all passes
+} OptLevel;
+
+typedef struct PassStats {
+    const char* name;
+    size_t runs;
+    size_t changed_cnt;
+    long size_delta;        // in size_unit
+    const char* size_unit;  // "nodes" for AST passes, "instrs" for IR passes
+    double time_ms;
+} PassStats;
+
+typedef struct PassManager {
+    OptLevel level;
+    Buffer_t* stats;        // PassStats, in the order of the first run
+} PassManager;
+
+PassManager*   PassManagerInit(OptLevel level);
+MiddleEndErr_t PassManagerDestroy(PassManager** manager);
+
+MiddleEndErr_t PassManagerRunAST(PassManager* manager, AST* ast);
+MiddleEndErr_t PassManagerRunIR(PassManager* manager, IR_Module* module);
+
+void PassManagerDump(const PassManager* manager, FILE* stream);
+
+#endif /* PASS_MANAGER_H */
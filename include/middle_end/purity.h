@@ -0,0 +1,11 @@
+#ifndef PURITY_H
+#define PURITY_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t FindPureFunctions(AST* ast, Buffer_t* func_decs);
+MiddleEndErr_t FindMemoizableFunctions(AST* ast, Buffer_t* func_decs);
+
+#endif /* PURITY_H */
@@ -0,0 +1,10 @@
+#ifndef SPECIALIZATION_H
+#define SPECIALIZATION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+MiddleEndErr_t FunctionSpecialization(AST* ast, size_t* redirected_cnt);
+
+#endif /* SPECIALIZATION_H */
@@ -0,0 +1,12 @@
+#ifndef STRENGTH_REDUCTION_H
+#define STRENGTH_REDUCTION_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+typedef struct IR_Module IR_Module;
+
+MiddleEndErr_t StrengthReduction(IR_Module* module, size_t* reduced_cnt);
+
+#endif /* STRENGTH_REDUCTION_H */
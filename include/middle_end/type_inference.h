@@ -0,0 +1,12 @@
+#ifndef TYPE_INFERENCE_H
+#define TYPE_INFERENCE_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+typedef struct AST AST;
+
+MiddleEndErr_t TypeInference(AST* ast, size_t* error_cnt);
+
+#endif /* TYPE_INFERENCE_H */
@@ -0,0 +1,12 @@
+#ifndef VALUE_NUMBERING_H
+#define VALUE_NUMBERING_H
+
+#include <stddef.h>
+
+#include "middle_end.h"
+
+typedef struct IR_Module IR_Module;
+
+MiddleEndErr_t ValueNumbering(IR_Module* module, size_t* removed_cnt);
+
+#endif /* VALUE_NUMBERING_H */
@@ -0,0 +1,70 @@
+#ifndef SPU_H
+#define SPU_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "../back_end/asm/asm.h"
+
+const size_t SPU_INSTRUCTIONS_CNT = POPL + 1;
+
+typedef enum SPU_Err_t {
+    SPU_OK                  = 0,
+    SPU_FOPEN_FAILED        = 1,
+    SPU_FREAD_FAILED        = 2,
+    SPU_ALLOC_FAILED        = 3,
+
+    SPU_INVALID_INSTRUCTION = 4,
+    SPU_INVALID_ADDRESS     = 5,
+    SPU_INVALID_REGISTER    = 6,
+    SPU_STACK_UNDERFLOW     = 7,
+    SPU_STACK_OVERFLOW      = 8,
+    SPU_CALL_OVERFLOW       = 9,
+    SPU_RAM_OVERFLOW        = 10,
+    SPU_DIVISION_BY_ZERO    = 11,
+    SPU_INPUT_FAILED        = 12,
+    SPU_STEPS_LIMIT         = 13
+} SPU_Err_t;
+
+typedef struct SPU_Stats {
+    size_t steps;
+    size_t max_call_depth;
+    size_t ram_cells;                               // cells up to the highest touched one
+    size_t executed[SPU_INSTRUCTIONS_CNT];          // count of each instruction
+} SPU_Stats;
+
+/* a cell of the stacks and RAM is 8 bytes: a double is kept as its bytes */
+typedef struct SPU {
+    int* code;
+    size_t code_size;
+    size_t ip;
+
+    long* stack;
+    size_t stack_size;
+    size_t stack_capacity;
+
+    size_t* calls;                  // return addresses
+    size_t call_depth;
+    size_t call_capacity;
+
+    long* ram;
+    size_t ram_capacity;
+
+    long regs[RCX + 1];
+
+    size_t call_depth_bound;        // bounds from the end of the bytecode, 0 if the program is recursive
+    size_t ram_bound;
+
+    SPU_Stats stats;
+} SPU;
+
+SPU_Err_t SPU_Load(SPU* spu, const char* file_name);
+SPU_Err_t SPU_Destroy(SPU* spu);
+
+SPU_Err_t SPU_Run(SPU* spu, FILE* in, FILE* out);
+
+const char* SPU_InstructionName(size_t instruction);
+const char* SPU_ErrorName(SPU_Err_t error);
+void SPU_DumpStats(const SPU* spu, FILE* fp);
+
+#endif /* SPU_H */
@@ -7,6 +7,7 @@
 
 #include "../../clibs/Stack/include/stack.h"
 #include "../../clibs/HashTable/include/hash_table.h"
+#include "../../clibs/Buffer/include/buffer.h"
 
 typedef enum SymbolType {
     SYM_TYPE_VARIABLE,
@@ -32,16 +33,37 @@ typedef struct SymbolData {
     size_t       symbol_ram_offset;
 } SymbolData;
 
+const size_t SYM_TAB_NO_BINDING = (size_t)-1;
+
+const size_t SCOPE_INLINE_SYMBOLS = 8;     // symbols of the scope, whose redeclaration is checked without the hashing
+
 typedef struct Scope {
     size_t        scope_ram_offset;
     unsigned int  level;
-    HashTable_t*  symbols;
+    bool          active;                   // false while the branch of the scope is put aside
+    size_t        symbols_cnt;
+    size_t        inline_bindings[SCOPE_INLINE_SYMBOLS];    // undo log of the first bindings of the scope
+    size_t        last_binding;             // undo log of the rest: they are linked from the last one
     struct Scope* prev;
 } Scope;
 
+/* binding of the name in the scope, the bindings of the same name shadow each other */
+typedef struct SymbolBinding {
+    const char* name;                       // is not copied, it must live as long as the scope
+    SymbolData  data;
+    Scope*      scope;
+    size_t*     innermost;                  // slot of the name in the map
+    size_t      shadowed;                   // outer binding of the name
+    size_t      scope_next;                 // earlier binding of the scope, the next free one in the free list
+} SymbolBinding;
+
 typedef struct SymbolTable {
     Scope* global_scope;
     Scope* current_scope;
+    Scope* free_scopes;                     // exited scopes linked by prev, the next scopes reuse them
+    HashTable_t* names;                     // name -> index of its innermost binding
+    Buffer_t* bindings;                     // SymbolBinding
+    size_t free_bindings;                   // bindings of the exited scopes linked by scope_next
     Stack_t* end_scopes;
 } SymbolTable;
 
@@ -49,13 +71,16 @@ typedef enum SymbolTableErr_t {
     SYM_TAB_OK,
     SYM_TAB_CALLOC_SCOPE_FAILED,
     SYM_TAB_STACK_FAILED,
-    SYM_TAB_HASH_TABLE_FAILED
+    SYM_TAB_HASH_TABLE_FAILED,
+    SYM_TAB_BUFFER_FAILED,
+    SYM_TAB_REDECLARED
 } SymbolTableErr_t;
 
 SymbolTable*     SymbolTableInit();
 SymbolTableErr_t SymbolTableDestroy(SymbolTable** table_ptr);
 
 SymbolTableErr_t SymbolTableEnterScope(SymbolTable* table);
+SymbolTableErr_t SymbolTableEnterBlock(SymbolTable* table);
 SymbolTableErr_t SymbolTableExitScope(SymbolTable* table);
 
 SymbolTableErr_t SymbolTableNewBranch(SymbolTable* table);
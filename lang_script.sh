@@ -9,12 +9,17 @@ front_end="src/front_end/front_end.c src/front_end/lexer.c src/front_end/syntax.
 ast="src/ast/ast.c src/ast/ast_dump.c"
 asm="src/back_end/asm/asm.c src/back_end/asm/asm_dump.c"
 symbol_table="src/symbol_table/symbol_table.c src/symbol_table/symbol_table_dump.c"
-back_end="src/back_end/back_end.c src/back_end/asm_gener.c $asm"
+middle_end="src/middle_end/middle_end.c src/middle_end/accumulation.c src/middle_end/ast_optimization.c src/middle_end/call_evaluation.c src/middle_end/call_graph.c src/middle_end/constant_propagation.c src/middle_end/dead_code_elimination.c src/middle_end/if_conversion.c src/middle_end/inlining.c src/middle_end/loop_unrolling.c src/middle_end/pass_manager.c src/middle_end/purity.c src/middle_end/specialization.c src/middle_end/type_inference.c \
+src/middle_end/ir.c src/middle_end/ir_builder.c src/middle_end/ir_ssa.c src/middle_end/ir_verifier.c src/middle_end/ir_dump.c src/middle_end/ir_loops.c \
+src/middle_end/value_numbering.c src/middle_end/loop_invariant_motion.c src/middle_end/strength_reduction.c"
+back_end="src/back_end/back_end.c src/back_end/asm_gener.c src/back_end/ir_gener.c src/back_end/peephole.c src/back_end/slot_coloring.c src/back_end/variable_binding.c $asm"
 io="src/io.c"
+spu="src/spu/spu.c"
 
 mode_flag="-D _DEBUG"
 
-source="g++ main.c $front_end $ast $symbol_table $back_end $io $list $stack $hash_table $buffer -o lang"
+source="g++ main.c $front_end $ast $symbol_table $middle_end $back_end $io $list $stack $hash_table $buffer -o lang"
+spu_source="g++ spu_main.c $spu -o spu"
 
 flags=" \
 $mode_flag -ggdb3 -std=c++17 -O0 -Wall -Wextra -Weffc++ -Waggressive-loop-optimizations -Wc++14-compat \
@@ -30,5 +35,7 @@ $mode_flag -ggdb3 -std=c++17 -O0 -Wall -Wextra -Weffc++ -Waggressive-loop-optimi
 "
 
 command="$source $flags"
+spu_command="$spu_source $flags"
 
 $command
+$spu_command
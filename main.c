@@ -1,20 +1,131 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "include/ast/ast.h"
 #include "include/front_end/front_end.h"
+#include "include/middle_end/middle_end.h"
+#include "include/middle_end/pass_manager.h"
+#include "include/middle_end/call_graph.h"
+#include "include/middle_end/ir.h"
+#include "include/middle_end/ir_dump.h"
 #include "include/back_end/back_end.h"
 
 const char* file_name = "syntax_test.c";
+const char* ir_dump_file_name = "ir_dump.txt";
+
+static int LowerThroughIR(AST* ast, PassManager* manager, bool use_ssa, BackEndOptions* options);
+
+/*
+ * -ir      generate the code from the linear IR, its text goes to ir_dump_file_name,
+ *          functions must not use global variables, the IR has no storage for them
+ * -ssa     with -ir, optimize the IR in SSA form
+ * -memo    remember results of the pure recursive functions, the tree back end only
+ * -O0..-O2 optimization level, -O2 by default, -O0 also turns off the peephole pass of the back ends
+ * -stats   print time, changes and size delta of each pass and the bounds of the program to stderr
+ */
+int main(int argc, char* argv[]) {
+    bool use_ir  = false;
+    bool use_ssa = false;
+    bool memoize = false;
+    bool stats   = false;
+    OptLevel level = OPT_LEVEL_2;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-ir") == 0) {
+            use_ir = true;
+        } else if (strcmp(argv[i], "-ssa") == 0) {
+            use_ssa = true;
+        } else if (strcmp(argv[i], "-memo") == 0) {
+            memoize = true;
+        } else if (strcmp(argv[i], "-stats") == 0) {
+            stats = true;
+        } else if (strcmp(argv[i], "-O0") == 0) {
+            level = OPT_LEVEL_0;
+        } else if (strcmp(argv[i], "-O1") == 0) {
+            level = OPT_LEVEL_1;
+        } else if (strcmp(argv[i], "-O2") == 0) {
+            level = OPT_LEVEL_2;
+        } else {
+            fprintf(stderr, "Unknown flag \"%s\"\n", argv[i]);
+            return 1;
+        }
+    }
+
+    PassManager* manager = PassManagerInit(level);
+    if (manager == NULL) {
+        return 1;
+    }
 
-int main() {
     AST* ast = NULL;
 
     FrontEnd(&ast, file_name);
 
-    BackEnd(ast);
-    
+    int status = 0;
+
+    BackEndOptions options = {
+        .memoize        = memoize,
+        .peephole       = level != OPT_LEVEL_0,
+        .call_graph     = NULL,
+        .peephole_delta = 0,
+        .bounds         = {}
+    };
+
+    if (PassManagerRunAST(manager, ast) != MIDDLE_END_OK) {
+        status = 1;
+    } else {
+        // the calls do not change after the tree passes
+        options.call_graph = CallGraphInit(ast);
+
+        if (use_ir) {
+            status = LowerThroughIR(ast, manager, use_ssa, &options);
+        } else {
+            BackEnd(ast, &options);
+        }
+    }
+
+    if (stats) {
+        PassManagerDump(manager, stderr);
+        fprintf(stderr, "peephole: %+ld instructions\n", options.peephole_delta);
+
+        if (options.bounds.bounded) {
+            fprintf(stderr, "bounds: call depth %zu, RAM %zu cells\n", options.bounds.call_depth, options.bounds.ram_size);
+        } else {
+            fprintf(stderr, "bounds: recursive program\n");
+        }
+    }
+
+    if (options.call_graph != NULL) {
+        CallGraphDestroy(&options.call_graph);
+    }
+
     AST_Destroy(&ast);
+    PassManagerDestroy(&manager);
+
+    return status;
+}
+
+static int LowerThroughIR(AST* ast, PassManager* manager, bool use_ssa, BackEndOptions* options) {
+    IR_Module* module = NULL;
+
+    MiddleEndErr_t flag = IR_Build(ast, &module);
+    if (flag != MIDDLE_END_OK) {
+        return 1;
+    }
+
+    flag = IR_Verify(module);
+
+    if (flag == MIDDLE_END_OK && use_ssa) {
+        flag = PassManagerRunIR(manager, module);
+    }
+
+    IR_Dump(module, ir_dump_file_name);
+
+    if (flag == MIDDLE_END_OK && BackEndIR(module, options) != BACK_END_OK) {
+        flag = MIDDLE_END_ERROR;
+    }
+
+    IR_ModuleDestroy(&module);
 
-    return 0;
-}
\ No newline at end of file
+    return flag == MIDDLE_END_OK ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/spu/spu.h"
+
+const char* bytecode_file_name = "bytecode.bin";
+
+/*
+ * Reference executor of the bytecode, which the compiler writes.
+ * spu [file] [-stats]
+ * -stats   print the steps, the call depth, RAM and the executed instructions to stderr
+ */
+int main(int argc, char* argv[]) {
+    const char* file_name = bytecode_file_name;
+    bool stats = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-stats") == 0) {
+            stats = true;
+        } else if (argv[i][0] != '-') {
+            file_name = argv[i];
+        } else {
+            fprintf(stderr, "Unknown flag \"%s\"\n", argv[i]);
+            return 1;
+        }
+    }
+
+    SPU spu = {};
+
+    SPU_Err_t flag = SPU_Load(&spu, file_name);
+    if (flag != SPU_OK) {
+        fprintf(stderr, "spu: %s \"%s\"\n", SPU_ErrorName(flag), file_name);
+        return 1;
+    }
+
+    flag = SPU_Run(&spu, stdin, stdout);
+    if (flag != SPU_OK) {
+        fprintf(stderr, "spu: %s at %zu\n", SPU_ErrorName(flag), spu.ip);
+    }
+
+    if (stats) {
+        SPU_DumpStats(&spu, stderr);
+    }
+
+    SPU_Destroy(&spu);
+
+    return flag == SPU_OK ? 0 : 1;
+}
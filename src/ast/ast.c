@@ -45,6 +45,7 @@ AST_Node* AST_NodeInit(AST_Node* parent, AST_Node* left, AST_Node* right, AST_El
     node->right = right;
     node->type = type;
     node->data.variable = NULL;
+    node->value_type = CONST_TYPE_UNDEFINED;
 
     if (node->left) {
         node->left->parent = node;
@@ -206,3 +207,132 @@ AST_Node** GetParentNodePointer(AST_Node* node) {
     fprintf(stderr, "GetParentNodePointer failed!\n");
     return NULL;
 }
+
+/* detaches node from its parent and destroys the whole subtree */
+AST_Err_t AST_SubtreeDestroy(AST_Node* node) {
+    assert( node != NULL );
+
+    AST_Node** parent_ptr = GetParentNodePointer(node);
+    if (parent_ptr != NULL) {
+        *parent_ptr = NULL;
+    }
+
+    node->parent = NULL;
+    PostorderTraversal(node, AST_NodeDestroy);
+
+    return AST_OK;
+}
+
+/* deep copy, parent of the returned node is NULL */
+AST_Node* AST_SubtreeCopy(const AST_Node* node) {
+    if (node == NULL) {
+        return NULL;
+    }
+
+    AST_Node* copy = (AST_Node*)calloc(1, sizeof(AST_Node));
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->type = node->type;
+    copy->data = node->data;
+    copy->value_type = node->value_type;
+    copy->parent = NULL;
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        copy->data.variable = strdup(node->data.variable);
+    }
+
+    copy->left  = AST_SubtreeCopy(node->left);
+    copy->right = AST_SubtreeCopy(node->right);
+
+    if (copy->left != NULL) {
+        copy->left->parent = copy;
+    }
+    if (copy->right != NULL) {
+        copy->right->parent = copy;
+    }
+
+    return copy;
+}
+
+bool AST_IsOperation(const AST_Node* node, AST_ElemOperation operation) {
+    return node != NULL && node->type == AST_ELEM_TYPE_OPERATION && node->data.operation == operation;
+}
+
+bool AST_IsFuncDec(const AST_Node* node) {
+    return     node != NULL && node->type == AST_ELEM_TYPE_DECLARATION
+            && node->right != NULL && node->right->type == AST_ELEM_TYPE_VARIABLE
+            && node->right->right != NULL;
+}
+
+bool AST_IsVarDec(const AST_Node* node) {
+    return node != NULL && node->type == AST_ELEM_TYPE_DECLARATION && !AST_IsFuncDec(node);
+}
+
+AST_Node* AST_VarDecIdentifier(const AST_Node* var_dec) {
+    assert( AST_IsVarDec(var_dec) );
+
+    if (AST_IsOperation(var_dec->right, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        return var_dec->right->left;
+    }
+
+    return var_dec->right;
+}
+
+AST_Node* AST_VarDecInitializer(const AST_Node* var_dec) {
+    assert( AST_IsVarDec(var_dec) );
+
+    if (AST_IsOperation(var_dec->right, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        return var_dec->right->right;
+    }
+
+    return NULL;
+}
+
+/* 
+ * Block is a chain of sentinels (statement in left, next link in right),
+ * which may be terminated by return node. The right of the last sentinel
+ * of if-block holds "else if"/"else" part of the statement.
+ */
+AST_Node* AST_ChainStatement(AST_Node* link) {
+    assert( link != NULL );
+
+    if (AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)) {
+        return link->left;
+    }
+
+    return link;
+}
+
+AST_Node* AST_ChainNext(const AST_Node* link) {
+    assert( link != NULL );
+
+    if (!AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)) {
+        return NULL;
+    }
+
+    if (    AST_IsOperation(link->right, AST_ELEM_OPERATION_SENTINEL) 
+         || AST_IsOperation(link->right, AST_ELEM_OPERATION_RETURN) ) {
+        return link->right;
+    }
+
+    return NULL;
+}
+
+AST_Node* AST_ChainElse(const AST_Node* chain) {
+    assert( chain != NULL );
+
+    const AST_Node* link = chain;
+    while (AST_ChainNext(link) != NULL) {
+        link = AST_ChainNext(link);
+    }
+
+    if (    AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL) 
+         && (   AST_IsOperation(link->right, AST_ELEM_OPERATION_IF) 
+             || AST_IsOperation(link->right, AST_ELEM_OPERATION_ELSE))) {
+        return link->right;
+    }
+
+    return NULL;
+}
@@ -36,6 +36,8 @@ AST_OperationMapping ast_operation_dict[] = {
     {"&&"    ,      AST_ELEM_OPERATION_LAND      },
     {"||"    ,      AST_ELEM_OPERATION_LOR       },
 
+    {"select",      AST_ELEM_OPERATION_SELECT    },
+
     {"input" ,      AST_ELEM_OPERATION_INPUT     },
     {"print" ,      AST_ELEM_OPERATION_PRINT     },
 
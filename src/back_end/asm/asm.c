@@ -58,7 +58,26 @@ InstructionMapping instruction_template_list[] = {
     {"RBX"  ,   RBX  },
     {"RCX"  ,   RCX  },
     {"PUSHM",   PUSHM},
-    {"POPM" ,   POPM }
+    {"POPM" ,   POPM },
+    {"SHL"  ,   SHL  },
+    {"SHR"  ,   SHR  },
+    {"FADD" ,   FADD },
+    {"FSUB" ,   FSUB },
+    {"FMUL" ,   FMUL },
+    {"FDIV" ,   FDIV },
+    {"FJA"  ,   FJA  },
+    {"FJAE" ,   FJAE },
+    {"FJB"  ,   FJB  },
+    {"FJBE" ,   FJBE },
+    {"FJE"  ,   FJE  },
+    {"FJNE" ,   FJNE },
+    {"ITOF" ,   ITOF },
+    {"FTOI" ,   FTOI },
+    {"FPUSH",   FPUSH},
+    {"FOUT" ,   FOUT },
+    {"SELECT",  SELECT},
+    {"PUSHL",   PUSHL},
+    {"POPL" ,   POPL }
 };
 
 size_t instruction_template_list_size = sizeof(instruction_template_list)/sizeof(InstructionMapping);
@@ -184,7 +203,7 @@ static AssemblerErr_t FirstIteration(Assembler* assembler, HashTable_t* labels)
     for (size_t i = 0; arr[i] != '\0'; ) {
         i = AssemblerSkipSpaces(assembler, i);
 
-        if (arr[i] == ':') {
+        while (arr[i] == ':') {
             size_t start = i; ++i;
             i = AssemblerSkipSpaces(assembler, i);
 
@@ -203,6 +222,8 @@ static AssemblerErr_t FirstIteration(Assembler* assembler, HashTable_t* labels)
             for (size_t j = start; j < i; j++) {
                 arr[j] = ' ';
             }
+
+            i = AssemblerSkipSpaces(assembler, i);
         }
 
         i = AssemblerSkipSpaces(assembler, i);
@@ -252,6 +273,26 @@ static AssemblerErr_t SecondIteration(Assembler* assembler, HashTable_t* labels,
             CHECK_FLAG()
             break;
         }
+
+        // operand is the offset of the cell in the frame of RBX
+        case PUSHL:
+        case POPL: {
+            i = AssemblerPush(assembler, &flag, i, 'n');
+            CHECK_FLAG()
+            break;
+        }
+
+        // double is given by the two words of its bytes, low one first
+        case FPUSH: {
+            i = AssemblerPush(assembler, &flag, i, 'n');
+            CHECK_FLAG()
+
+            i = AssemblerSkipSpaces(assembler, i);
+
+            i = AssemblerPush(assembler, &flag, i, 'n');
+            CHECK_FLAG()
+            break;
+        }
         
         case PUSHR:
         case POPR: {
@@ -267,6 +308,12 @@ static AssemblerErr_t SecondIteration(Assembler* assembler, HashTable_t* labels,
         case JE:
         case JNE:
         case JMP:
+        case FJA:
+        case FJAE:
+        case FJB:
+        case FJBE:
+        case FJE:
+        case FJNE:
         case CALL: {
             i = AssemblerPush(assembler, &flag, i, 'l', labels);
             CHECK_FLAG()
@@ -280,6 +327,20 @@ static AssemblerErr_t SecondIteration(Assembler* assembler, HashTable_t* labels,
             break;
         }
 
+        // operand is the conditional jump, which checks the compared values
+        case SELECT: {
+            InstructionType jump_type = UNDEF;
+
+            i = AssemblerPush(assembler, &flag, i, 'i', instruction_templates, &jump_type);
+            CHECK_FLAG()
+
+            ASM_VERIFY(
+                assembler, (JA <= jump_type && jump_type <= JNE) || (FJA <= jump_type && jump_type <= FJNE),
+                'a', ASM_INVALID_INSTRUCTION, return ASM_INVALID_INSTRUCTION;
+            );
+            break;
+        }
+
         case MAIN: {
             assembler->start_ip = assembler->bytecode->meta.size;
             CHECK_FLAG()
@@ -294,6 +355,15 @@ static AssemblerErr_t SecondIteration(Assembler* assembler, HashTable_t* labels,
         case SUB:
         case MUL:
         case DIV:
+        case SHL:
+        case SHR:
+        case FADD:
+        case FSUB:
+        case FMUL:
+        case FDIV:
+        case ITOF:
+        case FTOI:
+        case FOUT:
         case SQRT:
         case RET:
         case HLT: {
@@ -1,22 +1,40 @@
 #include "../../include/back_end/asm_gener.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 
 #include "../../include/ast/ast.h"
 #include "../../include/symbol_table/symbol_table.h"
 #include "../../include/symbol_table/symbol_table_dump.h"
 #include "../../include/back_end/asm_instructions.h"
+#include "../../include/back_end/variable_binding.h"
+#include "../../include/middle_end/purity.h"
+#include "../../include/middle_end/call_graph.h"
 #include "../../clibs/Buffer/include/buffer.h"
 
+const size_t MEMO_HASH_RANGE = 64;  // hash of the arguments is reduced to (-range, range)
+
+/* slot of the table is [result, filled, arguments...], the tables lie in RAM below the frames */
+typedef struct ASM_MemoTable {
+    const AST_Node* func_dec;
+    size_t base;
+    size_t params_cnt;
+} ASM_MemoTable;
+
 typedef struct ASM_GenerSetup {
     AST* ast;
     SymbolTable* symbol_table;
-    unsigned int scope_level;
     Buffer_t* assembly_code;
     size_t if_cnt;
     size_t while_cnt;
     size_t bool_cnt;
+    const char* func_name;          // function, which body is generated
+    unsigned int func_scope_level;  // level of its parameters scope
+    Buffer_t* memo_tables;          // ASM_MemoTable, empty without memoization
+    const ASM_MemoTable* memo;      // table of the generated function, NULL if it is not memoized
+    CallGraph* call_graph;          // its sizes get the memo tables and slots, may be NULL
+    Buffer_t* frames;               // FrameLayout of the functions, filled by VariableBinding
 } ASM_GenerSetup;
 
 static BackEndErr_t AST_NodeHandler(AST_Node* node, ASM_GenerSetup* backend);
@@ -26,14 +44,20 @@ static BackEndErr_t ExpressionHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t DeclarationHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t FuncCallHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t ReturnHandler(AST_Node* node, ASM_GenerSetup* backend);
+static BackEndErr_t TailCallHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t PrintHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t AssignmentHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t IfStatementHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t WhileStatementHandler(AST_Node* node, ASM_GenerSetup* backend);
+static void EnterBlockScope(ASM_GenerSetup* backend);
+static void ExitBlockScope(ASM_GenerSetup* backend);
+static bool IsBlockScope(const Scope* scope);
 
 static BackEndErr_t FuncDecHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t ParamDecHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t VarDecHandler(AST_Node* node, ASM_GenerSetup* backend);
+static BackEndErr_t LocalsHandler(AST_Node* node, ASM_GenerSetup* backend);
+static BackEndErr_t LocalDecHandler(AST_Node* node, ASM_GenerSetup* backend);
 
 static BackEndErr_t AddHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t SubHandler(AST_Node* node, ASM_GenerSetup* backend);
@@ -47,17 +71,34 @@ static BackEndErr_t GEHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t EEHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t NEHandler(AST_Node* node, ASM_GenerSetup* backend);
 
-static BackEndErr_t LandHandler(AST_Node* node, ASM_GenerSetup* backend);
-static BackEndErr_t LorHandler(AST_Node* node, ASM_GenerSetup* backend);
+static BackEndErr_t LogicHandler(AST_Node* node, ASM_GenerSetup* backend);
+static BackEndErr_t SelectHandler(AST_Node* node, ASM_GenerSetup* backend);
+static void BranchIfFalse(AST_Node* node, ASM_GenerSetup* backend, const char* label);
+static void BranchIfTrue(AST_Node* node, ASM_GenerSetup* backend, const char* label);
+static void ConditionJump(AST_Node* node, ASM_GenerSetup* backend, const char* label, bool jump_if);
+static const char* ConditionOperands(AST_Node* node, ASM_GenerSetup* backend, bool jump_if);
+static const char* ComparisonJump(AST_ElemOperation operation, bool jump_if, bool is_float);
+static void PushLabel(ASM_GenerSetup* backend, const char* label);
 
 static BackEndErr_t ConstHandler(AST_Node* node, ASM_GenerSetup* backend);
+static bool CompareOperands(AST_Node* node, ASM_GenerSetup* backend);
+static void ConvertValue(ASM_GenerSetup* backend, ConstType from, ConstType to);
+static bool IsFloat(ConstType type);
 
 static BackEndErr_t SetVariableHandler(AST_Node* node, ASM_GenerSetup* backend);
 static BackEndErr_t GetVariableHandler(AST_Node* node, ASM_GenerSetup* backend);
-
-char* CntLabel(const char* s, size_t cnt);
-
-BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code) {
+static void PushFrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset);
+static void PopFrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset);
+static void FrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset,
+                      const char* local_access, const char* access);
+
+static BackEndErr_t MemoTablesInit(ASM_GenerSetup* backend);
+static BackEndErr_t MemoLookUpHandler(ASM_GenerSetup* backend);
+static BackEndErr_t MemoStoreHandler(ASM_GenerSetup* backend);
+static void PushMemoSlotCell(ASM_GenerSetup* backend, size_t cell);
+static void PopMemoSlotCell(ASM_GenerSetup* backend, size_t cell);
+
+BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code, bool memoize, CallGraph* call_graph) {
     assert( ast != NULL );
     assert( assembly_code != NULL );
 
@@ -71,20 +112,55 @@ BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code) {
         return BACK_END_BUFFER_FAILED;
     }
 
+    Buffer_t* memo_tables = BufferInit(0, sizeof(ASM_MemoTable));
+    if (memo_tables == NULL) {
+        SymbolTableDestroy(&symbol_table);
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    Buffer_t* frames = BufferInit(0, sizeof(FrameLayout));
+    if (frames == NULL) {
+        BufferDestroy(&memo_tables);
+        SymbolTableDestroy(&symbol_table);
+        return BACK_END_BUFFER_FAILED;
+    }
+
     ASM_GenerSetup backend = {
         .ast = ast,
         .symbol_table = symbol_table,
-        .scope_level = 0,
         .assembly_code = assembly_code,
         .if_cnt = 0,
         .while_cnt = 0,
         .bool_cnt = 0,
+        .func_name = NULL,
+        .func_scope_level = 0,
+        .memo_tables = memo_tables,
+        .memo = NULL,
+        .call_graph = call_graph,
+        .frames = frames,
     };
 
     backend.symbol_table->global_scope->scope_ram_offset = 0;
 
     // Base
     BufferPush(assembly_code, asm_base,          strlen(asm_base));
+
+    if (memoize && MemoTablesInit(&backend) != BACK_END_OK) {
+        BufferDestroy(&backend.frames);
+        BufferDestroy(&backend.memo_tables);
+        SymbolTableDestroy(&backend.symbol_table);
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    // the memo tables have taken their hidden cells in the frames
+    if (VariableBinding(ast, backend.frames) != BACK_END_OK) {
+        BufferDestroy(&backend.frames);
+        BufferDestroy(&backend.memo_tables);
+        SymbolTableDestroy(&backend.symbol_table);
+        return BACK_END_SYMBOL_TABLE_FAILED;
+    }
+
+    BufferPush(assembly_code, call_main,         strlen(call_main));
     BufferPush(assembly_code, move_rax_by_one,   strlen(move_rax_by_one));
     BufferPush(assembly_code, enter_scope,       strlen(enter_scope));
     BufferPush(assembly_code, exit_scope,        strlen(exit_scope));
@@ -97,6 +173,8 @@ BackEndErr_t AssemblyCodeGeneration(AST* ast, Buffer_t* assembly_code) {
     // test
     // printf("%s", (char*)backend.assembly_code->data);
 
+    BufferDestroy(&backend.frames);
+    BufferDestroy(&backend.memo_tables);
     SymbolTableDestroy(&backend.symbol_table);
 
     return BACK_END_OK;
@@ -138,29 +216,27 @@ static BackEndErr_t AST_NodeHandler(AST_Node* node, ASM_GenerSetup* backend) {
 static BackEndErr_t SentinelHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
-    // fprintf(stderr, "Sc_l: %u, Sy_l: %u, %p\n", backend->scope_level, backend->symbol_table->current_scope->level, node);
 
-    if (backend->scope_level > backend->symbol_table->current_scope->level) {
-        if (backend->scope_level == backend->symbol_table->current_scope->level + 1) {
-            SymbolTableEnterScope(backend->symbol_table);
-            BufferPush(backend->assembly_code, enter_scope_call, strlen(enter_scope_call));
-        } else {
-            assert(0); //FIXME - error handler
-        }
+    // the chain, which is a statement of another chain, is a nested block
+    if (AST_IsOperation(node->parent, AST_ELEM_OPERATION_SENTINEL) && node->parent->left == node) {
+        EnterBlockScope(backend);
     }
 
-    ++backend->scope_level;
-
     AST_NodeHandler(node->left, backend);
 
-    --backend->scope_level;
+    // else part hangs on the last link of the then block, IfStatementHandler generates it
+    bool is_last = node->right == NULL || AST_IsOperation(node->right, AST_ELEM_OPERATION_ELSE)
+                                       || AST_IsOperation(node->right, AST_ELEM_OPERATION_IF);
 
-    if (node->right == NULL) {
-        if (backend->symbol_table->current_scope != backend->symbol_table->global_scope) {
-            BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
-            // fprintf(stderr, "%p\n", backend->symbol_table->current_scope);
+    if (is_last) {
+        if (IsBlockScope(backend->symbol_table->current_scope)) {
+            ExitBlockScope(backend);
+        } else {
+            if (backend->symbol_table->current_scope != backend->symbol_table->global_scope) {
+                BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
+            }
+            SymbolTableExitScope(backend->symbol_table);
         }
-        SymbolTableExitScope(backend->symbol_table);
 
         return BACK_END_OK;
     }
@@ -194,6 +270,7 @@ static BackEndErr_t FuncCallHandler(AST_Node* node, ASM_GenerSetup* backend) {
     AST_Node* sentinel = node->left;
     while (sentinel != NULL) {
         ExpressionHandler(sentinel->right, backend);
+        ConvertValue(backend, sentinel->right->value_type, sentinel->value_type);
         sentinel = sentinel->left;
     }
     
@@ -209,13 +286,19 @@ static BackEndErr_t FuncCallHandler(AST_Node* node, ASM_GenerSetup* backend) {
 static BackEndErr_t ReturnHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
-    // fprintf(stderr, "[RET]Sc_l: %u, Sy_l: %u, %p\n", backend->scope_level, backend->symbol_table->current_scope->level, node);
-
-    ++backend->scope_level;
 
-    ExpressionHandler(node->right, backend);
+    // the result of the tail call is returned as it is, so it must not need the conversion
+    if (    AST_IsOperation(node->right, AST_ELEM_OPERATION_CALL) && backend->func_name != NULL
+        &&  IsFloat(node->right->value_type) == IsFloat(node->value_type) ) {
+        TailCallHandler(node->right, backend);
+    } else {
+        ExpressionHandler(node->right, backend);
+        ConvertValue(backend, node->right->value_type, node->value_type);
 
-    --backend->scope_level;
+        if (backend->memo != NULL) {
+            MemoStoreHandler(backend);
+        }
+    }
 
     for (size_t i = 0; i < backend->symbol_table->current_scope->level; i++) {
         BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
@@ -227,6 +310,49 @@ static BackEndErr_t ReturnHandler(AST_Node* node, ASM_GenerSetup* backend) {
     return BACK_END_OK;
 }
 
+/*
+ * "return f(...)" never comes back to the frame, so the frame is released before the jump:
+ * the call to itself pops the arguments into its own parameters,
+ * any other call leaves the frame and jumps to the callee, which returns to our caller
+ */
+static BackEndErr_t TailCallHandler(AST_Node* node, ASM_GenerSetup* backend) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+
+    AST_Node* sentinel = node->left;
+    while (sentinel != NULL) {
+        ExpressionHandler(sentinel->right, backend);
+        ConvertValue(backend, sentinel->right->value_type, sentinel->value_type);
+        sentinel = sentinel->left;
+    }
+
+    const char* callee = node->right->data.variable;
+    unsigned int level = backend->symbol_table->current_scope->level;
+
+    char temp_buffer[MAX_LEN] = "";
+
+    if (strcmp(callee, backend->func_name) == 0) {
+        for (unsigned int i = backend->func_scope_level; i < level; i++) {
+            BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
+        }
+
+        BufferPush(backend->assembly_code, drop_scope_vars, strlen(drop_scope_vars));
+
+        snprintf(temp_buffer, MAX_LEN, "JMP %s_params\n\n", callee);
+
+    } else {
+        for (unsigned int i = 0; i < level; i++) {
+            BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
+        }
+
+        snprintf(temp_buffer, MAX_LEN, "JMP %s\n\n", callee);
+    }
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    return BACK_END_OK;
+}
+
 static BackEndErr_t ExpressionHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
@@ -281,10 +407,13 @@ static BackEndErr_t ExpressionHandler(AST_Node* node, ASM_GenerSetup* backend) {
         return NEHandler(node, backend);
 
     case AST_ELEM_OPERATION_LAND:
-        return LandHandler(node, backend);
+        return LogicHandler(node, backend);
 
     case AST_ELEM_OPERATION_LOR:
-        return LorHandler(node, backend);
+        return LogicHandler(node, backend);
+
+    case AST_ELEM_OPERATION_SELECT:
+        return SelectHandler(node, backend);
 
     case AST_ELEM_OPERATION_CALL:
         return FuncCallHandler(node, backend);
@@ -302,7 +431,11 @@ static BackEndErr_t PrintHandler(AST_Node* node, ASM_GenerSetup* backend) {
 
     ExpressionHandler(node->right, backend);
 
-    BufferPush(backend->assembly_code, out, strlen(out));
+    if (IsFloat(node->right->value_type)) {
+        BufferPush(backend->assembly_code, float_out, strlen(float_out));
+    } else {
+        BufferPush(backend->assembly_code, out, strlen(out));
+    }
 
     return BACK_END_OK;
 }
@@ -314,12 +447,14 @@ static BackEndErr_t AssignmentHandler(AST_Node* node, ASM_GenerSetup* backend) {
     AST_Node* assignment_node = node->left;
     while (assignment_node->right != NULL) {
         ExpressionHandler(node->right, backend);
+        ConvertValue(backend, node->right->value_type, assignment_node->value_type);
         SetVariableHandler(assignment_node->right, backend);
 
         assignment_node = assignment_node->left;
     }
 
     ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, node->value_type);
     SetVariableHandler(assignment_node, backend);
     
     return BACK_END_OK;
@@ -329,24 +464,40 @@ static BackEndErr_t IfStatementHandler(AST_Node* node, ASM_GenerSetup* backend)
     assert( node    != NULL );
     assert( backend != NULL );
 
-    ExpressionHandler(node->left, backend);
+    AST_Node* else_part = AST_ChainElse(node->right);
 
-    char* if_st  = CntLabel(if_statement, backend->if_cnt);
-    char* if_end = CntLabel(endif, backend->if_cnt);
+    char* if_end_name = CntLabel(endif_name, backend->if_cnt);
+    char* if_end      = CntLabel(endif, backend->if_cnt);
+    char* if_end_jump = CntLabel(endif_jmp, backend->if_cnt);
+    char* else_label  = CntLabel(else_name, backend->if_cnt);
 
     ++backend->if_cnt;
 
-    BufferPush(backend->assembly_code, if_st, strlen(if_st));
+    BranchIfFalse(node->left, backend, else_part != NULL ? else_label : if_end_name);
 
-    SymbolTableEnterScope(backend->symbol_table);
-    BufferPush(backend->assembly_code, enter_scope_call, strlen(enter_scope_call));
+    EnterBlockScope(backend);
 
     AST_NodeHandler(node->right, backend);
 
+    // "else if" is the if statement of its own, "else" opens the block
+    if (else_part != NULL) {
+        BufferPush(backend->assembly_code, if_end_jump, strlen(if_end_jump));
+        PushLabel(backend, else_label);
+
+        if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+            IfStatementHandler(else_part, backend);
+        } else {
+            EnterBlockScope(backend);
+            AST_NodeHandler(else_part->right, backend);
+        }
+    }
+
     BufferPush(backend->assembly_code, if_end, strlen(if_end));
 
-    FREE(if_st);
+    FREE(if_end_name);
     FREE(if_end);
+    FREE(if_end_jump);
+    FREE(else_label);
 
     return BACK_END_OK;
 }
@@ -355,41 +506,79 @@ static BackEndErr_t WhileStatementHandler(AST_Node* node, ASM_GenerSetup* backen
     assert( node    != NULL );
     assert( backend != NULL );
 
-    char* if_st  = CntLabel(if_statement, backend->if_cnt);
     char* if_beg = CntLabel(begif, backend->if_cnt);
     char* if_beg_jump = CntLabel(begif_jmp, backend->if_cnt);
+    char* if_end_name = CntLabel(endif_name, backend->if_cnt);
     char* if_end = CntLabel(endif, backend->if_cnt);
 
     ++backend->if_cnt;
 
     BufferPush(backend->assembly_code, if_beg, strlen(if_beg));
 
-    ExpressionHandler(node->left, backend);
-
-    BufferPush(backend->assembly_code, if_st, strlen(if_st));
+    BranchIfFalse(node->left, backend, if_end_name);
 
-    SymbolTableEnterScope(backend->symbol_table);
-    BufferPush(backend->assembly_code, enter_scope_call, strlen(enter_scope_call));
+    EnterBlockScope(backend);
 
     AST_NodeHandler(node->right, backend);
 
     BufferPush(backend->assembly_code, if_beg_jump, strlen(if_beg_jump));
     BufferPush(backend->assembly_code, if_end, strlen(if_end));
 
-    FREE(if_st);
     FREE(if_beg);
     FREE(if_beg_jump);
+    FREE(if_end_name);
     FREE(if_end);
 
     return BACK_END_OK;
 }
 
+/*
+ * block of the function takes no frame of its own: its variables are the next cells
+ * of the function frame, so the blocks without declarations cost nothing;
+ * global statements have no frame to share, their blocks keep the own ones
+ */
+static void EnterBlockScope(ASM_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    if (backend->symbol_table->current_scope == backend->symbol_table->global_scope) {
+        SymbolTableEnterScope(backend->symbol_table);
+        BufferPush(backend->assembly_code, enter_scope_call, strlen(enter_scope_call));
+    } else {
+        SymbolTableEnterBlock(backend->symbol_table);
+    }
+}
+
+/* the cells of the block variables are released by moving RAX back to the end of the enclosing scope */
+static void ExitBlockScope(ASM_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    const Scope* block = backend->symbol_table->current_scope;
+
+    if (block->scope_ram_offset > block->prev->scope_ram_offset) {
+        char temp_buffer[MAX_LEN] = "";
+
+        snprintf(temp_buffer, MAX_LEN, "PUSHR RBX\n"
+                                       "PUSH %lu\n"
+                                       "ADD\n"
+                                       "POPR RAX\n\n", block->prev->scope_ram_offset + 1);
+
+        BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+    }
+
+    SymbolTableExitScope(backend->symbol_table);
+}
+
+static bool IsBlockScope(const Scope* scope) {
+    assert( scope != NULL );
+
+    return scope->prev != NULL && scope->level == scope->prev->level;
+}
+
 // ============================= DECLARATION HANDLER =============================
 
 static BackEndErr_t FuncDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
-    // fprintf(stderr, "[FUNC]Sc_l: %u, Sy_l: %u, %p\n", backend->scope_level, backend->symbol_table->current_scope->level, node);
 
     AST_Node* right_node = node->right;
 
@@ -399,36 +588,51 @@ static BackEndErr_t FuncDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
 
     BufferPush(backend->assembly_code, func_label, (size_t)func_label_len);
 
-    // ++backend->scope_level;
     SymbolTableEnterScope(backend->symbol_table);
     BufferPush(backend->assembly_code, enter_scope_call, strlen(enter_scope_call));
 
-    AST_Node* var_dec = right_node->left;
-    while (var_dec != NULL) {
-        // fprintf(stderr, "addr: %p\n", var_dec);
-        ParamDecHandler(var_dec, backend);
-        var_dec = var_dec->left;
+    backend->func_name = right_node->data.variable;
+    backend->func_scope_level = backend->symbol_table->current_scope->level;
+
+    func_label_len = snprintf(func_label, MAX_LEN, ": %s_params\n", right_node->data.variable);
+
+    BufferPush(backend->assembly_code, func_label, (size_t)func_label_len);
+
+    ParamDecHandler(right_node->left, backend);
+
+    backend->memo = NULL;
+    for (size_t i = 0; i < backend->memo_tables->size; i++) {
+        if (((const ASM_MemoTable*)backend->memo_tables->data)[i].func_dec == node) {
+            backend->memo = &((const ASM_MemoTable*)backend->memo_tables->data)[i];
+            MemoLookUpHandler(backend);
+            break;
+        }
     }
 
+    LocalsHandler(node, backend);
+
     AST_NodeHandler(right_node->right, backend);
 
+    backend->func_name = NULL;
+    backend->memo = NULL;
+
     return BACK_END_OK;
 }
 
+/* arguments are pushed first to last, so parameters are popped last to first */
 static BackEndErr_t ParamDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
-    assert( node    != NULL );
     assert( backend != NULL );
 
-    AST_Node* right_node = node->right;
+    if (node == NULL) {
+        return BACK_END_OK;
+    }
+
+    ParamDecHandler(node->left, backend);
 
     BufferPush(backend->assembly_code, ram_push, strlen(ram_push));
 
     backend->symbol_table->current_scope->scope_ram_offset++;
 
-    SymbolTableInsert(backend->symbol_table, right_node->data.variable, 
-                        SYM_TYPE_VARIABLE, DATA_TYPE_INT, right_node, 
-                        backend->symbol_table->current_scope->scope_ram_offset);
-
     return BACK_END_OK;
 }
 
@@ -436,12 +640,17 @@ static BackEndErr_t VarDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
 
+    if (backend->func_name != NULL) {
+        return LocalDecHandler(node, backend);
+    }
+
     AST_Node* right_node = node->right;
 
     if (    right_node->type == AST_ELEM_TYPE_OPERATION 
         &&  right_node->data.operation == AST_ELEM_OPERATION_ASSIGNMENT ) {
 
         ExpressionHandler(right_node->right, backend);
+        ConvertValue(backend, right_node->right->value_type, node->data.declaration_type);
         BufferPush(backend->assembly_code, ram_push, strlen(ram_push));
 
     } else {
@@ -450,9 +659,66 @@ static BackEndErr_t VarDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
 
     backend->symbol_table->current_scope->scope_ram_offset++;
 
-    SymbolTableInsert(backend->symbol_table, right_node->left->data.variable, 
-                        SYM_TYPE_VARIABLE, DATA_TYPE_INT, right_node->left, 
-                        backend->symbol_table->current_scope->scope_ram_offset);
+    return BACK_END_OK;
+}
+
+/*
+ * Cells of the locals are colored by their lifetimes and taken all at once after the parameters,
+ * so the declarations only store the initial values and the blocks do not move RAX.
+ * Recursive call by the tail jump to the parameters takes them again.
+ */
+static BackEndErr_t LocalsHandler(AST_Node* node, ASM_GenerSetup* backend) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+
+    const FrameLayout* frames = (const FrameLayout*)backend->frames->data;
+
+    size_t i = 0;
+    while (i < backend->frames->size && frames[i].func_dec != node) {
+        i++;
+    }
+    assert( i < backend->frames->size );
+
+    size_t slots_cnt = frames[i].locals_cnt;
+
+    Scope* scope = backend->symbol_table->current_scope;
+    scope->scope_ram_offset += slots_cnt;
+
+    if (slots_cnt != 0) {
+        char temp_buffer[MAX_LEN] = "";
+
+        snprintf(temp_buffer, MAX_LEN, "PUSHR RAX\n"
+                                       "PUSH %zu\n"
+                                       "ADD\n"
+                                       "POPR RAX\n\n", slots_cnt);
+
+        BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+    }
+
+    if (backend->call_graph != NULL) {
+        CallGraphFunc* func = CallGraphFind(backend->call_graph, node->right->data.variable);
+        if (func != NULL) {
+            func->frame_size = scope->scope_ram_offset + 1;
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+/* declaration of the name, which is already declared in the same scope, is the assignment to its cell */
+static BackEndErr_t LocalDecHandler(AST_Node* node, ASM_GenerSetup* backend) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+
+    AST_Node* initializer = AST_VarDecInitializer(node);
+    AST_Node* identifier  = AST_VarDecIdentifier(node);
+
+    if (initializer != NULL) {
+        ExpressionHandler(initializer, backend);
+        ConvertValue(backend, initializer->value_type, node->data.declaration_type);
+
+        SetVariableHandler(identifier, backend);
+    }
 
     return BACK_END_OK;
 }
@@ -468,9 +734,12 @@ static BackEndErr_t AddHandler(AST_Node* node, ASM_GenerSetup* backend) {
     }
 
     ExpressionHandler(node->left, backend);
+    ConvertValue(backend, node->left->value_type, node->value_type);
+
     ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, node->value_type);
 
-    const char* add = "ADD\n";
+    const char* add = IsFloat(node->value_type) ? "FADD\n" : "ADD\n";
 
     BufferPush(backend->assembly_code, add, strlen(add));
 
@@ -486,9 +755,12 @@ static BackEndErr_t SubHandler(AST_Node* node, ASM_GenerSetup* backend) {
     }
 
     ExpressionHandler(node->left, backend);
+    ConvertValue(backend, node->left->value_type, node->value_type);
+
     ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, node->value_type);
 
-    const char* sub = "SUB\n";
+    const char* sub = IsFloat(node->value_type) ? "FSUB\n" : "SUB\n";
 
     BufferPush(backend->assembly_code, sub, strlen(sub));
 
@@ -504,9 +776,12 @@ static BackEndErr_t MulHandler(AST_Node* node, ASM_GenerSetup* backend) {
     }
 
     ExpressionHandler(node->left, backend);
+    ConvertValue(backend, node->left->value_type, node->value_type);
+
     ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, node->value_type);
 
-    const char* mul = "MUL\n";
+    const char* mul = IsFloat(node->value_type) ? "FMUL\n" : "MUL\n";
 
     BufferPush(backend->assembly_code, mul, strlen(mul));
 
@@ -522,9 +797,12 @@ static BackEndErr_t DivHandler(AST_Node* node, ASM_GenerSetup* backend) {
     }
 
     ExpressionHandler(node->left, backend);
+    ConvertValue(backend, node->left->value_type, node->value_type);
+
     ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, node->value_type);
 
-    const char* div = "DIV\n";
+    const char* div = IsFloat(node->value_type) ? "FDIV\n" : "DIV\n";
 
     BufferPush(backend->assembly_code, div, strlen(div));
 
@@ -541,10 +819,9 @@ static BackEndErr_t LTHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
+    bool is_float = CompareOperands(node, backend);
 
-    const char* jbe = "JBE";
+    const char* jbe = is_float ? "FJBE" : "JBE";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -565,10 +842,9 @@ static BackEndErr_t LEHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
+    bool is_float = CompareOperands(node, backend);
 
-    const char* jb = "JB";
+    const char* jb = is_float ? "FJB" : "JB";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -589,10 +865,9 @@ static BackEndErr_t GTHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
+    bool is_float = CompareOperands(node, backend);
 
-    const char* jae = "JAE";
+    const char* jae = is_float ? "FJAE" : "JAE";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -613,10 +888,9 @@ static BackEndErr_t GEHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
-    
-    const char* ja = "JA";
+    bool is_float = CompareOperands(node, backend);
+
+    const char* ja = is_float ? "FJA" : "JA";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -637,10 +911,9 @@ static BackEndErr_t EEHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
+    bool is_float = CompareOperands(node, backend);
 
-    const char* jne = "JNE";
+    const char* jne = is_float ? "FJNE" : "JNE";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -661,10 +934,9 @@ static BackEndErr_t NEHandler(AST_Node* node, ASM_GenerSetup* backend) {
         assert(0); //FIXME - error handler
     }
 
-    ExpressionHandler(node->left, backend);
-    ExpressionHandler(node->right, backend);
+    bool is_float = CompareOperands(node, backend);
 
-    const char* je = "JE";
+    const char* je = is_float ? "FJE" : "JE";
     
     char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
     backend->bool_cnt++;
@@ -677,72 +949,291 @@ static BackEndErr_t NEHandler(AST_Node* node, ASM_GenerSetup* backend) {
     return BACK_END_OK;
 }
 
-static BackEndErr_t LandHandler(AST_Node* node, ASM_GenerSetup* backend) {
+/* value of the logical operation is 1 or 0, the right operand is evaluated only if it is needed */
+static BackEndErr_t LogicHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
 
-    MulHandler(node, backend);
+    char* false_label = CntLabel(logic_name, backend->bool_cnt++);
+    char* end_label   = CntLabel(logic_name, backend->bool_cnt++);
 
-    char* cnt_bool_cmp = CntLabel(unary_bool_cmp, backend->bool_cnt);
-    backend->bool_cnt++;
+    BranchIfFalse(node, backend, false_label);
 
-    BufferPush(backend->assembly_code, cnt_bool_cmp, strlen(cnt_bool_cmp));
+    char temp_buffer[MAX_LEN] = "";
 
-    FREE(cnt_bool_cmp);
+    snprintf(temp_buffer, MAX_LEN, "PUSH 1\n"
+                                   "JMP %s\n", end_label);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    PushLabel(backend, false_label);
+    BufferPush(backend->assembly_code, "PUSH 0\n", strlen("PUSH 0\n"));
+    PushLabel(backend, end_label);
+
+    FREE(false_label);
+    FREE(end_label);
 
     return BACK_END_OK;
 }
 
-static BackEndErr_t LorHandler(AST_Node* node, ASM_GenerSetup* backend) {
+/*
+ * select(cond, a, b) pushes both values and the operands of the condition,
+ * then SELECT with the jump of the condition leaves a, if the jump would be taken, and b otherwise
+ */
+static BackEndErr_t SelectHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
 
-    AddHandler(node, backend);
-    MulHandler(node, backend);
-    
-    const char* sub = "SUB\n";
+    AST_Node* values = node->right;
 
-    char* cnt_bool_cmp = CntLabel(unary_bool_cmp, backend->bool_cnt);
-    backend->bool_cnt++;
+    ExpressionHandler(values->left, backend);
+    ConvertValue(backend, values->left->value_type, node->value_type);
 
-    BufferPush(backend->assembly_code, sub, strlen(sub));
-    BufferPush(backend->assembly_code, cnt_bool_cmp, strlen(cnt_bool_cmp));
+    ExpressionHandler(values->right, backend);
+    ConvertValue(backend, values->right->value_type, node->value_type);
 
-    FREE(cnt_bool_cmp);
+    const char* jump = ConditionOperands(node->left, backend, true);
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "SELECT %s\n\n", jump);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
 
     return BACK_END_OK;
 }
 
+/* jumps to the label, if the condition is false, falls through otherwise */
+static void BranchIfFalse(AST_Node* node, ASM_GenerSetup* backend, const char* label) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+    assert( label   != NULL );
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_LAND)) {
+        BranchIfFalse(node->left,  backend, label);
+        BranchIfFalse(node->right, backend, label);
+
+    } else if (AST_IsOperation(node, AST_ELEM_OPERATION_LOR)) {
+        char* truth_label = CntLabel(logic_name, backend->bool_cnt++);
+
+        BranchIfTrue(node->left, backend, truth_label);
+        BranchIfFalse(node->right, backend, label);
+        PushLabel(backend, truth_label);
+
+        FREE(truth_label);
+
+    } else {
+        ConditionJump(node, backend, label, false);
+    }
+}
+
+/* jumps to the label, if the condition is true, falls through otherwise */
+static void BranchIfTrue(AST_Node* node, ASM_GenerSetup* backend, const char* label) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+    assert( label   != NULL );
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_LOR)) {
+        BranchIfTrue(node->left,  backend, label);
+        BranchIfTrue(node->right, backend, label);
+
+    } else if (AST_IsOperation(node, AST_ELEM_OPERATION_LAND)) {
+        char* false_label = CntLabel(logic_name, backend->bool_cnt++);
+
+        BranchIfFalse(node->left, backend, false_label);
+        BranchIfTrue(node->right, backend, label);
+        PushLabel(backend, false_label);
+
+        FREE(false_label);
+
+    } else {
+        ConditionJump(node, backend, label, true);
+    }
+}
+
+/* comparison jumps by its operands, any other value is compared with zero */
+static void ConditionJump(AST_Node* node, ASM_GenerSetup* backend, const char* label, bool jump_if) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+    assert( label   != NULL );
+
+    const char* jump = ConditionOperands(node, backend, jump_if);
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "%s %s\n\n", jump, label);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+}
+
+/* comparison pushes its operands, any other value is pushed with zero; returns the jump, which checks them */
+static const char* ConditionOperands(AST_Node* node, ASM_GenerSetup* backend, bool jump_if) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+
+    if (    node->type == AST_ELEM_TYPE_OPERATION
+        &&  AST_ELEM_OPERATION_LT <= node->data.operation && node->data.operation <= AST_ELEM_OPERATION_NE ) {
+
+        bool is_float = CompareOperands(node, backend);
+        return ComparisonJump(node->data.operation, jump_if, is_float);
+    }
+
+    ExpressionHandler(node, backend);
+
+    bool is_float = IsFloat(node->value_type);
+    const char* zero = is_float ? "FPUSH 0 0\n" : "PUSH 0\n";
+
+    BufferPush(backend->assembly_code, zero, strlen(zero));
+
+    return ComparisonJump(AST_ELEM_OPERATION_NE, jump_if, is_float);
+}
+
+/* the jump takes the right operand from the top and compares it with the left one */
+static const char* ComparisonJump(AST_ElemOperation operation, bool jump_if, bool is_float) {
+    switch (operation) {
+    case AST_ELEM_OPERATION_LT:
+        return jump_if ? (is_float ? "FJA"  : "JA" ) : (is_float ? "FJBE" : "JBE");
+    case AST_ELEM_OPERATION_GT:
+        return jump_if ? (is_float ? "FJB"  : "JB" ) : (is_float ? "FJAE" : "JAE");
+    case AST_ELEM_OPERATION_LE:
+        return jump_if ? (is_float ? "FJAE" : "JAE") : (is_float ? "FJB"  : "JB" );
+    case AST_ELEM_OPERATION_GE:
+        return jump_if ? (is_float ? "FJBE" : "JBE") : (is_float ? "FJA"  : "JA" );
+    case AST_ELEM_OPERATION_EE:
+        return jump_if ? (is_float ? "FJE"  : "JE" ) : (is_float ? "FJNE" : "JNE");
+    case AST_ELEM_OPERATION_NE:
+        return jump_if ? (is_float ? "FJNE" : "JNE") : (is_float ? "FJE"  : "JE" );
+
+    case AST_ELEM_OPERATION_UNDEFINED:
+    case AST_ELEM_OPERATION_SENTINEL:
+    case AST_ELEM_OPERATION_ADD:
+    case AST_ELEM_OPERATION_SUB:
+    case AST_ELEM_OPERATION_MUL:
+    case AST_ELEM_OPERATION_DIV:
+    case AST_ELEM_OPERATION_LAND:
+    case AST_ELEM_OPERATION_LOR:
+    case AST_ELEM_OPERATION_SELECT:
+    case AST_ELEM_OPERATION_INPUT:
+    case AST_ELEM_OPERATION_PRINT:
+    case AST_ELEM_OPERATION_ASSIGNMENT:
+    case AST_ELEM_OPERATION_IF:
+    case AST_ELEM_OPERATION_ELSE:
+    case AST_ELEM_OPERATION_WHILE:
+    case AST_ELEM_OPERATION_BREAK:
+    case AST_ELEM_OPERATION_CALL:
+    case AST_ELEM_OPERATION_RETURN:
+    default:
+        assert(0); //FIXME - error handler
+        return "JMP";
+    }
+}
+
+static void PushLabel(ASM_GenerSetup* backend, const char* label) {
+    assert( backend != NULL );
+    assert( label   != NULL );
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, ": %s\n\n", label);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+}
+
 //
 
 static BackEndErr_t ConstHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
 
-    // just int
-    if (node->data.constant.type != CONST_TYPE_INT) {
-        assert(0); //TODO - other const types
-    }
+    const ConstData* data = &node->data.constant.data;
 
     char temp_buffer[MAX_LEN] = "";
 
-    snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", node->data.constant.data.int_const);
+    switch (node->data.constant.type) {
+    case CONST_TYPE_SHORT:
+        snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", data->short_const);
+        break;
+
+    case CONST_TYPE_INT:
+        snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", data->int_const);
+        break;
+
+    case CONST_TYPE_LONG:
+        snprintf(temp_buffer, MAX_LEN, "PUSH %ld\n", data->long_const);
+        break;
+
+    case CONST_TYPE_CHAR:
+        snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", data->char_const);
+        break;
+
+    case CONST_TYPE_DOUBLE: {
+        // immediate is a word, so the bytes of the double go in two words
+        int words[2] = {0};
+        memcpy(words, &data->double_const, sizeof(words));
+
+        snprintf(temp_buffer, MAX_LEN, "FPUSH %d %d ; %g\n", words[0], words[1], data->double_const);
+        break;
+    }
+
+    case CONST_TYPE_UNDEFINED:
+    case CONST_TYPE_VOID:
+    default:
+        assert(0); //FIXME - error handler
+        break;
+    }
 
     BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
 
     return BACK_END_OK;
 }
 
+/* both operands are converted to double, if one of them is double, returns true then */
+static bool CompareOperands(AST_Node* node, ASM_GenerSetup* backend) {
+    assert( node    != NULL );
+    assert( backend != NULL );
+
+    if (node->left == NULL || node->right == NULL) {
+        assert(0); //FIXME - error handler
+    }
+
+    bool is_float = IsFloat(node->left->value_type) || IsFloat(node->right->value_type);
+    ConstType type = is_float ? CONST_TYPE_DOUBLE : CONST_TYPE_LONG;
+
+    ExpressionHandler(node->left, backend);
+    ConvertValue(backend, node->left->value_type, type);
+
+    ExpressionHandler(node->right, backend);
+    ConvertValue(backend, node->right->value_type, type);
+
+    return is_float;
+}
+
+/* integer types share the representation, only double needs the conversion */
+static void ConvertValue(ASM_GenerSetup* backend, ConstType from, ConstType to) {
+    assert( backend != NULL );
+
+    if (from == CONST_TYPE_VOID || to == CONST_TYPE_VOID || IsFloat(from) == IsFloat(to)) {
+        return;
+    }
+
+    const char* conversion = IsFloat(to) ? "ITOF\n" : "FTOI\n";
+
+    BufferPush(backend->assembly_code, conversion, strlen(conversion));
+}
+
+static bool IsFloat(ConstType type) {
+    return type == CONST_TYPE_DOUBLE;
+}
+
+
 // ============================== VARIABLE HANDLER ==============================
 
 static BackEndErr_t GetVariableHandler(AST_Node* node, ASM_GenerSetup* backend) {
     assert( node    != NULL );
     assert( backend != NULL );
-    // fprintf(stderr, "%p\n", node); //FIXME - dynamic temp_buffer or clever to do
 
-    SymbolData* symbol_data = SymbolTableLookUp(backend->symbol_table, node->data.variable);
-    if (symbol_data == NULL) {
-        fprintf(stderr, "GetVariableHandler: SymbolTableLookUp == NULL\n");
+    if (node->binding.declaration == NULL) {
+        fprintf(stderr, "GetVariableHandler: \"%s\" is not declared\n", node->data.variable);
         return BACK_END_SYMBOL_TABLE_FAILED;
     }   // need error handler in middle_end
 
@@ -750,19 +1241,10 @@ static BackEndErr_t GetVariableHandler(AST_Node* node, ASM_GenerSetup* backend)
 
     snprintf(temp_buffer, MAX_LEN, "; get variable \"%s\"\n", node->data.variable);
 
-    strcat(temp_buffer + strlen(temp_buffer),   "PUSHR  RBX\n"
-                                                "POPR   RCX\n");
-
-    for (size_t i = symbol_data->scope_level; i < backend->scope_level - 1; i++) {
-        strcat(temp_buffer + strlen(temp_buffer), "PUSHM [RCX]\n"
-                                                  "POPR   RCX\n");
-    }
-
-    snprintf(temp_buffer + strlen(temp_buffer), MAX_LEN,  "PUSH %lu\n"
-                                    "CALL get_rcx_by_offset\n\n", symbol_data->symbol_ram_offset);
-
     BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
 
+    PushFrameCell(backend, node->binding.depth, node->binding.slot);
+
     return BACK_END_OK;
 }
 
@@ -770,9 +1252,8 @@ static BackEndErr_t SetVariableHandler(AST_Node* node, ASM_GenerSetup* backend)
     assert( node    != NULL );
     assert( backend != NULL );
 
-    SymbolData* symbol_data = SymbolTableLookUp(backend->symbol_table, node->data.variable);
-    if (symbol_data == NULL) {
-        fprintf(stderr, "SetVariableHandler: SymbolTableLookUp == NULL\n");
+    if (node->binding.declaration == NULL) {
+        fprintf(stderr, "SetVariableHandler: \"%s\" is not declared\n", node->data.variable);
         return BACK_END_SYMBOL_TABLE_FAILED;
     }   // need error handler in middle_end
 
@@ -780,22 +1261,277 @@ static BackEndErr_t SetVariableHandler(AST_Node* node, ASM_GenerSetup* backend)
 
     snprintf(temp_buffer, MAX_LEN, "; set variable \"%s\"\n", node->data.variable);
 
-    strcat(temp_buffer + strlen(temp_buffer),   "PUSHR  RBX\n"
-                                                "POPR   RCX\n");
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    PopFrameCell(backend, node->binding.depth, node->binding.slot);
+
+    return BACK_END_OK;
+}
+
+/*
+ * Cell of the current frame is accessed by its offset from RBX with one instruction.
+ * For the outer frames RCX walks up to the frame of the scope, the cell is accessed by its offset in the frame;
+ * blocks live in the frame of their function, so only the function frames are walked
+ */
+static void FrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset,
+                      const char* local_access, const char* access) {
+    assert( backend      != NULL );
+    assert( local_access != NULL );
+    assert( access       != NULL );
 
-    for (size_t i = symbol_data->scope_level; i < backend->scope_level - 1; i++) {
+    char temp_buffer[MAX_LEN] = "";
+
+    if (scope_level == backend->symbol_table->current_scope->level) {
+        snprintf(temp_buffer, MAX_LEN, "%s %lu\n\n", local_access, offset);
+
+        BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+        return;
+    }
+
+    strcat(temp_buffer,   "PUSHR  RBX\n"
+                          "POPR   RCX\n");
+
+    for (size_t i = scope_level; i < backend->symbol_table->current_scope->level; i++) {
         strcat(temp_buffer + strlen(temp_buffer), "PUSHM [RCX]\n"
                                                   "POPR   RCX\n");
     }
 
     snprintf(temp_buffer + strlen(temp_buffer), MAX_LEN,  "PUSH %lu\n"
-                                    "CALL set_rcx_by_offset\n\n", symbol_data->symbol_ram_offset);
+                                    "CALL %s\n\n", offset, access);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+}
+
+static void PushFrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset) {
+    FrameCell(backend, scope_level, offset, "PUSHL", "get_rcx_by_offset");
+}
+
+static void PopFrameCell(ASM_GenerSetup* backend, size_t scope_level, size_t offset) {
+    FrameCell(backend, scope_level, offset, "POPL", "set_rcx_by_offset");
+}
+
+// ================================ MEMOIZATION ================================
+
+/*
+ * Tables of the memoized functions are placed in RAM before the first frame
+ * and cleared before main is called, RAX starts after them.
+ */
+static BackEndErr_t MemoTablesInit(ASM_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    Buffer_t* func_decs = BufferInit(0, sizeof(AST_Node*));
+    if (func_decs == NULL) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    if (FindMemoizableFunctions(backend->ast, func_decs) != MIDDLE_END_OK) {
+        BufferDestroy(&func_decs);
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    size_t tables_size = 0;
+
+    for (size_t i = 0; i < func_decs->size; i++) {
+        ASM_MemoTable table = {
+            .func_dec   = ((AST_Node**)func_decs->data)[i],
+            .base       = tables_size,
+            .params_cnt = 0
+        };
+
+        for (const AST_Node* param = table.func_dec->right->left; param != NULL; param = param->left) {
+            table.params_cnt++;
+        }
+
+        if (BufferPush(backend->memo_tables, &table, sizeof(ASM_MemoTable)) != BUFFER_OK) {
+            BufferDestroy(&func_decs);
+            return BACK_END_BUFFER_FAILED;
+        }
+
+        tables_size += (2 * MEMO_HASH_RANGE - 1) * (table.params_cnt + 2);
+
+        // address of the slot is the hidden local, the locals of the function follow it
+        FrameLayout frame = {
+            .func_dec   = table.func_dec,
+            .hidden_cnt = 1,
+            .locals_cnt = 0
+        };
+
+        if (BufferPush(backend->frames, &frame, sizeof(FrameLayout)) != BUFFER_OK) {
+            BufferDestroy(&func_decs);
+            return BACK_END_BUFFER_FAILED;
+        }
+
+        if (backend->call_graph != NULL) {
+            CallGraphFunc* func = CallGraphFind(backend->call_graph, table.func_dec->right->data.variable);
+            if (func != NULL) {
+                func->frame_size++;
+            }
+        }
+    }
+
+    if (backend->call_graph != NULL) {
+        backend->call_graph->static_size += tables_size;
+    }
+
+    BufferDestroy(&func_decs);
+
+    if (tables_size == 0) {
+        return BACK_END_OK;
+    }
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "; memo tables\n"
+                                   "PUSH %zu\n"
+                                   "POPR RCX\n"
+                                   ": memo_clear\n"
+                                   "PUSHR RCX\n"
+                                   "PUSH 1\n"
+                                   "SUB\n"
+                                   "POPR RCX\n"
+                                   "PUSH 0\n"
+                                   "POPM [RCX]\n"
+                                   "PUSH 0\n"
+                                   "PUSHR RCX\n"
+                                   "JA memo_clear\n\n"
+                                   "PUSH %zu\n"
+                                   "POPR RAX\n\n", tables_size, tables_size);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    return BACK_END_OK;
+}
 
+/*
+ * Parameters lie in the cells 1..n of the function frame, the address of the slot
+ * is kept in the hidden local after them. The slot is chosen by the hash of the arguments,
+ * it holds the result, if it is filled with the same arguments.
+ */
+static BackEndErr_t MemoLookUpHandler(ASM_GenerSetup* backend) {
+    assert( backend       != NULL );
+    assert( backend->memo != NULL );
+
+    const ASM_MemoTable* memo = backend->memo;
+    size_t slot_offset = memo->params_cnt + 1;
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "; memo look up \"%s\"\n", backend->func_name);
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    // hash = ((a1 * 31 + a2) * 31 + ...) + an
+    for (size_t i = 1; i <= memo->params_cnt; i++) {
+        if (i != 1) {
+            BufferPush(backend->assembly_code, "PUSH 31\nMUL\n", strlen("PUSH 31\nMUL\n"));
+        }
+
+        PushFrameCell(backend, backend->func_scope_level, i);
+
+        if (i != 1) {
+            BufferPush(backend->assembly_code, "ADD\n\n", strlen("ADD\n\n"));
+        }
+    }
+
+    // hash is stored to the hidden local, then replaced with the slot address
+    BufferPush(backend->assembly_code, ram_push, strlen(ram_push));
+    backend->symbol_table->current_scope->scope_ram_offset++;
+
+    PushFrameCell(backend, backend->func_scope_level, slot_offset);
+    PushFrameCell(backend, backend->func_scope_level, slot_offset);
+
+    snprintf(temp_buffer, MAX_LEN, "PUSH %zu\n"
+                                   "DIV\n"
+                                   "PUSH %zu\n"
+                                   "MUL\n"
+                                   "SUB\n"
+                                   "PUSH %zu\n"
+                                   "ADD\n"
+                                   "PUSH %zu\n"
+                                   "MUL\n"
+                                   "PUSH %zu\n"
+                                   "ADD\n"
+                                   "POPL %zu\n\n",
+                                   MEMO_HASH_RANGE, MEMO_HASH_RANGE, MEMO_HASH_RANGE - 1,
+                                   memo->params_cnt + 2, memo->base, slot_offset);
     BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
 
+    snprintf(temp_buffer, MAX_LEN, "JNE %s_memo_miss\n\n", backend->func_name);
+
+    PushMemoSlotCell(backend, 1);
+    BufferPush(backend->assembly_code, "PUSH 1\n", strlen("PUSH 1\n"));
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    for (size_t i = 1; i <= memo->params_cnt; i++) {
+        PushMemoSlotCell(backend, i + 1);
+        PushFrameCell(backend, backend->func_scope_level, i);
+        BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+    }
+
+    PushMemoSlotCell(backend, 0);
+
+    for (size_t i = 0; i < backend->symbol_table->current_scope->level; i++) {
+        BufferPush(backend->assembly_code, exit_scope_call, strlen(exit_scope_call));
+    }
+    BufferPush(backend->assembly_code, ret, strlen(ret));
+
+    snprintf(temp_buffer, MAX_LEN, ": %s_memo_miss\n\n", backend->func_name);
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+
+    return BACK_END_OK;
+}
+
+/* the returned value is on the top of the stack, it stays there */
+static BackEndErr_t MemoStoreHandler(ASM_GenerSetup* backend) {
+    assert( backend       != NULL );
+    assert( backend->memo != NULL );
+
+    const char* comment = "; memo store\n";
+    BufferPush(backend->assembly_code, comment, strlen(comment));
+
+    PopMemoSlotCell(backend, 0);
+    PushMemoSlotCell(backend, 0);
+
+    BufferPush(backend->assembly_code, "PUSH 1\n", strlen("PUSH 1\n"));
+    PopMemoSlotCell(backend, 1);
+
+    for (size_t i = 1; i <= backend->memo->params_cnt; i++) {
+        PushFrameCell(backend, backend->func_scope_level, i);
+        PopMemoSlotCell(backend, i + 1);
+    }
+
     return BACK_END_OK;
 }
 
+static void PushMemoSlotCell(ASM_GenerSetup* backend, size_t cell) {
+    assert( backend       != NULL );
+    assert( backend->memo != NULL );
+
+    PushFrameCell(backend, backend->func_scope_level, backend->memo->params_cnt + 1);
+
+    char temp_buffer[MAX_LEN] = "";
+    snprintf(temp_buffer, MAX_LEN, "PUSH %zu\n"
+                                   "ADD\n"
+                                   "POPR RCX\n"
+                                   "PUSHM [RCX]\n\n", cell);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+}
+
+/* value on the top of the stack is popped to the cell */
+static void PopMemoSlotCell(ASM_GenerSetup* backend, size_t cell) {
+    assert( backend       != NULL );
+    assert( backend->memo != NULL );
+
+    PushFrameCell(backend, backend->func_scope_level, backend->memo->params_cnt + 1);
+
+    char temp_buffer[MAX_LEN] = "";
+    snprintf(temp_buffer, MAX_LEN, "PUSH %zu\n"
+                                   "ADD\n"
+                                   "POPR RCX\n"
+                                   "POPM [RCX]\n\n", cell);
+
+    BufferPush(backend->assembly_code, temp_buffer, strlen(temp_buffer));
+}
+
 char* CntLabel(const char* s, size_t cnt) {
     assert(s != NULL);
     
@@ -5,6 +5,8 @@
 
 #include "../../include/ast/ast.h"
 #include "../../include/back_end/asm_gener.h"
+#include "../../include/back_end/ir_gener.h"
+#include "../../include/back_end/peephole.h"
 #include "../../include/back_end/asm/asm.h"
 #include "../../clibs/Buffer/include/buffer.h"
 
@@ -17,29 +19,88 @@
 
 const char* output_file_name = "bytecode.bin";
 
-static AssemblerErr_t ByteCodeGeneration(Buffer_t* assembly_code);
+const size_t HELPERS_CALL_DEPTH = 2;    // enter_scope calls move_rax_by_one, set_rcx_by_offset calls set_rcx_offset
 
-BackEndErr_t BackEnd(AST* ast) {
-    assert( ast != NULL );
+static void ProgramBounds(BackEndOptions* options);
+static AssemblerErr_t ByteCodeGeneration(Buffer_t* assembly_code, const StackBounds* bounds);
+static AssemblerErr_t WriteStackBounds(const StackBounds* bounds);
+
+/*
+ * memoize: results of the pure recursive functions are remembered in RAM tables
+ * peephole: the assembly text is cleaned up, peephole_delta gets the change of its size
+ */
+BackEndErr_t BackEnd(AST* ast, BackEndOptions* options) {
+    assert( ast     != NULL );
+    assert( options != NULL );
 
     Buffer_t* assembly_code = BufferInit(0, sizeof(char));
     if (assembly_code == NULL) {
         return BACK_END_BUFFER_FAILED;
     }
 
-    BackEndErr_t flag = AssemblyCodeGeneration(ast, assembly_code);
-    
+    BackEndErr_t flag = AssemblyCodeGeneration(ast, assembly_code, options->memoize, options->call_graph);
+
+    if (flag == BACK_END_OK && options->peephole) {
+        flag = PeepholeOptimization(assembly_code, &options->peephole_delta);
+    }
+
+    ProgramBounds(options);
+
     BufferRelease(assembly_code);
 
-    ByteCodeGeneration(assembly_code); //TODO - error handler
+    ByteCodeGeneration(assembly_code, &options->bounds); //TODO - error handler
 
     // BufferDestroy(&assembly_code); // Destroy in assembler
 
     return BACK_END_OK;
 }
 
-static AssemblerErr_t ByteCodeGeneration(Buffer_t* assembly_code) {
+/* lowers the linear IR instead of the tree, the module must be out of SSA form */
+BackEndErr_t BackEndIR(IR_Module* module, BackEndOptions* options) {
+    assert( module  != NULL );
+    assert( options != NULL );
+
+    Buffer_t* assembly_code = BufferInit(0, sizeof(char));
+    if (assembly_code == NULL) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    BackEndErr_t flag = IR_AssemblyCodeGeneration(module, assembly_code, options->call_graph);
+
+    if (flag == BACK_END_OK && options->peephole) {
+        flag = PeepholeOptimization(assembly_code, &options->peephole_delta);
+    }
+
+    if (flag != BACK_END_OK) {
+        BufferDestroy(&assembly_code);
+        return flag;
+    }
+
+    ProgramBounds(options);
+
+    BufferRelease(assembly_code);
+
+    ByteCodeGeneration(assembly_code, &options->bounds); //TODO - error handler
+
+    return BACK_END_OK;
+}
+
+/* generators have already put their frame sizes into the call graph */
+static void ProgramBounds(BackEndOptions* options) {
+    assert( options != NULL );
+
+    options->bounds.bounded    = false;
+    options->bounds.call_depth = 0;
+    options->bounds.ram_size   = 0;
+
+    if (options->call_graph != NULL) {
+        CallGraphBounds(options->call_graph, "main", HELPERS_CALL_DEPTH, &options->bounds);
+    }
+}
+
+static AssemblerErr_t ByteCodeGeneration(Buffer_t* assembly_code, const StackBounds* bounds) {
     assert( assembly_code != NULL );
+    assert( bounds        != NULL );
     
     Assembler assembler = {0};
 
@@ -57,5 +118,29 @@ static AssemblerErr_t ByteCodeGeneration(Buffer_t* assembly_code) {
 
     AssemblerDestroy(&assembler);
 
-    return flag;
+    return WriteStackBounds(bounds);
+}
+
+/*
+ * Call depth and RAM size follow the code, so the old readers of the file see nothing new.
+ * Zeros mean the program is recursive, the runtime has to check the growth itself.
+ */
+static AssemblerErr_t WriteStackBounds(const StackBounds* bounds) {
+    assert( bounds != NULL );
+
+    FILE* fp = fopen(output_file_name, "ab");
+    if (fp == NULL) {
+        return ASM_FOPEN_FAILED;
+    }
+
+    size_t limits[2] = {
+        bounds->bounded ? bounds->call_depth : 0,
+        bounds->bounded ? bounds->ram_size   : 0
+    };
+
+    size_t wrote_cnt = fwrite(limits, sizeof(size_t), 2, fp);
+
+    fclose(fp);
+
+    return wrote_cnt == 2 ? ASM_OK : ASM_FWRITE_FAILED;
 }
\ No newline at end of file
@@ -0,0 +1,533 @@
+#include "../../include/back_end/ir_gener.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/middle_end/ir.h"
+#include "../../include/middle_end/call_graph.h"
+#include "../../include/back_end/asm_gener.h"
+#include "../../include/back_end/asm_instructions.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct IR_GenerSetup {
+    IR_Function* func;
+    Buffer_t* assembly_code;
+    size_t* use_cnt;        // uses of each value
+    bool* stacked;          // value stays on the data stack between its definition and the only use
+    IR_Instr** constants;   // definition of the constant value, which is pushed at every use instead of the load
+    size_t bool_cnt;
+} IR_GenerSetup;
+
+static BackEndErr_t FunctionGener(IR_GenerSetup* backend);
+static void ParamsGener(IR_GenerSetup* backend);
+static BackEndErr_t BlockGener(IR_GenerSetup* backend, const IR_Block* block);
+static BackEndErr_t InstrGener(IR_GenerSetup* backend, IR_Instr* instr, size_t next_block);
+static void LogicGener(IR_GenerSetup* backend, IR_Instr* instr);
+static void CompareGener(IR_GenerSetup* backend, const char* jump);
+
+static BackEndErr_t Stackify(IR_GenerSetup* backend);
+static bool SimulateBlock(IR_GenerSetup* backend, const IR_Block* block, Buffer_t* stack);
+static size_t MaxStackedOperands(IR_Instr* instr);
+
+static void LoadValue(IR_GenerSetup* backend, size_t value);
+static void StoreValue(IR_GenerSetup* backend, size_t value);
+static void JumpGener(IR_GenerSetup* backend, const char* jump, size_t target);
+static void PushCode(IR_GenerSetup* backend, const char* code);
+
+/*
+ * Frame of the function: [RBX] keeps the caller RBX, value v lives at [RBX + 1 + v].
+ * Temporaries with the only use right after their definition are not stored at all.
+ * Frame sizes of call_graph are replaced with this layout, it may be NULL.
+ */
+BackEndErr_t IR_AssemblyCodeGeneration(IR_Module* module, Buffer_t* assembly_code, CallGraph* call_graph) {
+    assert( module        != NULL );
+    assert( assembly_code != NULL );
+
+    // Base
+    BufferPush(assembly_code, asm_base,          strlen(asm_base));
+    BufferPush(assembly_code, call_main,         strlen(call_main));
+    BufferPush(assembly_code, move_rax_by_one,   strlen(move_rax_by_one));
+    BufferPush(assembly_code, enter_scope,       strlen(enter_scope));
+    BufferPush(assembly_code, exit_scope,        strlen(exit_scope));
+
+    IR_GenerSetup backend = {
+        .func          = NULL,
+        .assembly_code = assembly_code,
+        .use_cnt       = NULL,
+        .stacked       = NULL,
+        .constants     = NULL,
+        .bool_cnt      = 0
+    };
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        if (functions[i]->is_ssa) {
+            fprintf(stderr, "IR_AssemblyCodeGeneration: \"%s\" is in SSA form\n", functions[i]->name);
+            return BACK_END_ERROR;
+        }
+
+        backend.func = functions[i];
+
+        CallGraphFunc* graph_func = call_graph != NULL ? CallGraphFind(call_graph, functions[i]->name) : NULL;
+        if (graph_func != NULL) {
+            graph_func->frame_size = IR_ValueCount(functions[i]) + 1;
+        }
+
+        BackEndErr_t flag = FunctionGener(&backend);
+        if (flag != BACK_END_OK) {
+            return flag;
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+static BackEndErr_t FunctionGener(IR_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    IR_Function* func = backend->func;
+    size_t value_cnt = IR_ValueCount(func);
+
+    backend->use_cnt   = (size_t*)   calloc(value_cnt + 1, sizeof(size_t));
+    backend->stacked   = (bool*)     calloc(value_cnt + 1, sizeof(bool));
+    backend->constants = (IR_Instr**)calloc(value_cnt + 1, sizeof(IR_Instr*));
+    if (backend->use_cnt == NULL || backend->stacked == NULL || backend->constants == NULL) {
+        FREE(backend->use_cnt);
+        FREE(backend->stacked);
+        FREE(backend->constants);
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    BackEndErr_t flag = Stackify(backend);
+
+    if (flag == BACK_END_OK) {
+        char temp_buffer[MAX_LEN] = "";
+
+        snprintf(temp_buffer, MAX_LEN, ": %s\n", func->name);
+        PushCode(backend, temp_buffer);
+        PushCode(backend, enter_scope_call);
+
+        snprintf(temp_buffer, MAX_LEN, "PUSHR RAX\n"
+                                       "PUSH %lu\n"
+                                       "ADD\n"
+                                       "POPR RAX\n\n", value_cnt);
+        PushCode(backend, temp_buffer);
+
+        ParamsGener(backend);
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func) && flag == BACK_END_OK; i++) {
+        flag = BlockGener(backend, IR_GetBlock(func, i));
+    }
+
+    PushCode(backend, "\n");
+
+    FREE(backend->use_cnt);
+    FREE(backend->stacked);
+    FREE(backend->constants);
+
+    return flag;
+}
+
+/* arguments are on the data stack, the last one is on the top */
+static void ParamsGener(IR_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    IR_Block* entry = IR_GetBlock(backend->func, 0);
+
+    for (size_t param = backend->func->param_cnt; param-- > 0; ) {
+        for (size_t i = 0; i < IR_InstrCount(entry); i++) {
+            IR_Instr* instr = IR_GetInstr(entry, i);
+
+            if (instr->opcode == IR_OP_PARAM && (size_t)instr->imm == param) {
+                StoreValue(backend, instr->dst);
+            }
+        }
+    }
+}
+
+static BackEndErr_t BlockGener(IR_GenerSetup* backend, const IR_Block* block) {
+    assert( backend != NULL );
+    assert( block   != NULL );
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, ": %s.bb%lu\n", backend->func->name, block->id);
+    PushCode(backend, temp_buffer);
+
+    for (size_t i = 0; i < IR_InstrCount(block); i++) {
+        BackEndErr_t flag = InstrGener(backend, IR_GetInstr(block, i), block->id + 1);
+        if (flag != BACK_END_OK) {
+            return flag;
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+static BackEndErr_t InstrGener(IR_GenerSetup* backend, IR_Instr* instr, size_t next_block) {
+    assert( backend != NULL );
+    assert( instr   != NULL );
+
+    if (instr->opcode == IR_OP_PHI) {
+        fprintf(stderr, "IR_AssemblyCodeGeneration: phi in \"%s\"\n", backend->func->name);
+        return BACK_END_ERROR;
+    }
+
+    if (instr->opcode == IR_OP_NOP || instr->opcode == IR_OP_PARAM) {
+        return BACK_END_OK;
+    }
+
+    if (instr->opcode == IR_OP_CONST && backend->constants[instr->dst] == instr) {
+        return BACK_END_OK;
+    }
+
+    // stacked operands are already pushed
+    if (instr->opcode != IR_OP_LAND && instr->opcode != IR_OP_LOR) {
+        for (size_t i = 0; i < IR_OperandCount(instr); i++) {
+            size_t operand = *IR_Operand(instr, i);
+            if (!backend->stacked[operand]) {
+                LoadValue(backend, operand);
+            }
+        }
+    }
+
+    char temp_buffer[MAX_LEN] = "";
+
+    switch (instr->opcode) {
+    case IR_OP_CONST:
+        snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", instr->imm);
+        PushCode(backend, temp_buffer);
+        break;
+
+    case IR_OP_COPY:
+        break;
+
+    case IR_OP_ADD:     PushCode(backend, "ADD\n");     break;
+    case IR_OP_SUB:     PushCode(backend, "SUB\n");     break;
+    case IR_OP_MUL:     PushCode(backend, "MUL\n");     break;
+    case IR_OP_DIV:     PushCode(backend, "DIV\n");     break;
+    case IR_OP_SHL:     PushCode(backend, "SHL\n");     break;
+    case IR_OP_SHR:     PushCode(backend, "SHR\n");     break;
+
+    case IR_OP_LT:      CompareGener(backend, "JBE");   break;
+    case IR_OP_LE:      CompareGener(backend, "JB");    break;
+    case IR_OP_GT:      CompareGener(backend, "JAE");   break;
+    case IR_OP_GE:      CompareGener(backend, "JA");    break;
+    case IR_OP_EE:      CompareGener(backend, "JNE");   break;
+    case IR_OP_NE:      CompareGener(backend, "JE");    break;
+
+    case IR_OP_LAND:
+    case IR_OP_LOR:
+        LogicGener(backend, instr);
+        break;
+
+    case IR_OP_INPUT:
+        PushCode(backend, "IN\n");
+        break;
+
+    case IR_OP_PRINT:
+        PushCode(backend, out);
+        break;
+
+    case IR_OP_CALL:
+        snprintf(temp_buffer, MAX_LEN, "CALL %s\n", instr->callee);
+        PushCode(backend, temp_buffer);
+        break;
+
+    case IR_OP_JUMP:
+        if (instr->targets[0] != next_block) {
+            JumpGener(backend, "JMP", instr->targets[0]);
+        }
+        break;
+
+    case IR_OP_BRANCH:
+        PushCode(backend, "PUSH 0\n");
+
+        if (instr->targets[1] == next_block) {
+            JumpGener(backend, "JNE", instr->targets[0]);
+        } else {
+            JumpGener(backend, "JE", instr->targets[1]);
+
+            if (instr->targets[0] != next_block) {
+                JumpGener(backend, "JMP", instr->targets[0]);
+            }
+        }
+        break;
+
+    case IR_OP_RETURN:
+        PushCode(backend, exit_scope_call);
+        PushCode(backend, ret);
+        break;
+
+    case IR_OP_NOP:
+    case IR_OP_PARAM:
+    case IR_OP_PHI:
+    default:
+        assert(0);
+    }
+
+    if (instr->dst != IR_NO_VALUE && !backend->stacked[instr->dst]) {
+        if (backend->use_cnt[instr->dst] != 0) {
+            StoreValue(backend, instr->dst);
+        } else {
+            PushCode(backend, "POP\n");
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+/* operands are turned into 0 or 1 before the arithmetic, so "&&" is their product and "||" is their sum */
+static void LogicGener(IR_GenerSetup* backend, IR_Instr* instr) {
+    assert( backend != NULL );
+    assert( instr   != NULL );
+
+    for (size_t i = 0; i < 2; i++) {
+        if (!backend->stacked[instr->args[i]]) {
+            LoadValue(backend, instr->args[i]);
+        }
+
+        PushCode(backend, "PUSH 0\n");
+        CompareGener(backend, "JE");
+    }
+
+    if (instr->opcode == IR_OP_LAND) {
+        PushCode(backend, "MUL\n");
+        return;
+    }
+
+    PushCode(backend, "ADD\n");
+
+    char* cnt_bool_cmp = CntLabel(unary_bool_cmp, backend->bool_cnt);
+    backend->bool_cnt++;
+
+    PushCode(backend, cnt_bool_cmp);
+
+    FREE(cnt_bool_cmp);
+}
+
+static void CompareGener(IR_GenerSetup* backend, const char* jump) {
+    assert( backend != NULL );
+    assert( jump    != NULL );
+
+    char* cnt_bool_cmp = CntLabel(bool_cmp, backend->bool_cnt);
+    backend->bool_cnt++;
+
+    PushCode(backend, jump);
+    PushCode(backend, cnt_bool_cmp);
+
+    FREE(cnt_bool_cmp);
+}
+
+// ================================ STACKIFYING ================================
+
+/*
+ * Value with the only use in the block of its definition may stay on the data stack,
+ * if the stack simulation shows it is on the top, when the user needs it.
+ * Values, which break the order, go to the frame and the simulation repeats.
+ */
+static BackEndErr_t Stackify(IR_GenerSetup* backend) {
+    assert( backend != NULL );
+
+    IR_Function* func = backend->func;
+    size_t value_cnt = IR_ValueCount(func);
+
+    size_t* def_block = (size_t*)calloc(value_cnt + 1, sizeof(size_t));
+    size_t* use_block = (size_t*)calloc(value_cnt + 1, sizeof(size_t));
+    size_t* def_cnt   = (size_t*)calloc(value_cnt + 1, sizeof(size_t));
+    Buffer_t* stack   = BufferInit(0, sizeof(size_t));
+
+    if (def_block == NULL || use_block == NULL || def_cnt == NULL || stack == NULL) {
+        free(def_block);
+        free(use_block);
+        free(def_cnt);
+        if (stack != NULL) {
+            BufferDestroy(&stack);
+        }
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            for (size_t k = 0; k < IR_OperandCount(instr); k++) {
+                size_t operand = *IR_Operand(instr, k);
+
+                backend->use_cnt[operand]++;
+                use_block[operand] = i;
+            }
+
+            if (instr->dst != IR_NO_VALUE) {
+                def_cnt[instr->dst]++;
+                def_block[instr->dst] = i;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+            size_t dst = instr->dst;
+
+            if (    dst != IR_NO_VALUE && instr->opcode != IR_OP_PARAM
+                 && def_cnt[dst] == 1 && backend->use_cnt[dst] == 1 && use_block[dst] == i ) {
+                backend->stacked[dst] = true;
+            }
+        }
+    }
+
+    // "n * f(n - 1)": the call result is already on the stack, so it goes first
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            if (    IR_IsCommutative(instr->opcode) && instr->opcode != IR_OP_LAND && instr->opcode != IR_OP_LOR
+                 && !backend->stacked[instr->args[0]] && backend->stacked[instr->args[1]] ) {
+                size_t operand = instr->args[0];
+                instr->args[0] = instr->args[1];
+                instr->args[1] = operand;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        while (!SimulateBlock(backend, IR_GetBlock(func, i), stack)) {}
+    }
+
+    // "PUSH imm" is cheaper than the load from the frame
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            if (instr->opcode == IR_OP_CONST && def_cnt[instr->dst] == 1 && !backend->stacked[instr->dst]) {
+                backend->constants[instr->dst] = instr;
+            }
+        }
+    }
+
+    FREE(def_block);
+    FREE(use_block);
+    FREE(def_cnt);
+    BufferDestroy(&stack);
+
+    return BACK_END_OK;
+}
+
+/* returns false, if some value lost its place on the stack */
+static bool SimulateBlock(IR_GenerSetup* backend, const IR_Block* block, Buffer_t* stack) {
+    assert( backend != NULL );
+    assert( block   != NULL );
+    assert( stack   != NULL );
+
+    stack->size = 0;
+
+    for (size_t i = 0; i < IR_InstrCount(block); i++) {
+        IR_Instr* instr = IR_GetInstr(block, i);
+
+        size_t operand_cnt = IR_OperandCount(instr);
+        size_t stacked_cnt = 0;
+        while (stacked_cnt < operand_cnt && backend->stacked[*IR_Operand(instr, stacked_cnt)]) {
+            ++stacked_cnt;
+        }
+
+        bool fits = stacked_cnt <= MaxStackedOperands(instr) && stacked_cnt <= stack->size;
+
+        const size_t* top = (const size_t*)stack->data + stack->size - (fits ? stacked_cnt : 0);
+        for (size_t j = 0; j < stacked_cnt && fits; j++) {
+            fits = top[j] == *IR_Operand(instr, j);
+        }
+
+        if (!fits) {
+            for (size_t j = 0; j < operand_cnt; j++) {
+                backend->stacked[*IR_Operand(instr, j)] = false;
+            }
+            return false;
+        }
+
+        // stacked operand after the loaded one is out of order
+        for (size_t j = stacked_cnt; j < operand_cnt; j++) {
+            if (backend->stacked[*IR_Operand(instr, j)]) {
+                backend->stacked[*IR_Operand(instr, j)] = false;
+                return false;
+            }
+        }
+
+        stack->size -= stacked_cnt;
+
+        if (instr->dst != IR_NO_VALUE && backend->stacked[instr->dst]) {
+            BufferPush(stack, &instr->dst, sizeof(size_t));
+        }
+    }
+
+    return true;
+}
+
+/* logic operations normalize the first operand before the second one is pushed */
+static size_t MaxStackedOperands(IR_Instr* instr) {
+    assert( instr != NULL );
+
+    if (instr->opcode == IR_OP_LAND || instr->opcode == IR_OP_LOR) {
+        return 1;
+    }
+
+    return IR_OperandCount(instr);
+}
+
+// =================================== FRAME ===================================
+
+static void LoadValue(IR_GenerSetup* backend, size_t value) {
+    assert( backend != NULL );
+
+    char temp_buffer[MAX_LEN] = "";
+
+    if (backend->constants[value] != NULL) {
+        snprintf(temp_buffer, MAX_LEN, "PUSH %d\n", backend->constants[value]->imm);
+        PushCode(backend, temp_buffer);
+        return;
+    }
+
+    snprintf(temp_buffer, MAX_LEN, "PUSHL %lu\n", value + 1);
+
+    PushCode(backend, temp_buffer);
+}
+
+static void StoreValue(IR_GenerSetup* backend, size_t value) {
+    assert( backend != NULL );
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "POPL %lu\n\n", value + 1);
+
+    PushCode(backend, temp_buffer);
+}
+
+static void JumpGener(IR_GenerSetup* backend, const char* jump, size_t target) {
+    assert( backend != NULL );
+    assert( jump    != NULL );
+
+    char temp_buffer[MAX_LEN] = "";
+
+    snprintf(temp_buffer, MAX_LEN, "%s %s.bb%lu\n", jump, backend->func->name, target);
+
+    PushCode(backend, temp_buffer);
+}
+
+static void PushCode(IR_GenerSetup* backend, const char* code) {
+    assert( backend != NULL );
+    assert( code    != NULL );
+
+    BufferPush(backend->assembly_code, code, strlen(code));
+}
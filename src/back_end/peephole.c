@@ -0,0 +1,600 @@
+#include "../../include/back_end/peephole.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/back_end/asm_instructions.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t PH_OP_LEN       = 16;
+const size_t PH_ARG_LEN      = 64;
+const size_t PH_WINDOW_LEN   = 8;
+const size_t PH_CAPTURES_CNT = 4;
+
+typedef struct PH_Line {
+    char op[PH_OP_LEN];         // ":" for the labels
+    char arg[PH_ARG_LEN];       // operand or name of the label, the comments are dropped
+    bool removed;
+} PH_Line;
+
+typedef struct PH_Pattern {
+    const char* name;
+    const char* match[PH_WINDOW_LEN + 1];       // NULL terminated
+    const char* replace[PH_WINDOW_LEN + 1];     // NULL terminated
+} PH_Pattern;
+
+typedef struct PH_Captures {
+    char text[PH_CAPTURES_CNT][PH_ARG_LEN];
+    bool bound[PH_CAPTURES_CNT];
+} PH_Captures;
+
+/*
+ * "$n" captures a word: the same n must be the same word in the whole window.
+ * "$n" as the operation matches the conditional jumps only, "!$n" is the opposite jump.
+ * Label of the window may be dropped, only if all its references are in the window.
+ */
+static const PH_Pattern patterns[] = {
+    {"push-pop-same-reg",       {"PUSHR $1", "POPR $1"},                                    {}},
+    {"dropped-const",           {"PUSH $1",  "POP"},                                        {}},
+    {"dropped-reg",             {"PUSHR $1", "POP"},                                        {}},
+    {"dropped-load",            {"PUSHM $1", "POP"},                                        {}},
+    {"dropped-local",           {"PUSHL $1", "POP"},                                        {}},
+    {"add-zero",                {"PUSH 0",   "ADD"},                                        {}},
+    {"sub-zero",                {"PUSH 0",   "SUB"},                                        {}},
+    {"mul-one",                 {"PUSH 1",   "MUL"},                                        {}},
+    {"div-one",                 {"PUSH 1",   "DIV"},                                        {}},
+
+    // RCX = RBX, then RCX = [RCX] is one load
+    {"frame-walk",              {"PUSHR $1", "POPR $2", "PUSHM [$2]", "POPR $2"},           {"PUSHM [$1]", "POPR $2"}},
+
+    // frame cell helpers are inlined: RCX = address + offset, then the cell is accessed
+    {"inline-get-cell",         {"POPR RCX", "PUSH $1", "CALL get_rcx_by_offset"},
+                                {"PUSH $1", "ADD", "POPR RCX", "PUSHM [RCX]"}},
+    {"inline-set-cell",         {"POPR RCX", "PUSH $1", "CALL set_rcx_by_offset"},
+                                {"PUSH $1", "ADD", "POPR RCX", "POPM [RCX]"}},
+
+    {"jump-to-next",            {"JMP $1", ": $1"},                                         {": $1"}},
+
+    // 0/1 built by the comparison is compared with zero: the comparison jumps by itself
+    {"branch-on-false-cmp",     {"$1 $2", "PUSH 1", "JMP $3", ": $2", "PUSH 0", ": $3", "PUSH 0", "JE $4"},
+                                {"$1 $4"}},
+    {"branch-on-true-cmp",      {"$1 $2", "PUSH 1", "JMP $3", ": $2", "PUSH 0", ": $3", "PUSH 0", "JNE $4"},
+                                {"!$1 $4"}},
+};
+
+static BackEndErr_t ParseLines(const Buffer_t* assembly_code, Buffer_t* lines);
+static BackEndErr_t WriteLines(const Buffer_t* lines, Buffer_t* assembly_code);
+
+static size_t ApplyPatterns(Buffer_t* lines);
+static bool MatchPattern(PH_Line* lines, size_t lines_cnt, size_t start, const PH_Pattern* pattern,
+                         PH_Captures* captures, size_t* window);
+static bool MatchText(const char* pattern, const char* text, PH_Captures* captures);
+static bool ExpandText(const char* pattern, const PH_Captures* captures, char* text, size_t len);
+static bool LabelsStayValid(PH_Line* lines, size_t lines_cnt, size_t start, size_t window, const PH_Pattern* pattern,
+                            const PH_Captures* captures);
+
+static size_t RemoveUnreachable(Buffer_t* lines);
+static size_t RemoveUnusedLabels(Buffer_t* lines);
+static size_t CountReferences(const PH_Line* lines, size_t lines_cnt, const char* label);
+static void Compact(Buffer_t* lines);
+
+static bool IsLabel(const PH_Line* line);
+static bool IsJump(const char* op);
+static bool IsConditionalJump(const char* op);
+static const char* OppositeJump(const char* op);
+static bool EndsFlow(const char* op);
+
+/*
+ * size_delta gets the change of the instructions count, the labels are not counted.
+ * It may be positive: the inlined frame helpers are longer than their calls, but do not jump.
+ */
+BackEndErr_t PeepholeOptimization(Buffer_t* assembly_code, long* size_delta) {
+    assert( assembly_code != NULL );
+
+    Buffer_t* lines = BufferInit(0, sizeof(PH_Line));
+    if (lines == NULL) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    BackEndErr_t flag = ParseLines(assembly_code, lines);
+
+    size_t instr_cnt_before = 0;
+    for (size_t i = 0; i < lines->size; i++) {
+        instr_cnt_before += !IsLabel(&((PH_Line*)lines->data)[i]);
+    }
+
+    // one rewrite may open the way for the other, so the sweeps repeat until nothing changes
+    size_t changed_cnt = 0;
+    do {
+        changed_cnt  = ApplyPatterns(lines);
+        changed_cnt += RemoveUnreachable(lines);
+        changed_cnt += RemoveUnusedLabels(lines);
+    } while (flag == BACK_END_OK && changed_cnt != 0);
+
+    size_t instr_cnt_after = 0;
+    for (size_t i = 0; i < lines->size; i++) {
+        instr_cnt_after += !IsLabel(&((PH_Line*)lines->data)[i]);
+    }
+
+    if (flag == BACK_END_OK) {
+        flag = WriteLines(lines, assembly_code);
+    }
+
+    BufferDestroy(&lines);
+
+    if (size_delta != NULL) {
+        *size_delta = (long)instr_cnt_after - (long)instr_cnt_before;
+    }
+
+    return flag;
+}
+
+// ================================== TEXT ==================================
+
+/* every line holds one instruction or one label, the comments and the empty lines are dropped */
+static BackEndErr_t ParseLines(const Buffer_t* assembly_code, Buffer_t* lines) {
+    assert( assembly_code != NULL );
+    assert( lines         != NULL );
+
+    const char* text = (const char*)assembly_code->data;
+    size_t size = assembly_code->size;
+
+    for (size_t i = 0; i < size && text[i] != '\0'; ) {
+        size_t end = i;
+        while (end < size && text[end] != '\n' && text[end] != '\0') {
+            end++;
+        }
+
+        size_t stop = i;
+        while (stop < end && text[stop] != ';') {
+            stop++;
+        }
+
+        char line_text[MAX_LEN] = "";
+        size_t len = stop - i < (size_t)MAX_LEN - 1 ? stop - i : (size_t)MAX_LEN - 1;
+        memcpy(line_text, text + i, len);
+
+        i = end + 1;
+
+        PH_Line line = {};
+        char* word = line_text;
+        while (isspace((unsigned char)*word)) {
+            word++;
+        }
+
+        if (*word == '\0') {
+            continue;
+        }
+
+        if (*word == ':') {
+            strcpy(line.op, ":");
+            word++;
+        } else {
+            size_t op_len = 0;
+            while (word[op_len] != '\0' && !isspace((unsigned char)word[op_len])) {
+                op_len++;
+            }
+
+            if (op_len >= PH_OP_LEN) {
+                return BACK_END_ERROR;
+            }
+
+            memcpy(line.op, word, op_len);
+            word += op_len;
+        }
+
+        while (isspace((unsigned char)*word)) {
+            word++;
+        }
+
+        size_t arg_len = strlen(word);
+        while (arg_len != 0 && isspace((unsigned char)word[arg_len - 1])) {
+            arg_len--;
+        }
+
+        if (arg_len >= PH_ARG_LEN) {
+            return BACK_END_ERROR;
+        }
+
+        memcpy(line.arg, word, arg_len);
+
+        if (BufferPush(lines, &line, sizeof(PH_Line)) != BUFFER_OK) {
+            return BACK_END_BUFFER_FAILED;
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+static BackEndErr_t WriteLines(const Buffer_t* lines, Buffer_t* assembly_code) {
+    assert( lines         != NULL );
+    assert( assembly_code != NULL );
+
+    assembly_code->size = 0;
+
+    const PH_Line* data = (const PH_Line*)lines->data;
+    for (size_t i = 0; i < lines->size; i++) {
+        char temp_buffer[MAX_LEN] = "";
+
+        int len = 0;
+        if (IsLabel(&data[i])) {
+            len = snprintf(temp_buffer, MAX_LEN, ": %s\n", data[i].arg);
+        } else if (data[i].arg[0] != '\0') {
+            len = snprintf(temp_buffer, MAX_LEN, "%s %s\n", data[i].op, data[i].arg);
+        } else {
+            len = snprintf(temp_buffer, MAX_LEN, "%s\n", data[i].op);
+        }
+
+        if (BufferPush(assembly_code, temp_buffer, (size_t)len) != BUFFER_OK) {
+            return BACK_END_BUFFER_FAILED;
+        }
+    }
+
+    return BACK_END_OK;
+}
+
+// ================================= PATTERNS =================================
+
+static size_t ApplyPatterns(Buffer_t* lines) {
+    assert( lines != NULL );
+
+    size_t patterns_cnt = sizeof(patterns) / sizeof(patterns[0]);
+    size_t applied_cnt = 0;
+
+    PH_Line* data = (PH_Line*)lines->data;
+
+    for (size_t i = 0; i < lines->size; i++) {
+        for (size_t p = 0; p < patterns_cnt; p++) {
+            PH_Captures captures = {};
+            size_t window = 0;
+
+            if (    !MatchPattern(data, lines->size, i, &patterns[p], &captures, &window)
+                ||  !LabelsStayValid(data, lines->size, i, window, &patterns[p], &captures) ) {
+                continue;
+            }
+
+            // the replacement is never longer than the window, except the inlined helpers
+            PH_Line replacement[PH_WINDOW_LEN] = {};
+            size_t replace_cnt = 0;
+            bool expanded = true;
+
+            for (; patterns[p].replace[replace_cnt] != NULL; replace_cnt++) {
+                const char* pattern_line = patterns[p].replace[replace_cnt];
+                const char* space = strchr(pattern_line, ' ');
+
+                char op_pattern[PH_OP_LEN] = "";
+                size_t op_len = space != NULL ? (size_t)(space - pattern_line) : strlen(pattern_line);
+                memcpy(op_pattern, pattern_line, op_len);
+
+                PH_Line* line = &replacement[replace_cnt];
+
+                if (op_pattern[0] == '!') {
+                    char jump[PH_OP_LEN] = "";
+                    expanded = expanded && ExpandText(op_pattern + 1, &captures, jump, PH_OP_LEN);
+
+                    const char* opposite = OppositeJump(jump);
+                    expanded = expanded && opposite != NULL;
+                    if (opposite != NULL) {
+                        strcpy(line->op, opposite);
+                    }
+                } else {
+                    expanded = expanded && ExpandText(op_pattern, &captures, line->op, PH_OP_LEN);
+                }
+
+                if (space != NULL) {
+                    expanded = expanded && ExpandText(space + 1, &captures, line->arg, PH_ARG_LEN);
+                }
+            }
+
+            if (!expanded) {
+                continue;
+            }
+
+            for (size_t j = 0; j < window; j++) {
+                data[i + j].removed = true;
+            }
+
+            if (replace_cnt <= window) {
+                for (size_t j = 0; j < replace_cnt; j++) {
+                    data[i + j] = replacement[j];
+                }
+            } else {
+                // the tail is moved to make room for the longer replacement
+                size_t grow = replace_cnt - window;
+                for (size_t j = 0; j < grow; j++) {
+                    PH_Line empty = {};
+                    BufferPush(lines, &empty, sizeof(PH_Line));
+                }
+
+                data = (PH_Line*)lines->data;
+                memmove(&data[i + replace_cnt], &data[i + window], (lines->size - grow - i - window) * sizeof(PH_Line));
+
+                for (size_t j = 0; j < replace_cnt; j++) {
+                    data[i + j] = replacement[j];
+                }
+            }
+
+            ++applied_cnt;
+            break;
+        }
+    }
+
+    Compact(lines);
+
+    return applied_cnt;
+}
+
+static bool MatchPattern(PH_Line* lines, size_t lines_cnt, size_t start, const PH_Pattern* pattern,
+                         PH_Captures* captures, size_t* window) {
+    assert( lines    != NULL );
+    assert( pattern  != NULL );
+    assert( captures != NULL );
+    assert( window   != NULL );
+
+    size_t len = 0;
+    for (; pattern->match[len] != NULL; len++) {
+        if (start + len >= lines_cnt || lines[start + len].removed) {
+            return false;
+        }
+
+        const PH_Line* line = &lines[start + len];
+        const char* pattern_line = pattern->match[len];
+        const char* space = strchr(pattern_line, ' ');
+
+        char op_pattern[PH_OP_LEN] = "";
+        size_t op_len = space != NULL ? (size_t)(space - pattern_line) : strlen(pattern_line);
+        memcpy(op_pattern, pattern_line, op_len);
+
+        if (op_pattern[0] == '$' && !IsConditionalJump(line->op)) {
+            return false;
+        }
+
+        if (!MatchText(op_pattern, line->op, captures) || !MatchText(space != NULL ? space + 1 : "", line->arg, captures)) {
+            return false;
+        }
+    }
+
+    *window = len;
+
+    return true;
+}
+
+/* the capture takes the word up to the next character of the pattern */
+static bool MatchText(const char* pattern, const char* text, PH_Captures* captures) {
+    assert( pattern  != NULL );
+    assert( text     != NULL );
+    assert( captures != NULL );
+
+    while (*pattern != '\0') {
+        if (*pattern == '$' && isdigit((unsigned char)pattern[1])) {
+            size_t idx = (size_t)(pattern[1] - '1');
+            assert( idx < PH_CAPTURES_CNT );
+
+            pattern += 2;
+
+            const char* end = *pattern != '\0' ? strchr(text, *pattern) : text + strlen(text);
+            if (end == NULL || end == text) {
+                return false;
+            }
+
+            size_t len = (size_t)(end - text);
+            if (captures->bound[idx]) {
+                if (strlen(captures->text[idx]) != len || strncmp(captures->text[idx], text, len) != 0) {
+                    return false;
+                }
+            } else {
+                memcpy(captures->text[idx], text, len);
+                captures->text[idx][len] = '\0';
+                captures->bound[idx] = true;
+            }
+
+            text = end;
+            continue;
+        }
+
+        if (*pattern != *text) {
+            return false;
+        }
+
+        pattern++;
+        text++;
+    }
+
+    return *text == '\0';
+}
+
+static bool ExpandText(const char* pattern, const PH_Captures* captures, char* text, size_t len) {
+    assert( pattern  != NULL );
+    assert( captures != NULL );
+    assert( text     != NULL );
+
+    size_t pos = 0;
+    for (; *pattern != '\0'; pattern++) {
+        if (*pattern == '$' && isdigit((unsigned char)pattern[1])) {
+            size_t idx = (size_t)(pattern[1] - '1');
+            assert( idx < PH_CAPTURES_CNT );
+
+            size_t capture_len = strlen(captures->text[idx]);
+            if (!captures->bound[idx] || pos + capture_len >= len) {
+                return false;
+            }
+
+            memcpy(text + pos, captures->text[idx], capture_len);
+            pos += capture_len;
+            pattern++;
+            continue;
+        }
+
+        if (pos + 1 >= len) {
+            return false;
+        }
+
+        text[pos++] = *pattern;
+    }
+
+    text[pos] = '\0';
+
+    return true;
+}
+
+/* label, which the replacement drops, must not be a target of the jumps out of the window */
+static bool LabelsStayValid(PH_Line* lines, size_t lines_cnt, size_t start, size_t window, const PH_Pattern* pattern,
+                            const PH_Captures* captures) {
+    assert( lines    != NULL );
+    assert( pattern  != NULL );
+    assert( captures != NULL );
+
+    for (size_t i = start; i < start + window; i++) {
+        if (!IsLabel(&lines[i])) {
+            continue;
+        }
+
+        bool kept = false;
+        for (size_t j = 0; pattern->replace[j] != NULL && !kept; j++) {
+            char label[PH_ARG_LEN] = "";
+
+            kept =     pattern->replace[j][0] == ':'
+                    && ExpandText(pattern->replace[j] + 2, captures, label, PH_ARG_LEN)
+                    && strcmp(label, lines[i].arg) == 0;
+        }
+
+        if (kept) {
+            continue;
+        }
+
+        size_t inner_cnt = CountReferences(lines + start, window, lines[i].arg);
+        if (inner_cnt != CountReferences(lines, lines_cnt, lines[i].arg)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ================================ CONTROL FLOW ================================
+
+/* instructions after the unconditional jump are dead up to the next label */
+static size_t RemoveUnreachable(Buffer_t* lines) {
+    assert( lines != NULL );
+
+    PH_Line* data = (PH_Line*)lines->data;
+    size_t removed_cnt = 0;
+    bool reachable = true;
+
+    for (size_t i = 0; i < lines->size; i++) {
+        if (IsLabel(&data[i])) {
+            reachable = true;
+            continue;
+        }
+
+        if (!reachable) {
+            data[i].removed = true;
+            ++removed_cnt;
+            continue;
+        }
+
+        reachable = !EndsFlow(data[i].op);
+    }
+
+    Compact(lines);
+
+    return removed_cnt;
+}
+
+static size_t RemoveUnusedLabels(Buffer_t* lines) {
+    assert( lines != NULL );
+
+    PH_Line* data = (PH_Line*)lines->data;
+    size_t removed_cnt = 0;
+
+    for (size_t i = 0; i < lines->size; i++) {
+        if (IsLabel(&data[i]) && CountReferences(data, lines->size, data[i].arg) == 0) {
+            data[i].removed = true;
+            ++removed_cnt;
+        }
+    }
+
+    Compact(lines);
+
+    return removed_cnt;
+}
+
+static size_t CountReferences(const PH_Line* lines, size_t lines_cnt, const char* label) {
+    assert( lines != NULL );
+    assert( label != NULL );
+
+    size_t cnt = 0;
+    for (size_t i = 0; i < lines_cnt; i++) {
+        if (    !lines[i].removed && (IsJump(lines[i].op) || strcmp(lines[i].op, "CALL") == 0)
+            &&  strcmp(lines[i].arg, label) == 0 ) {
+            ++cnt;
+        }
+    }
+
+    return cnt;
+}
+
+static void Compact(Buffer_t* lines) {
+    assert( lines != NULL );
+
+    PH_Line* data = (PH_Line*)lines->data;
+    size_t size = 0;
+
+    for (size_t i = 0; i < lines->size; i++) {
+        if (!data[i].removed) {
+            data[size++] = data[i];
+        }
+    }
+
+    lines->size = size;
+}
+
+// =================================== OPCODES ===================================
+
+static bool IsLabel(const PH_Line* line) {
+    assert( line != NULL );
+
+    return strcmp(line->op, ":") == 0;
+}
+
+static bool IsJump(const char* op) {
+    assert( op != NULL );
+
+    return strcmp(op, "JMP") == 0 || IsConditionalJump(op);
+}
+
+static bool IsConditionalJump(const char* op) {
+    assert( op != NULL );
+
+    return OppositeJump(op) != NULL;
+}
+
+static const char* OppositeJump(const char* op) {
+    assert( op != NULL );
+
+    static const char* const opposites[][2] = {
+        {"JA",  "JBE"},  {"JAE",  "JB"},  {"JE",  "JNE"},
+        {"FJA", "FJBE"}, {"FJAE", "FJB"}, {"FJE", "FJNE"},
+    };
+
+    for (size_t i = 0; i < sizeof(opposites) / sizeof(opposites[0]); i++) {
+        if (strcmp(op, opposites[i][0]) == 0) {
+            return opposites[i][1];
+        }
+        if (strcmp(op, opposites[i][1]) == 0) {
+            return opposites[i][0];
+        }
+    }
+
+    return NULL;
+}
+
+static bool EndsFlow(const char* op) {
+    assert( op != NULL );
+
+    return strcmp(op, "JMP") == 0 || strcmp(op, "RET") == 0 || strcmp(op, "HLT") == 0;
+}
@@ -0,0 +1,320 @@
+#include "../../include/back_end/slot_coloring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t SC_PARAMETER = (size_t)-1;    // binding of a parameter, its cell is not colored
+
+/* the positions number the mentions, the declarations and the loop bounds in the order of the code */
+typedef struct SC_Local {
+    const AST_Node* var_dec;
+    size_t start;           // the declaration stores the value
+    size_t end;             // the last mention, a loop around a mention extends it to the end of the loop
+} SC_Local;
+
+typedef struct SC_Binding {
+    const char* name;
+    size_t local;           // index in the locals or SC_PARAMETER
+    size_t depth;           // depth of the block, which declared it
+} SC_Binding;
+
+typedef struct SC_Setup {
+    Buffer_t* locals;       // SC_Local in the order of the declarations
+    Buffer_t* bindings;     // SC_Binding of the visible names, the inner ones are the last
+    size_t position;
+    size_t depth;
+} SC_Setup;
+
+static BackEndErr_t ScanNode(SC_Setup* setup, const AST_Node* node);
+static BackEndErr_t ScanBlock(SC_Setup* setup, const AST_Node* chain);
+static BackEndErr_t ScanLoop(SC_Setup* setup, const AST_Node* loop);
+static BackEndErr_t ScanVarDec(SC_Setup* setup, const AST_Node* var_dec);
+static void ScanMention(SC_Setup* setup, const AST_Node* variable);
+
+static const SC_Binding* FindBinding(const SC_Setup* setup, const char* name);
+static BackEndErr_t Bind(SC_Setup* setup, const char* name, size_t local);
+
+static BackEndErr_t ColorLocals(const SC_Setup* setup, Buffer_t* frame_slots, size_t* slots_cnt);
+
+/*
+ * Locals of the function, which live in the different parts of its body,
+ * share the cells of the frame. A local lives from its declaration to its last mention,
+ * the mention inside of a loop, which started after the declaration, keeps it alive
+ * till the end of the loop: the next iteration may read it again.
+ * Intervals are colored greedily in the order of their starts, which takes
+ * as many cells, as many locals live at the same time at most.
+ */
+BackEndErr_t StackSlotColoring(const AST_Node* func_dec, Buffer_t* frame_slots, size_t* slots_cnt) {
+    assert( AST_IsFuncDec(func_dec) );
+    assert( frame_slots != NULL );
+    assert( slots_cnt   != NULL );
+
+    SC_Setup setup = {
+        .locals   = BufferInit(0, sizeof(SC_Local)),
+        .bindings = BufferInit(0, sizeof(SC_Binding)),
+        .position = 0,
+        .depth    = 0
+    };
+
+    BackEndErr_t flag = BACK_END_BUFFER_FAILED;
+
+    if (setup.locals != NULL && setup.bindings != NULL) {
+        flag = BACK_END_OK;
+
+        // parameters are declared in the scope of the body
+        for (const AST_Node* param = func_dec->right->left; param != NULL && flag == BACK_END_OK; param = param->left) {
+            flag = Bind(&setup, param->right->data.variable, SC_PARAMETER);
+        }
+
+        if (flag == BACK_END_OK) {
+            flag = ScanNode(&setup, func_dec->right->right);
+        }
+
+        if (flag == BACK_END_OK) {
+            flag = ColorLocals(&setup, frame_slots, slots_cnt);
+        }
+    }
+
+    if (setup.locals != NULL) {
+        BufferDestroy(&setup.locals);
+    }
+    if (setup.bindings != NULL) {
+        BufferDestroy(&setup.bindings);
+    }
+
+    return flag;
+}
+
+// =================================== SCAN ===================================
+
+static BackEndErr_t ScanNode(SC_Setup* setup, const AST_Node* node) {
+    assert( setup != NULL );
+
+    if (node == NULL) {
+        return BACK_END_OK;
+    }
+
+    if (AST_IsVarDec(node)) {
+        return ScanVarDec(setup, node);
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        ScanMention(setup, node);
+        return BACK_END_OK;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        return ScanNode(setup, node->left); // name of the callee is not a variable
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_WHILE)) {
+        return ScanLoop(setup, node);
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_IF) || AST_IsOperation(node, AST_ELEM_OPERATION_ELSE)) {
+        BackEndErr_t flag = ScanNode(setup, node->left);
+        if (flag != BACK_END_OK) {
+            return flag;
+        }
+
+        return ScanBlock(setup, node->right);
+    }
+
+    // the chain, which is a statement of another chain, is a nested block
+    if (    AST_IsOperation(node, AST_ELEM_OPERATION_SENTINEL)
+        &&  AST_IsOperation(node->parent, AST_ELEM_OPERATION_SENTINEL) && node->parent->left == node ) {
+        return ScanBlock(setup, node);
+    }
+
+    BackEndErr_t flag = ScanNode(setup, node->left);
+    if (flag != BACK_END_OK) {
+        return flag;
+    }
+
+    return ScanNode(setup, node->right);
+}
+
+/* names declared in the block are forgotten after it */
+static BackEndErr_t ScanBlock(SC_Setup* setup, const AST_Node* chain) {
+    assert( setup != NULL );
+
+    size_t bindings_cnt = setup->bindings->size;
+    ++setup->depth;
+
+    BackEndErr_t flag = BACK_END_OK;
+
+    if (AST_IsOperation(chain, AST_ELEM_OPERATION_SENTINEL)) {
+        flag = ScanNode(setup, chain->left);
+        if (flag == BACK_END_OK) {
+            flag = ScanNode(setup, chain->right);
+        }
+    } else {
+        flag = ScanNode(setup, chain);
+    }
+
+    --setup->depth;
+    setup->bindings->size = bindings_cnt;
+
+    return flag;
+}
+
+/* condition is read on each iteration too, so it belongs to the loop */
+static BackEndErr_t ScanLoop(SC_Setup* setup, const AST_Node* loop) {
+    assert( setup != NULL );
+    assert( loop  != NULL );
+
+    size_t loop_start = ++setup->position;
+
+    BackEndErr_t flag = ScanNode(setup, loop->left);
+    if (flag == BACK_END_OK) {
+        flag = ScanBlock(setup, loop->right);
+    }
+
+    size_t loop_end = ++setup->position;
+
+    SC_Local* locals = (SC_Local*)setup->locals->data;
+    for (size_t i = 0; i < setup->locals->size; i++) {
+        if (locals[i].start < loop_start && locals[i].end > loop_start) {
+            locals[i].end = loop_end;
+        }
+    }
+
+    return flag;
+}
+
+/*
+ * The initializer is computed before the declared name is visible, so the local may take
+ * the cell of a local, which dies in its initializer. Declaration of the name, which is already
+ * declared in the same block, is the assignment to it: the symbol table keeps the first one.
+ */
+static BackEndErr_t ScanVarDec(SC_Setup* setup, const AST_Node* var_dec) {
+    assert( setup   != NULL );
+    assert( var_dec != NULL );
+
+    BackEndErr_t flag = ScanNode(setup, AST_VarDecInitializer(var_dec));
+    if (flag != BACK_END_OK) {
+        return flag;
+    }
+
+    const AST_Node* identifier = AST_VarDecIdentifier(var_dec);
+
+    const SC_Binding* binding = FindBinding(setup, identifier->data.variable);
+    if (binding != NULL && binding->depth == setup->depth) {
+        ScanMention(setup, identifier);
+        return BACK_END_OK;
+    }
+
+    SC_Local local = {
+        .var_dec = var_dec,
+        .start   = ++setup->position,
+        .end     = setup->position
+    };
+
+    if (BufferPush(setup->locals, &local, sizeof(SC_Local)) != BUFFER_OK) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    return Bind(setup, identifier->data.variable, setup->locals->size - 1);
+}
+
+/* names, which are not declared in the function, are not its locals */
+static void ScanMention(SC_Setup* setup, const AST_Node* variable) {
+    assert( setup    != NULL );
+    assert( variable != NULL );
+
+    const SC_Binding* binding = FindBinding(setup, variable->data.variable);
+    if (binding == NULL || binding->local == SC_PARAMETER) {
+        return;
+    }
+
+    ((SC_Local*)setup->locals->data)[binding->local].end = ++setup->position;
+}
+
+// ================================== BINDINGS ==================================
+
+static const SC_Binding* FindBinding(const SC_Setup* setup, const char* name) {
+    assert( setup != NULL );
+    assert( name  != NULL );
+
+    const SC_Binding* bindings = (const SC_Binding*)setup->bindings->data;
+
+    for (size_t i = setup->bindings->size; i > 0; i--) {
+        if (strcmp(bindings[i - 1].name, name) == 0) {
+            return &bindings[i - 1];
+        }
+    }
+
+    return NULL;
+}
+
+static BackEndErr_t Bind(SC_Setup* setup, const char* name, size_t local) {
+    assert( setup != NULL );
+    assert( name  != NULL );
+
+    SC_Binding binding = {
+        .name  = name,
+        .local = local,
+        .depth = setup->depth
+    };
+
+    if (BufferPush(setup->bindings, &binding, sizeof(SC_Binding)) != BUFFER_OK) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    return BACK_END_OK;
+}
+
+// =================================== COLORS ===================================
+
+/* the locals start in the order of their declarations, the cell is free after the end of its last local */
+static BackEndErr_t ColorLocals(const SC_Setup* setup, Buffer_t* frame_slots, size_t* slots_cnt) {
+    assert( setup       != NULL );
+    assert( frame_slots != NULL );
+    assert( slots_cnt   != NULL );
+
+    Buffer_t* slot_ends = BufferInit(0, sizeof(size_t));
+    if (slot_ends == NULL) {
+        return BACK_END_BUFFER_FAILED;
+    }
+
+    const SC_Local* locals = (const SC_Local*)setup->locals->data;
+
+    for (size_t i = 0; i < setup->locals->size; i++) {
+        size_t* ends = (size_t*)slot_ends->data;
+
+        size_t slot = 0;
+        while (slot < slot_ends->size && ends[slot] > locals[i].start) {
+            slot++;
+        }
+
+        if (slot == slot_ends->size) {
+            if (BufferPush(slot_ends, &locals[i].end, sizeof(size_t)) != BUFFER_OK) {
+                BufferDestroy(&slot_ends);
+                return BACK_END_BUFFER_FAILED;
+            }
+        } else {
+            ends[slot] = locals[i].end;
+        }
+
+        FrameSlot frame_slot = {
+            .var_dec = locals[i].var_dec,
+            .slot    = slot
+        };
+
+        if (BufferPush(frame_slots, &frame_slot, sizeof(FrameSlot)) != BUFFER_OK) {
+            BufferDestroy(&slot_ends);
+            return BACK_END_BUFFER_FAILED;
+        }
+    }
+
+    *slots_cnt = slot_ends->size;
+
+    BufferDestroy(&slot_ends);
+
+    return BACK_END_OK;
+}
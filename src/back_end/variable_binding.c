@@ -0,0 +1,316 @@
+#include "../../include/back_end/variable_binding.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/symbol_table/symbol_table.h"
+#include "../../include/back_end/slot_coloring.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct VB_Setup {
+    SymbolTable* table;
+    Buffer_t* frames;           // FrameLayout of the bound functions
+    Buffer_t* frame_slots;      // FrameSlot of the locals of the bound function, NULL outside of the functions
+    size_t locals_base;         // offset of the cell before the first local cell in the function frame
+} VB_Setup;
+
+static BackEndErr_t BindNode(VB_Setup* setup, AST_Node* node);
+static BackEndErr_t BindBlock(VB_Setup* setup, AST_Node* chain);
+static BackEndErr_t BindFunction(VB_Setup* setup, AST_Node* func_dec);
+static BackEndErr_t BindParams(VB_Setup* setup, AST_Node* param);
+static BackEndErr_t BindVarDec(VB_Setup* setup, AST_Node* var_dec);
+
+static size_t FindFrame(const VB_Setup* setup, const AST_Node* func_dec);
+
+static BackEndErr_t Declare(VB_Setup* setup, AST_Node* identifier, ConstType type, size_t offset);
+static void Resolve(VB_Setup* setup, AST_Node* variable);
+static DataType ToDataType(ConstType type);
+
+/*
+ * Each variable node gets the cell of its declaration once, before the code generation:
+ * the generator reads the static depth and the slot from the node and never looks the name up.
+ * The frames are laid out as the generator takes them: parameters are the cells 1..n of the
+ * function frame, the hidden cells of the generator, which are already in the frames, and
+ * the colored locals follow them, the global declarations push the cells one by one,
+ * and the global blocks get the frames of their own.
+ */
+BackEndErr_t VariableBinding(AST* ast, Buffer_t* frames) {
+    assert( ast    != NULL );
+    assert( frames != NULL );
+
+    VB_Setup setup = {
+        .table       = SymbolTableInit(),
+        .frames      = frames,
+        .frame_slots = NULL,
+        .locals_base = 0
+    };
+
+    if (setup.table == NULL) {
+        return BACK_END_SYMBOL_TABLE_FAILED;
+    }
+
+    BackEndErr_t flag = BindNode(&setup, ast->root);
+
+    SymbolTableDestroy(&setup.table);
+
+    return flag;
+}
+
+// =================================== NODES ===================================
+
+/* mirrors the walk of the generator: the names are visible in the same places */
+static BackEndErr_t BindNode(VB_Setup* setup, AST_Node* node) {
+    assert( setup != NULL );
+
+    if (node == NULL) {
+        return BACK_END_OK;
+    }
+
+    if (AST_IsFuncDec(node)) {
+        return BindFunction(setup, node);
+    }
+
+    if (AST_IsVarDec(node)) {
+        return BindVarDec(setup, node);
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        Resolve(setup, node);
+
+        // targets of the chained assignment hang on each other
+        BackEndErr_t flag = BindNode(setup, node->left);
+        if (flag != BACK_END_OK) {
+            return flag;
+        }
+
+        return BindNode(setup, node->right);
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        return BindNode(setup, node->left); // name of the callee is not a variable
+    }
+
+    if (    AST_IsOperation(node, AST_ELEM_OPERATION_IF) || AST_IsOperation(node, AST_ELEM_OPERATION_ELSE)
+        ||  AST_IsOperation(node, AST_ELEM_OPERATION_WHILE) ) {
+        BackEndErr_t flag = BindNode(setup, node->left);
+        if (flag != BACK_END_OK) {
+            return flag;
+        }
+
+        return BindBlock(setup, node->right);
+    }
+
+    // the chain, which is a statement of another chain, is a nested block
+    if (    AST_IsOperation(node, AST_ELEM_OPERATION_SENTINEL)
+        &&  AST_IsOperation(node->parent, AST_ELEM_OPERATION_SENTINEL) && node->parent->left == node ) {
+        return BindBlock(setup, node);
+    }
+
+    BackEndErr_t flag = BindNode(setup, node->left);
+    if (flag != BACK_END_OK) {
+        return flag;
+    }
+
+    return BindNode(setup, node->right);
+}
+
+/* block of the function shares its frame, the global block takes the frame of its own */
+static BackEndErr_t BindBlock(VB_Setup* setup, AST_Node* chain) {
+    assert( setup != NULL );
+
+    SymbolTableErr_t table_flag = SYM_TAB_OK;
+
+    if (setup->table->current_scope == setup->table->global_scope) {
+        table_flag = SymbolTableEnterScope(setup->table);
+    } else {
+        table_flag = SymbolTableEnterBlock(setup->table);
+    }
+
+    if (table_flag != SYM_TAB_OK) {
+        return BACK_END_SYMBOL_TABLE_FAILED;
+    }
+
+    BackEndErr_t flag = BACK_END_OK;
+
+    if (AST_IsOperation(chain, AST_ELEM_OPERATION_SENTINEL)) {
+        flag = BindNode(setup, chain->left);
+        if (flag == BACK_END_OK) {
+            flag = BindNode(setup, chain->right);
+        }
+    } else {
+        flag = BindNode(setup, chain);
+    }
+
+    SymbolTableExitScope(setup->table);
+
+    return flag;
+}
+
+// ================================ DECLARATIONS ================================
+
+static BackEndErr_t BindFunction(VB_Setup* setup, AST_Node* func_dec) {
+    assert( setup    != NULL );
+    assert( func_dec != NULL );
+
+    if (SymbolTableEnterScope(setup->table) != SYM_TAB_OK) {
+        return BACK_END_SYMBOL_TABLE_FAILED;
+    }
+
+    BackEndErr_t flag = BindParams(setup, func_dec->right->left);
+
+    size_t frame = FindFrame(setup, func_dec);
+    size_t locals_cnt = 0;
+
+    if (flag == BACK_END_OK && frame == setup->frames->size) {
+        FrameLayout layout = {
+            .func_dec   = func_dec,
+            .hidden_cnt = 0,
+            .locals_cnt = 0
+        };
+
+        if (BufferPush(setup->frames, &layout, sizeof(FrameLayout)) != BUFFER_OK) {
+            flag = BACK_END_BUFFER_FAILED;
+        }
+    }
+
+    if (flag == BACK_END_OK) {
+        setup->frame_slots = BufferInit(0, sizeof(FrameSlot));
+        flag = setup->frame_slots != NULL ? StackSlotColoring(func_dec, setup->frame_slots, &locals_cnt)
+                                          : BACK_END_BUFFER_FAILED;
+    }
+
+    if (flag == BACK_END_OK) {
+        FrameLayout* layout = &((FrameLayout*)setup->frames->data)[frame];
+        layout->locals_cnt = locals_cnt;
+
+        setup->locals_base = setup->table->current_scope->scope_ram_offset + layout->hidden_cnt;
+        flag = BindNode(setup, func_dec->right->right);
+    }
+
+    if (setup->frame_slots != NULL) {
+        BufferDestroy(&setup->frame_slots);
+    }
+
+    SymbolTableExitScope(setup->table);
+
+    return flag;
+}
+
+/* arguments are pushed first to last, so the last parameter of the list takes the first cell */
+static BackEndErr_t BindParams(VB_Setup* setup, AST_Node* param) {
+    assert( setup != NULL );
+
+    if (param == NULL) {
+        return BACK_END_OK;
+    }
+
+    BackEndErr_t flag = BindParams(setup, param->left);
+    if (flag != BACK_END_OK) {
+        return flag;
+    }
+
+    size_t offset = ++setup->table->current_scope->scope_ram_offset;
+
+    return Declare(setup, param->right, param->data.declaration_type, offset);
+}
+
+/* the initializer is computed before the declared name is visible */
+static BackEndErr_t BindVarDec(VB_Setup* setup, AST_Node* var_dec) {
+    assert( setup   != NULL );
+    assert( var_dec != NULL );
+
+    BackEndErr_t flag = BindNode(setup, AST_VarDecInitializer(var_dec));
+    if (flag != BACK_END_OK) {
+        return flag;
+    }
+
+    size_t offset = 0;
+
+    if (setup->frame_slots != NULL) {
+        const FrameSlot* frame_slots = (const FrameSlot*)setup->frame_slots->data;
+
+        size_t i = 0;
+        while (i < setup->frame_slots->size && frame_slots[i].var_dec != var_dec) {
+            i++;
+        }
+
+        // declaration of the name, which is already declared in the block, gets no cell: Declare reports it
+        if (i < setup->frame_slots->size) {
+            offset = setup->locals_base + 1 + frame_slots[i].slot;
+        }
+    } else {
+        offset = ++setup->table->current_scope->scope_ram_offset;
+    }
+
+    return Declare(setup, AST_VarDecIdentifier(var_dec), var_dec->data.declaration_type, offset);
+}
+
+/* index of the layout of the function, the size of the frames if it has none yet */
+static size_t FindFrame(const VB_Setup* setup, const AST_Node* func_dec) {
+    assert( setup    != NULL );
+    assert( func_dec != NULL );
+
+    const FrameLayout* frames = (const FrameLayout*)setup->frames->data;
+
+    size_t i = 0;
+    while (i < setup->frames->size && frames[i].func_dec != func_dec) {
+        i++;
+    }
+
+    return i;
+}
+
+// ================================== SYMBOLS ==================================
+
+/* name, which is declared again in the same scope, keeps its first cell */
+static BackEndErr_t Declare(VB_Setup* setup, AST_Node* identifier, ConstType type, size_t offset) {
+    assert( setup      != NULL );
+    assert( identifier != NULL );
+
+    SymbolTableErr_t table_flag = SymbolTableInsert(setup->table, identifier->data.variable, SYM_TYPE_VARIABLE,
+                                                    ToDataType(type), identifier, offset);
+
+    if (table_flag == SYM_TAB_REDECLARED) {
+        fprintf(stderr, "VariableBinding: \"%s\" is already declared in this scope\n", identifier->data.variable);
+    } else if (table_flag != SYM_TAB_OK) {
+        return BACK_END_SYMBOL_TABLE_FAILED;
+    }
+
+    Resolve(setup, identifier);
+
+    return BACK_END_OK;
+}
+
+static void Resolve(VB_Setup* setup, AST_Node* variable) {
+    assert( setup    != NULL );
+    assert( variable != NULL );
+
+    const SymbolData* symbol_data = SymbolTableLookUp(setup->table, variable->data.variable);
+
+    if (symbol_data == NULL) {
+        variable->binding.declaration = NULL;
+        return;
+    }
+
+    variable->binding.declaration = (const AST_Node*)symbol_data->ast_node;
+    variable->binding.depth       = symbol_data->scope_level;
+    variable->binding.slot        = symbol_data->symbol_ram_offset;
+}
+
+static DataType ToDataType(ConstType type) {
+    switch (type) {
+    case CONST_TYPE_SHORT:      return DATA_TYPE_SHORT;
+    case CONST_TYPE_INT:        return DATA_TYPE_INT;
+    case CONST_TYPE_LONG:       return DATA_TYPE_LONG;
+    case CONST_TYPE_DOUBLE:     return DATA_TYPE_DOUBLE;
+    case CONST_TYPE_CHAR:       return DATA_TYPE_CHAR;
+    case CONST_TYPE_VOID:       return DATA_TYPE_VOID;
+
+    case CONST_TYPE_UNDEFINED:
+    default:
+        return DATA_TYPE_INT;
+    }
+}
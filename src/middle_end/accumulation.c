@@ -0,0 +1,391 @@
+#include "../../include/middle_end/accumulation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+
+const char* const ACC_NAME     = "__acc";   // operation of the unfinished calls applied to their operands
+const int         ACC_NAME_LEN = 256;
+
+typedef struct Accumulator {
+    AST* ast;
+    size_t transformed_cnt;
+} Accumulator;
+
+/* "return operand op f(args);" or "return f(args) op operand;" closes the body of f */
+typedef struct LinearRecursion {
+    AST_Node* func_dec;
+    AST_Node** tail_slot;           // slot of the return in the last link of the body
+    AST_ElemOperation operation;
+    AST_Node* operand;
+    AST_Node* call;
+} LinearRecursion;
+
+static bool GetLinearRecursion(Accumulator* acc, AST_Node* func_dec, LinearRecursion* rec);
+static AST_Node** TailReturnSlot(AST_Node* body);
+static bool IsSelfCall(const AST_Node* node, const char* func_name);
+static size_t CountSelfCalls(const AST_Node* node, const char* func_name);
+static bool IsIntOnly(Accumulator* acc, const AST_Node* node);
+static bool UsesOnlyParams(const AST_Node* node, const AST_Node* params);
+static bool DeclaresParam(AST_Node* body, const AST_Node* params);
+static bool ContainsLoopBreak(const AST_Node* node);
+
+static void TransformRecursion(LinearRecursion* rec);
+static void AccumulateReturns(AST_Node* node, AST_ElemOperation operation);
+static AST_Node* BuildUpdates(LinearRecursion* rec);
+
+static AST_Node* MakeVariable(const char* name);
+static AST_Node* MakeAssignment(const char* name, AST_Node* value);
+static AST_Node* MakeLink(AST_Node* statement);
+
+/*
+ * Linear recursion through + or * is turned into the loop: the operation of each unfinished call
+ * is applied to the accumulator at once, so the recursive call becomes the assignment of its
+ * arguments to the parameters and the next iteration. The base returns give the accumulated value.
+ *
+ *     int f(int n) {                          int f(int n) {
+ *         if (n == 0) {                           int __acc = 1;
+ *             return 1;                           while (1) {
+ *         }                           =>              if (n == 0) { return __acc * 1; }
+ *         return n * f(n - 1);                        __acc = __acc * n;
+ *     }                                               n = n - 1;
+ *                                                 }
+ *                                             }
+ *
+ * The operations are associative and commutative for the integers only, so the functions
+ * with the other types are not changed.
+ */
+MiddleEndErr_t AccumulatorTransformation(AST* ast, size_t* transformed_cnt) {
+    assert( ast != NULL );
+
+    Accumulator acc = {
+        .ast = ast,
+        .transformed_cnt = 0
+    };
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+        LinearRecursion rec = {};
+
+        if (AST_IsFuncDec(statement) && GetLinearRecursion(&acc, statement, &rec)) {
+            TransformRecursion(&rec);
+            ++acc.transformed_cnt;
+        }
+    }
+
+    if (transformed_cnt != NULL) {
+        *transformed_cnt = acc.transformed_cnt;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ================================== MATCHING ==================================
+
+static bool GetLinearRecursion(Accumulator* acc, AST_Node* func_dec, LinearRecursion* rec) {
+    assert( acc      != NULL );
+    assert( func_dec != NULL );
+    assert( rec      != NULL );
+
+    AST_Node* identifier = func_dec->right;
+    const char* name = identifier->data.variable;
+    AST_Node* body = identifier->right;
+
+    if (    strcmp(name, "main") == 0 || func_dec->data.declaration_type != CONST_TYPE_INT
+        ||  identifier->left == NULL  || !AST_IsOperation(body, AST_ELEM_OPERATION_SENTINEL) ) {
+        return false;
+    }
+
+    for (const AST_Node* param = identifier->left; param != NULL; param = param->left) {
+        if (param->data.declaration_type != CONST_TYPE_INT) {
+            return false;
+        }
+    }
+
+    AST_Node** tail_slot = TailReturnSlot(body);
+    if (tail_slot == NULL) {
+        return false;
+    }
+
+    AST_Node* result = (*tail_slot)->right;
+    if (!AST_IsOperation(result, AST_ELEM_OPERATION_ADD) && !AST_IsOperation(result, AST_ELEM_OPERATION_MUL)) {
+        return false;
+    }
+
+    bool call_is_left = IsSelfCall(result->left, name);
+    AST_Node* call    = call_is_left ? result->left  : result->right;
+    AST_Node* operand = call_is_left ? result->right : result->left;
+
+    // the operand is computed before the arguments are assigned to the parameters
+    if (    !IsSelfCall(call, name) || CountSelfCalls(body, name) != 1
+        ||  HasSideEffects(operand) || !UsesOnlyParams(operand, identifier->left) ) {
+        return false;
+    }
+
+    const AST_Node* param = identifier->left;
+    const AST_Node* arg   = call->left;
+    for (; param != NULL && arg != NULL; param = param->left, arg = arg->left) {}
+
+    // locals of the body are declared in the loop, so they must not be the parameters again
+    if (    param != NULL || arg != NULL || !IsIntOnly(acc, body)
+        ||  DeclaresParam(body, identifier->left) || ContainsLoopBreak(body) ) {
+        return false;
+    }
+
+    rec->func_dec  = func_dec;
+    rec->tail_slot = tail_slot;
+    rec->operation = result->data.operation;
+    rec->operand   = operand;
+    rec->call      = call;
+
+    return true;
+}
+
+/* the return ends the last link or it is its statement */
+static AST_Node** TailReturnSlot(AST_Node* body) {
+    assert( body != NULL );
+
+    AST_Node* last = body;
+    while (AST_IsOperation(AST_ChainNext(last), AST_ELEM_OPERATION_SENTINEL)) {
+        last = AST_ChainNext(last);
+    }
+
+    if (AST_IsOperation(last->right, AST_ELEM_OPERATION_RETURN)) {
+        return &last->right;
+    }
+
+    if (last->right == NULL && AST_IsOperation(last->left, AST_ELEM_OPERATION_RETURN)) {
+        return &last->left;
+    }
+
+    return NULL;
+}
+
+static bool IsSelfCall(const AST_Node* node, const char* func_name) {
+    assert( func_name != NULL );
+
+    return AST_IsOperation(node, AST_ELEM_OPERATION_CALL) && strcmp(node->right->data.variable, func_name) == 0;
+}
+
+static size_t CountSelfCalls(const AST_Node* node, const char* func_name) {
+    assert( func_name != NULL );
+
+    if (node == NULL) {
+        return 0;
+    }
+
+    return     (size_t)IsSelfCall(node, func_name)
+            +  CountSelfCalls(node->left, func_name) + CountSelfCalls(node->right, func_name);
+}
+
+/* declarations, constants and called functions are int, the input may be not */
+static bool IsIntOnly(Accumulator* acc, const AST_Node* node) {
+    assert( acc != NULL );
+
+    if (node == NULL) {
+        return true;
+    }
+
+    if (node->type == AST_ELEM_TYPE_DECLARATION) {
+        return node->data.declaration_type == CONST_TYPE_INT && IsIntOnly(acc, node->right);
+    }
+
+    if (node->type == AST_ELEM_TYPE_CONST) {
+        return node->data.constant.type == CONST_TYPE_INT;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_INPUT)) {
+        return false;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        const AST_Node* callee = FindFuncDec(acc->ast, node->right->data.variable);
+
+        return callee != NULL && callee->data.declaration_type == CONST_TYPE_INT && IsIntOnly(acc, node->left);
+    }
+
+    return IsIntOnly(acc, node->left) && IsIntOnly(acc, node->right);
+}
+
+static bool UsesOnlyParams(const AST_Node* node, const AST_Node* params) {
+    if (node == NULL) {
+        return true;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        for (const AST_Node* param = params; param != NULL; param = param->left) {
+            if (IsVariable(node, param->right->data.variable)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    return UsesOnlyParams(node->left, params) && UsesOnlyParams(node->right, params);
+}
+
+static bool DeclaresParam(AST_Node* body, const AST_Node* params) {
+    assert( body != NULL );
+
+    for (AST_Node* link = body; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (!AST_IsVarDec(statement)) {
+            continue;
+        }
+
+        for (const AST_Node* param = params; param != NULL; param = param->left) {
+            if (IsVariable(AST_VarDecIdentifier(statement), param->right->data.variable)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* break outside of the inner loops would leave the new loop */
+static bool ContainsLoopBreak(const AST_Node* node) {
+    if (node == NULL || AST_IsOperation(node, AST_ELEM_OPERATION_WHILE)) {
+        return false;
+    }
+
+    return     AST_IsOperation(node, AST_ELEM_OPERATION_BREAK)
+            || ContainsLoopBreak(node->left) || ContainsLoopBreak(node->right);
+}
+
+// ================================ TRANSFORMATION ================================
+
+static void TransformRecursion(LinearRecursion* rec) {
+    assert( rec != NULL );
+
+    AST_Node* identifier = rec->func_dec->right;
+    AST_Node* body = identifier->right;
+
+    AST_Node* tail = *rec->tail_slot;
+    AST_Node* tail_link = tail->parent;
+
+    AST_Node* updates = BuildUpdates(rec);
+
+    *rec->tail_slot = NULL;
+    tail->parent = NULL;
+    AST_SubtreeDestroy(tail);
+
+    AccumulateReturns(body, rec->operation);
+
+    *rec->tail_slot = updates;
+    updates->parent = tail_link;
+
+    int identity = rec->operation == AST_ELEM_OPERATION_ADD ? 0 : 1;
+
+    AST_Node* initial = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_CONST, CONST_TYPE_INT, identity);
+    AST_Node* acc_dec = AST_NodeInit(NULL, NULL, MakeAssignment(ACC_NAME, initial), AST_ELEM_TYPE_DECLARATION,
+                                     CONST_TYPE_INT);
+
+    AST_Node* condition = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_CONST, CONST_TYPE_INT, 1);
+    AST_Node* loop = AST_NodeInit(NULL, condition, body, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_WHILE);
+
+    identifier->right = ChainAppend(MakeLink(acc_dec), MakeLink(loop));
+    identifier->right->parent = identifier;
+}
+
+/* "return e;" gives the accumulated operations applied to e */
+static void AccumulateReturns(AST_Node* node, AST_ElemOperation operation) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_RETURN) && node->right != NULL) {
+        AST_Node* value = node->right;
+        value->parent = NULL;
+
+        node->right = AST_NodeInit(NULL, MakeVariable(ACC_NAME), value, AST_ELEM_TYPE_OPERATION, operation);
+        node->right->parent = node;
+
+        return;
+    }
+
+    AccumulateReturns(node->left, operation);
+    AccumulateReturns(node->right, operation);
+}
+
+/*
+ * The operand goes to the accumulator, then the arguments to the parameters. The arguments
+ * are computed into the temporaries first, if more than one parameter changes:
+ * they may read the parameters, which are assigned before them.
+ */
+static AST_Node* BuildUpdates(LinearRecursion* rec) {
+    assert( rec != NULL );
+
+    AST_Node** operand_slot = GetParentNodePointer(rec->operand);
+    *operand_slot = NULL;
+    rec->operand->parent = NULL;
+
+    AST_Node* accumulated = AST_NodeInit(NULL, MakeVariable(ACC_NAME), rec->operand, AST_ELEM_TYPE_OPERATION,
+                                         rec->operation);
+    AST_Node* updates = MakeLink(MakeAssignment(ACC_NAME, accumulated));
+
+    size_t changed_cnt = 0;
+
+    const AST_Node* param = rec->func_dec->right->left;
+    for (const AST_Node* arg = rec->call->left; arg != NULL; param = param->left, arg = arg->left) {
+        changed_cnt += !IsVariable(arg->right, param->right->data.variable);
+    }
+
+    AST_Node* assignments = NULL;
+
+    param = rec->func_dec->right->left;
+    for (AST_Node* arg = rec->call->left; arg != NULL; param = param->left, arg = arg->left) {
+        const char* param_name = param->right->data.variable;
+
+        if (IsVariable(arg->right, param_name)) {
+            continue;
+        }
+
+        AST_Node* value = arg->right;
+        arg->right = NULL;
+        value->parent = NULL;
+
+        if (changed_cnt == 1) {
+            updates = ChainAppend(updates, MakeLink(MakeAssignment(param_name, value)));
+            continue;
+        }
+
+        char temp_name[ACC_NAME_LEN] = "";
+        snprintf(temp_name, ACC_NAME_LEN, "%s_%s", ACC_NAME, param_name);
+
+        AST_Node* temp_dec = AST_NodeInit(NULL, NULL, MakeAssignment(temp_name, value), AST_ELEM_TYPE_DECLARATION,
+                                          param->data.declaration_type);
+
+        updates     = ChainAppend(updates, MakeLink(temp_dec));
+        assignments = ChainAppend(assignments, MakeLink(MakeAssignment(param_name, MakeVariable(temp_name))));
+    }
+
+    return ChainAppend(updates, assignments);
+}
+
+// =================================== HELPERS ===================================
+
+static AST_Node* MakeVariable(const char* name) {
+    assert( name != NULL );
+
+    return AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_VARIABLE, name);
+}
+
+static AST_Node* MakeAssignment(const char* name, AST_Node* value) {
+    assert( name  != NULL );
+    assert( value != NULL );
+
+    return AST_NodeInit(NULL, MakeVariable(name), value, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_ASSIGNMENT);
+}
+
+static AST_Node* MakeLink(AST_Node* statement) {
+    assert( statement != NULL );
+
+    return AST_NodeInit(NULL, statement, NULL, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+}
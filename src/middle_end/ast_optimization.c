@@ -1,7 +1,171 @@
 #include "../../include/middle_end/ast_optimization.h"
 
 #include <stdio.h>
-#include <math.h>
+#include <limits.h>
 #include <assert.h>
 
 #include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+
+static size_t FoldNode(AST_Node* node);
+static size_t FoldSelect(AST_Node* select);
+
+MiddleEndErr_t ConstantFolding(AST* ast, size_t* folded_cnt) {
+    assert( ast != NULL );
+
+    size_t cnt = 0;
+    if (ast->root != NULL) {
+        cnt = FoldNode(ast->root);
+    }
+
+    if (folded_cnt != NULL) {
+        *folded_cnt = cnt;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/*
+ * Processor computes in 64 bits, but the folded constant is int: the result, which does not fit it,
+ * is left to the program, so the printed value does not depend on the optimization level
+ */
+bool EvalOperation(AST_ElemOperation operation, int left, int right, int* result) {
+    assert( result != NULL );
+
+    long wide = 0;
+
+    switch (operation) {
+    case AST_ELEM_OPERATION_ADD:
+        wide = (long)left + (long)right;
+        break;
+
+    case AST_ELEM_OPERATION_SUB:
+        wide = (long)left - (long)right;
+        break;
+
+    case AST_ELEM_OPERATION_MUL:
+        wide = (long)left * (long)right;
+        break;
+
+    case AST_ELEM_OPERATION_DIV:
+        if (right == 0) {
+            return false;
+        }
+        wide = (long)left / (long)right;
+        break;
+
+    case AST_ELEM_OPERATION_LT:
+        *result = left < right;
+        return true;
+
+    case AST_ELEM_OPERATION_GT:
+        *result = left > right;
+        return true;
+
+    case AST_ELEM_OPERATION_LE:
+        *result = left <= right;
+        return true;
+
+    case AST_ELEM_OPERATION_GE:
+        *result = left >= right;
+        return true;
+
+    case AST_ELEM_OPERATION_EE:
+        *result = left == right;
+        return true;
+
+    case AST_ELEM_OPERATION_NE:
+        *result = left != right;
+        return true;
+
+    case AST_ELEM_OPERATION_LAND:
+        *result = left != 0 && right != 0;
+        return true;
+
+    case AST_ELEM_OPERATION_LOR:
+        *result = left != 0 || right != 0;
+        return true;
+
+    case AST_ELEM_OPERATION_UNDEFINED:
+    case AST_ELEM_OPERATION_SENTINEL:
+    case AST_ELEM_OPERATION_SELECT:
+    case AST_ELEM_OPERATION_INPUT:
+    case AST_ELEM_OPERATION_PRINT:
+    case AST_ELEM_OPERATION_ASSIGNMENT:
+    case AST_ELEM_OPERATION_IF:
+    case AST_ELEM_OPERATION_ELSE:
+    case AST_ELEM_OPERATION_WHILE:
+    case AST_ELEM_OPERATION_BREAK:
+    case AST_ELEM_OPERATION_CALL:
+    case AST_ELEM_OPERATION_RETURN:
+    default:
+        return false;
+    }
+
+    if (wide < INT_MIN || wide > INT_MAX) {
+        return false;
+    }
+
+    *result = (int)wide;
+
+    return true;
+}
+
+static size_t FoldNode(AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    size_t cnt = FoldNode(node->left) + FoldNode(node->right);
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_SELECT)) {
+        return cnt + FoldSelect(node);
+    }
+
+    if (node->type != AST_ELEM_TYPE_OPERATION || !IsIntConst(node->left) || !IsIntConst(node->right)) {
+        return cnt;
+    }
+
+    int result = 0;
+    if (!EvalOperation(node->data.operation, node->left->data.constant.data.int_const,
+                                             node->right->data.constant.data.int_const, &result)) {
+        return cnt;
+    }
+
+    AST_SubtreeDestroy(node->left);
+    AST_SubtreeDestroy(node->right);
+
+    node->type = AST_ELEM_TYPE_CONST;
+    node->data.constant.type = CONST_TYPE_INT;
+    node->data.constant.data.int_const = result;
+
+    return cnt + 1;
+}
+
+/* select with the known condition is replaced with the chosen value */
+static size_t FoldSelect(AST_Node* select) {
+    assert( select != NULL );
+
+    if (!IsIntConst(select->left)) {
+        return 0;
+    }
+
+    AST_Node* values = select->right;
+    AST_Node* chosen = NULL;
+
+    if (select->left->data.constant.data.int_const != 0) {
+        chosen = values->left;
+        values->left = NULL;
+    } else {
+        chosen = values->right;
+        values->right = NULL;
+    }
+
+    *GetParentNodePointer(select) = chosen;
+    chosen->parent = select->parent;
+
+    select->parent = NULL;
+    AST_SubtreeDestroy(select);
+
+    return 1;
+}
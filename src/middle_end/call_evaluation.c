@@ -0,0 +1,488 @@
+#include "../../include/middle_end/call_evaluation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+#include "../../include/middle_end/ast_optimization.h"
+#include "../../include/middle_end/purity.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t EVAL_MAX_STEPS = 100000;   // evaluated nodes for one call of the program
+const size_t EVAL_MAX_DEPTH = 256;      // nested calls inside the compiler
+
+typedef enum EvalFlow {
+    EVAL_FLOW_NEXT,
+    EVAL_FLOW_BREAK,
+    EVAL_FLOW_RETURN,
+    EVAL_FLOW_FAILED
+} EvalFlow;
+
+typedef struct EvalBinding {
+    const char* name;
+    int value;
+    bool defined;
+} EvalBinding;
+
+typedef struct EvalSetup {
+    AST* ast;
+    const Buffer_t* pure_funcs;     // AST_Node*, declarations of the pure functions
+    Buffer_t* bindings;             // EvalBinding, variables of all frames, inner ones are at the end
+    size_t frame_base;              // first binding of the evaluated function
+    size_t steps;
+    size_t depth;
+    int result;                     // value of the last executed return
+    size_t evaluated_cnt;
+    MiddleEndErr_t flag;
+} EvalSetup;
+
+static void EvaluateCalls(EvalSetup* eval, AST_Node* node);
+static bool IsEvaluable(EvalSetup* eval, const AST_Node* call);
+static void ReplaceByConst(AST_Node* node, int value);
+
+static bool EvalCall(EvalSetup* eval, const AST_Node* call, int* value);
+static EvalFlow ExecChain(EvalSetup* eval, AST_Node* link);
+static EvalFlow ExecStatement(EvalSetup* eval, AST_Node* statement);
+static EvalFlow ExecIf(EvalSetup* eval, AST_Node* if_node);
+static EvalFlow ExecWhile(EvalSetup* eval, AST_Node* while_node);
+static EvalFlow ExecVarDec(EvalSetup* eval, const AST_Node* var_dec);
+static EvalFlow ExecAssignment(EvalSetup* eval, const AST_Node* assignment);
+static bool EvalExpression(EvalSetup* eval, const AST_Node* node, int* value);
+
+static bool Step(EvalSetup* eval);
+static bool Bind(EvalSetup* eval, const char* name, int value, bool defined);
+static EvalBinding* LookUp(EvalSetup* eval, const char* name);
+
+/*
+ * Calls of pure functions with constant arguments are run by the interpreter of the tree
+ * and replaced by their results. The call is left as it is, if the evaluation
+ * runs out of steps or depth, divides by zero or reads an undefined variable.
+ */
+MiddleEndErr_t CallEvaluation(AST* ast, size_t* evaluated_cnt) {
+    assert( ast != NULL );
+
+    Buffer_t* pure_funcs = BufferInit(0, sizeof(AST_Node*));
+    Buffer_t* bindings   = BufferInit(0, sizeof(EvalBinding));
+
+    if (pure_funcs == NULL || bindings == NULL) {
+        if (pure_funcs != NULL) {
+            BufferDestroy(&pure_funcs);
+        }
+        if (bindings != NULL) {
+            BufferDestroy(&bindings);
+        }
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    EvalSetup eval = {
+        .ast           = ast,
+        .pure_funcs    = pure_funcs,
+        .bindings      = bindings,
+        .frame_base    = 0,
+        .steps         = 0,
+        .depth         = 0,
+        .result        = 0,
+        .evaluated_cnt = 0,
+        .flag          = FindPureFunctions(ast, pure_funcs)
+    };
+
+    if (eval.flag == MIDDLE_END_OK && pure_funcs->size != 0) {
+        EvaluateCalls(&eval, ast->root);
+    }
+
+    BufferDestroy(&pure_funcs);
+    BufferDestroy(&bindings);
+
+    if (evaluated_cnt != NULL) {
+        *evaluated_cnt = eval.evaluated_cnt;
+    }
+
+    return eval.flag;
+}
+
+// ================================= CALL SITES =================================
+
+/* inner calls go first, so their results become the constant arguments of the outer ones */
+static void EvaluateCalls(EvalSetup* eval, AST_Node* node) {
+    assert( eval != NULL );
+
+    if (node == NULL || eval->flag != MIDDLE_END_OK) {
+        return;
+    }
+
+    EvaluateCalls(eval, node->left);
+    EvaluateCalls(eval, node->right);
+
+    if (!IsEvaluable(eval, node)) {
+        return;
+    }
+
+    eval->steps = 0;
+    eval->depth = 0;
+    eval->frame_base = 0;
+    eval->bindings->size = 0;
+
+    int value = 0;
+    if (EvalCall(eval, node, &value)) {
+        ReplaceByConst(node, value);
+        ++eval->evaluated_cnt;
+    }
+}
+
+static bool IsEvaluable(EvalSetup* eval, const AST_Node* call) {
+    assert( eval != NULL );
+    assert( call != NULL );
+
+    if (!AST_IsOperation(call, AST_ELEM_OPERATION_CALL)) {
+        return false;
+    }
+
+    const AST_Node* func_dec = FindFuncDec(eval->ast, call->right->data.variable);
+    if (func_dec == NULL || !ContainsNode(eval->pure_funcs, func_dec)) {
+        return false;
+    }
+
+    for (const AST_Node* arg = call->left; arg != NULL; arg = arg->left) {
+        if (!IsIntConst(arg->right)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void ReplaceByConst(AST_Node* node, int value) {
+    assert( node != NULL );
+
+    if (node->left != NULL) {
+        AST_SubtreeDestroy(node->left);
+    }
+    if (node->right != NULL) {
+        AST_SubtreeDestroy(node->right);
+    }
+
+    node->type = AST_ELEM_TYPE_CONST;
+    node->data.constant.type = CONST_TYPE_INT;
+    node->data.constant.data.int_const = value;
+}
+
+// ================================= INTERPRETER =================================
+
+/* arguments are evaluated in the frame of the caller, then the callee gets its own one */
+static bool EvalCall(EvalSetup* eval, const AST_Node* call, int* value) {
+    assert( eval  != NULL );
+    assert( call  != NULL );
+    assert( value != NULL );
+
+    AST_Node* func_dec = FindFuncDec(eval->ast, call->right->data.variable);
+    if (func_dec == NULL || !ContainsNode(eval->pure_funcs, func_dec) || eval->depth == EVAL_MAX_DEPTH) {
+        return false;
+    }
+
+    size_t frame_base = eval->bindings->size;
+
+    // parameters are unnamed until all arguments are evaluated, so they read the caller variables only
+    const AST_Node* param = func_dec->right->left;
+    for (const AST_Node* arg = call->left; arg != NULL; arg = arg->left, param = param->left) {
+        int arg_value = 0;
+
+        if (    param == NULL || !EvalExpression(eval, arg->right, &arg_value)
+            ||  !Bind(eval, NULL, arg_value, true) ) {
+            return false;
+        }
+    }
+
+    if (param != NULL) {
+        return false;
+    }
+
+    param = func_dec->right->left;
+    for (size_t i = frame_base; i < eval->bindings->size; i++, param = param->left) {
+        ((EvalBinding*)eval->bindings->data)[i].name = param->right->data.variable;
+    }
+
+    size_t caller_base = eval->frame_base;
+    eval->frame_base = frame_base;
+    ++eval->depth;
+
+    EvalFlow flow = ExecChain(eval, func_dec->right->right);
+
+    --eval->depth;
+    eval->frame_base = caller_base;
+    eval->bindings->size = frame_base;
+
+    // falling off the end gives no value
+    if (flow != EVAL_FLOW_RETURN) {
+        return false;
+    }
+
+    *value = eval->result;
+
+    return true;
+}
+
+static EvalFlow ExecChain(EvalSetup* eval, AST_Node* link) {
+    assert( eval != NULL );
+
+    size_t visible = eval->bindings->size;
+    EvalFlow flow = EVAL_FLOW_NEXT;
+
+    for (; link != NULL && flow == EVAL_FLOW_NEXT; link = AST_ChainNext(link)) {
+        flow = ExecStatement(eval, AST_ChainStatement(link));
+    }
+
+    eval->bindings->size = visible; // block scope ends
+
+    return flow;
+}
+
+static EvalFlow ExecStatement(EvalSetup* eval, AST_Node* statement) {
+    assert( eval      != NULL );
+    assert( statement != NULL );
+
+    if (!Step(eval)) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        return ExecChain(eval, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        return ExecIf(eval, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        return ExecWhile(eval, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_BREAK)) {
+        return EVAL_FLOW_BREAK;
+
+    } else if (AST_IsVarDec(statement)) {
+        return ExecVarDec(eval, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        return ExecAssignment(eval, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        if (statement->right == NULL || !EvalExpression(eval, statement->right, &eval->result)) {
+            return EVAL_FLOW_FAILED;
+        }
+        return EVAL_FLOW_RETURN;
+    }
+
+    // value of the expression statement is dropped
+    int value = 0;
+    return EvalExpression(eval, statement, &value) ? EVAL_FLOW_NEXT : EVAL_FLOW_FAILED;
+}
+
+static EvalFlow ExecIf(EvalSetup* eval, AST_Node* if_node) {
+    assert( eval    != NULL );
+    assert( if_node != NULL );
+
+    int condition = 0;
+    if (!EvalExpression(eval, if_node->left, &condition)) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    if (condition != 0) {
+        return ExecChain(eval, if_node->right);
+    }
+
+    AST_Node* else_part = AST_ChainElse(if_node->right);
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        return ExecIf(eval, else_part);
+    }
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        return ExecChain(eval, else_part->right);
+    }
+
+    return EVAL_FLOW_NEXT;
+}
+
+static EvalFlow ExecWhile(EvalSetup* eval, AST_Node* while_node) {
+    assert( eval       != NULL );
+    assert( while_node != NULL );
+
+    while (true) {
+        int condition = 0;
+        if (!EvalExpression(eval, while_node->left, &condition)) {
+            return EVAL_FLOW_FAILED;
+        }
+
+        if (condition == 0) {
+            return EVAL_FLOW_NEXT;
+        }
+
+        EvalFlow flow = ExecChain(eval, while_node->right);
+
+        if (flow == EVAL_FLOW_BREAK) {
+            return EVAL_FLOW_NEXT;
+        }
+
+        if (flow != EVAL_FLOW_NEXT) {
+            return flow;
+        }
+    }
+}
+
+/* only integer variables are evaluated, doubles leave the call to the run time */
+static EvalFlow ExecVarDec(EvalSetup* eval, const AST_Node* var_dec) {
+    assert( eval    != NULL );
+    assert( var_dec != NULL );
+
+    if (var_dec->data.declaration_type == CONST_TYPE_DOUBLE) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    const AST_Node* initializer = AST_VarDecInitializer(var_dec);
+
+    // initializer sees the variables of the enclosing scope
+    int value = 0;
+    if (initializer != NULL && !EvalExpression(eval, initializer, &value)) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    if (!Bind(eval, AST_VarDecIdentifier(var_dec)->data.variable, value, initializer != NULL)) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    return EVAL_FLOW_NEXT;
+}
+
+/* x = y = expr, all targets get the value of expr */
+static EvalFlow ExecAssignment(EvalSetup* eval, const AST_Node* assignment) {
+    assert( eval       != NULL );
+    assert( assignment != NULL );
+
+    int value = 0;
+    if (!EvalExpression(eval, assignment->right, &value)) {
+        return EVAL_FLOW_FAILED;
+    }
+
+    const AST_Node* target = assignment->left;
+    while (true) {
+        const AST_Node* variable = target->right != NULL ? target->right : target;
+
+        EvalBinding* binding = LookUp(eval, variable->data.variable);
+        if (binding == NULL) {
+            return EVAL_FLOW_FAILED;
+        }
+
+        binding->value   = value;
+        binding->defined = true;
+
+        if (target->right == NULL) {
+            return EVAL_FLOW_NEXT;
+        }
+
+        target = target->left;
+    }
+}
+
+/* operations are computed as the constant folding does, && and || skip the right operand, select takes one value */
+static bool EvalExpression(EvalSetup* eval, const AST_Node* node, int* value) {
+    assert( eval  != NULL );
+    assert( value != NULL );
+
+    if (node == NULL || !Step(eval)) {
+        return false;
+    }
+
+    if (node->type == AST_ELEM_TYPE_CONST) {
+        if (!IsIntConst(node)) {
+            return false;
+        }
+
+        *value = node->data.constant.data.int_const;
+        return true;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        EvalBinding* binding = LookUp(eval, node->data.variable);
+        if (binding == NULL || !binding->defined) {
+            return false;
+        }
+
+        *value = binding->value;
+        return true;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        return EvalCall(eval, node, value);
+    }
+
+    if (node->type != AST_ELEM_TYPE_OPERATION) {
+        return false;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_SELECT)) {
+        int condition = 0;
+        if (!EvalExpression(eval, node->left, &condition)) {
+            return false;
+        }
+
+        return EvalExpression(eval, condition != 0 ? node->right->left : node->right->right, value);
+    }
+
+    int left = 0;
+    if (!EvalExpression(eval, node->left, &left)) {
+        return false;
+    }
+
+    if (    (AST_IsOperation(node, AST_ELEM_OPERATION_LAND) && left == 0)
+        ||  (AST_IsOperation(node, AST_ELEM_OPERATION_LOR)  && left != 0) ) {
+        *value = left != 0;
+        return true;
+    }
+
+    int right = 0;
+    if (!EvalExpression(eval, node->right, &right)) {
+        return false;
+    }
+
+    return EvalOperation(node->data.operation, left, right, value);
+}
+
+// ==================================== STATE ====================================
+
+static bool Step(EvalSetup* eval) {
+    assert( eval != NULL );
+
+    return ++eval->steps <= EVAL_MAX_STEPS;
+}
+
+static bool Bind(EvalSetup* eval, const char* name, int value, bool defined) {
+    assert( eval != NULL );
+
+    EvalBinding binding = {
+        .name    = name,
+        .value   = value,
+        .defined = defined
+    };
+
+    if (BufferPush(eval->bindings, &binding, sizeof(EvalBinding)) != BUFFER_OK) {
+        eval->flag = MIDDLE_END_BUFFER_FAILED;
+        return false;
+    }
+
+    return true;
+}
+
+/* pure function reads only its own variables, so the lookup stops at its frame */
+static EvalBinding* LookUp(EvalSetup* eval, const char* name) {
+    assert( eval != NULL );
+    assert( name != NULL );
+
+    EvalBinding* bindings = (EvalBinding*)eval->bindings->data;
+    for (size_t i = eval->bindings->size; i-- > eval->frame_base; ) {
+        if (bindings[i].name != NULL && strcmp(bindings[i].name, name) == 0) {
+            return &bindings[i];
+        }
+    }
+
+    return NULL;
+}
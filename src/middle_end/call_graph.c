@@ -0,0 +1,430 @@
+#include "../../include/middle_end/call_graph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/ast/ast.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t CALL_GRAPH_UNVISITED = (size_t)-1;
+
+typedef struct SCC_Search {
+    size_t* index;          // order of the visit, CALL_GRAPH_UNVISITED before it
+    size_t* low_link;
+    bool* on_stack;
+    size_t* stack;
+    size_t stack_size;
+    size_t next_index;
+    size_t next_scc;
+} SCC_Search;
+
+typedef struct ChainBounds {
+    bool* done;
+    size_t* depth;          // functions in the deepest chain, which starts with the function
+    size_t* ram_size;       // frames of the largest chain, which starts with the function
+} ChainBounds;
+
+static MiddleEndErr_t CollectFunctions(AST* ast, CallGraph* graph);
+static MiddleEndErr_t CollectEdges(CallGraph* graph);
+static MiddleEndErr_t CollectCallIndices(const CallGraph* graph, const AST_Node* node, Buffer_t* callees);
+static size_t FuncIndex(const CallGraph* graph, const char* name);
+static size_t CountVarDecs(const AST_Node* node);
+
+static MiddleEndErr_t FindComponents(CallGraph* graph);
+static void StrongConnect(CallGraph* graph, SCC_Search* search, size_t func);
+
+static bool ReachesRecursion(const CallGraph* graph, size_t func, bool* visited);
+static void ChainBound(const CallGraph* graph, size_t func, ChainBounds* chains);
+
+/*
+ * Static call graph of the program: an edge for each function called in the body of the other one.
+ * Frame sizes follow the layout of the tree back end, the other back ends may overwrite them.
+ */
+CallGraph* CallGraphInit(AST* ast) {
+    assert( ast != NULL );
+
+    CallGraph* graph = (CallGraph*)calloc(1, sizeof(CallGraph));
+    if (graph == NULL) {
+        return NULL;
+    }
+
+    graph->funcs = BufferInit(0, sizeof(CallGraphFunc));
+    if (graph->funcs == NULL) {
+        FREE(graph);
+        return NULL;
+    }
+
+    MiddleEndErr_t flag = CollectFunctions(ast, graph);
+
+    if (flag == MIDDLE_END_OK) {
+        flag = CollectEdges(graph);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = FindComponents(graph);
+    }
+
+    if (flag != MIDDLE_END_OK) {
+        CallGraphDestroy(&graph);
+        return NULL;
+    }
+
+    return graph;
+}
+
+MiddleEndErr_t CallGraphDestroy(CallGraph** graph) {
+    assert(  graph != NULL );
+    assert( *graph != NULL );
+
+    CallGraphFunc* funcs = (CallGraphFunc*)(*graph)->funcs->data;
+    for (size_t i = 0; i < (*graph)->funcs->size; i++) {
+        if (funcs[i].callees != NULL) {
+            BufferDestroy(&funcs[i].callees);
+        }
+    }
+
+    BufferDestroy(&(*graph)->funcs);
+    FREE(*graph);
+
+    return MIDDLE_END_OK;
+}
+
+CallGraphFunc* CallGraphFind(CallGraph* graph, const char* name) {
+    assert( graph != NULL );
+    assert( name  != NULL );
+
+    size_t idx = FuncIndex(graph, name);
+    if (idx == CALL_GRAPH_UNVISITED) {
+        return NULL;
+    }
+
+    return &((CallGraphFunc*)graph->funcs->data)[idx];
+}
+
+/*
+ * Bounds of the program, which starts with the call of the entry. helpers_depth is the depth
+ * of the runtime routines of the back end, which any function may call.
+ * Recursion, reachable from the entry, leaves the program unbounded.
+ */
+MiddleEndErr_t CallGraphBounds(const CallGraph* graph, const char* entry, size_t helpers_depth, StackBounds* bounds) {
+    assert( graph  != NULL );
+    assert( entry  != NULL );
+    assert( bounds != NULL );
+
+    bounds->bounded    = false;
+    bounds->call_depth = 0;
+    bounds->ram_size   = 0;
+
+    size_t entry_idx = FuncIndex(graph, entry);
+    if (entry_idx == CALL_GRAPH_UNVISITED) {
+        return MIDDLE_END_OK;
+    }
+
+    size_t funcs_cnt = graph->funcs->size;
+
+    bool* visited = (bool*)calloc(funcs_cnt, sizeof(bool));
+    if (visited == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    bool recursive = ReachesRecursion(graph, entry_idx, visited);
+
+    FREE(visited);
+
+    if (recursive) {
+        return MIDDLE_END_OK;
+    }
+
+    ChainBounds chains = {
+        .done     = (bool*)  calloc(funcs_cnt, sizeof(bool)),
+        .depth    = (size_t*)calloc(funcs_cnt, sizeof(size_t)),
+        .ram_size = (size_t*)calloc(funcs_cnt, sizeof(size_t))
+    };
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    if (chains.done == NULL || chains.depth == NULL || chains.ram_size == NULL) {
+        flag = MIDDLE_END_BUFFER_FAILED;
+    } else {
+        ChainBound(graph, entry_idx, &chains);
+
+        bounds->bounded    = true;
+        bounds->call_depth = chains.depth[entry_idx] + helpers_depth;
+        bounds->ram_size   = graph->static_size + chains.ram_size[entry_idx];
+    }
+
+    FREE(chains.done);
+    FREE(chains.depth);
+    FREE(chains.ram_size);
+
+    return flag;
+}
+
+// ================================== BUILDING ==================================
+
+static MiddleEndErr_t CollectFunctions(AST* ast, CallGraph* graph) {
+    assert( ast   != NULL );
+    assert( graph != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsVarDec(statement)) {
+            graph->static_size++;
+            continue;
+        }
+
+        if (!AST_IsFuncDec(statement)) {
+            continue;
+        }
+
+        // cell 0 keeps RBX of the caller
+        size_t frame_size = 1;
+        for (const AST_Node* param = statement->right->left; param != NULL; param = param->left) {
+            frame_size++;
+        }
+
+        CallGraphFunc func = {
+            .name       = statement->right->data.variable,
+            .func_dec   = statement,
+            .callees    = BufferInit(0, sizeof(size_t)),
+            .scc        = 0,
+            .recursive  = false,
+            .frame_size = frame_size + CountVarDecs(statement->right->right)
+        };
+
+        if (func.callees == NULL) {
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+
+        if (BufferPush(graph->funcs, &func, sizeof(CallGraphFunc)) != BUFFER_OK) {
+            BufferDestroy(&func.callees);
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t CollectEdges(CallGraph* graph) {
+    assert( graph != NULL );
+
+    CallGraphFunc* funcs = (CallGraphFunc*)graph->funcs->data;
+
+    for (size_t i = 0; i < graph->funcs->size; i++) {
+        MiddleEndErr_t flag = CollectCallIndices(graph, funcs[i].func_dec->right->right, funcs[i].callees);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* calls of the undeclared functions are left to the back end */
+static MiddleEndErr_t CollectCallIndices(const CallGraph* graph, const AST_Node* node, Buffer_t* callees) {
+    assert( graph   != NULL );
+    assert( callees != NULL );
+
+    if (node == NULL) {
+        return MIDDLE_END_OK;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        size_t callee = FuncIndex(graph, node->right->data.variable);
+
+        bool found = callee == CALL_GRAPH_UNVISITED;
+        for (size_t i = 0; i < callees->size && !found; i++) {
+            found = ((size_t*)callees->data)[i] == callee;
+        }
+
+        if (!found && BufferPush(callees, &callee, sizeof(size_t)) != BUFFER_OK) {
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+    }
+
+    MiddleEndErr_t flag = CollectCallIndices(graph, node->left, callees);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    return CollectCallIndices(graph, node->right, callees);
+}
+
+static size_t FuncIndex(const CallGraph* graph, const char* name) {
+    assert( graph != NULL );
+    assert( name  != NULL );
+
+    const CallGraphFunc* funcs = (const CallGraphFunc*)graph->funcs->data;
+    for (size_t i = 0; i < graph->funcs->size; i++) {
+        if (strcmp(funcs[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    return CALL_GRAPH_UNVISITED;
+}
+
+/* blocks share the frame of the function, so all of their locals are counted */
+static size_t CountVarDecs(const AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    return (size_t)AST_IsVarDec(node) + CountVarDecs(node->left) + CountVarDecs(node->right);
+}
+
+// ============================ STRONGLY CONNECTED ============================
+
+/* Tarjan's search, a component gets its id, when all the components it reaches are done */
+static MiddleEndErr_t FindComponents(CallGraph* graph) {
+    assert( graph != NULL );
+
+    size_t funcs_cnt = graph->funcs->size;
+
+    SCC_Search search = {
+        .index      = (size_t*)calloc(funcs_cnt + 1, sizeof(size_t)),
+        .low_link   = (size_t*)calloc(funcs_cnt + 1, sizeof(size_t)),
+        .on_stack   = (bool*)  calloc(funcs_cnt + 1, sizeof(bool)),
+        .stack      = (size_t*)calloc(funcs_cnt + 1, sizeof(size_t)),
+        .stack_size = 0,
+        .next_index = 0,
+        .next_scc   = 0
+    };
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    if (search.index == NULL || search.low_link == NULL || search.on_stack == NULL || search.stack == NULL) {
+        flag = MIDDLE_END_BUFFER_FAILED;
+    } else {
+        for (size_t i = 0; i < funcs_cnt; i++) {
+            search.index[i] = CALL_GRAPH_UNVISITED;
+        }
+
+        for (size_t i = 0; i < funcs_cnt; i++) {
+            if (search.index[i] == CALL_GRAPH_UNVISITED) {
+                StrongConnect(graph, &search, i);
+            }
+        }
+    }
+
+    FREE(search.index);
+    FREE(search.low_link);
+    FREE(search.on_stack);
+    FREE(search.stack);
+
+    return flag;
+}
+
+static void StrongConnect(CallGraph* graph, SCC_Search* search, size_t func) {
+    assert( graph  != NULL );
+    assert( search != NULL );
+
+    CallGraphFunc* funcs = (CallGraphFunc*)graph->funcs->data;
+
+    search->index[func]    = search->next_index;
+    search->low_link[func] = search->next_index;
+    search->next_index++;
+
+    search->stack[search->stack_size++] = func;
+    search->on_stack[func] = true;
+
+    const size_t* callees = (const size_t*)funcs[func].callees->data;
+    for (size_t i = 0; i < funcs[func].callees->size; i++) {
+        size_t callee = callees[i];
+
+        if (callee == func) {
+            funcs[func].recursive = true;
+        }
+
+        if (search->index[callee] == CALL_GRAPH_UNVISITED) {
+            StrongConnect(graph, search, callee);
+
+            if (search->low_link[callee] < search->low_link[func]) {
+                search->low_link[func] = search->low_link[callee];
+            }
+        } else if (search->on_stack[callee] && search->index[callee] < search->low_link[func]) {
+            search->low_link[func] = search->index[callee];
+        }
+    }
+
+    if (search->low_link[func] != search->index[func]) {
+        return;
+    }
+
+    size_t scc = search->next_scc++;
+    size_t top = search->stack_size;
+    size_t member = 0;
+
+    do {
+        member = search->stack[--search->stack_size];
+        search->on_stack[member] = false;
+        funcs[member].scc = scc;
+    } while (member != func);
+
+    // members of the component with several functions call each other
+    for (size_t i = search->stack_size; top - search->stack_size > 1 && i < top; i++) {
+        funcs[search->stack[i]].recursive = true;
+    }
+}
+
+// ================================== BOUNDS ==================================
+
+static bool ReachesRecursion(const CallGraph* graph, size_t func, bool* visited) {
+    assert( graph   != NULL );
+    assert( visited != NULL );
+
+    if (visited[func]) {
+        return false;
+    }
+
+    visited[func] = true;
+
+    const CallGraphFunc* data = &((const CallGraphFunc*)graph->funcs->data)[func];
+    if (data->recursive) {
+        return true;
+    }
+
+    for (size_t i = 0; i < data->callees->size; i++) {
+        if (ReachesRecursion(graph, ((const size_t*)data->callees->data)[i], visited)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* graph below the function has no cycles, so each function is bounded once */
+static void ChainBound(const CallGraph* graph, size_t func, ChainBounds* chains) {
+    assert( graph  != NULL );
+    assert( chains != NULL );
+
+    if (chains->done[func]) {
+        return;
+    }
+
+    const CallGraphFunc* data = &((const CallGraphFunc*)graph->funcs->data)[func];
+
+    size_t depth = 0;
+    size_t ram_size = 0;
+
+    for (size_t i = 0; i < data->callees->size; i++) {
+        size_t callee = ((const size_t*)data->callees->data)[i];
+
+        ChainBound(graph, callee, chains);
+
+        if (chains->depth[callee] > depth) {
+            depth = chains->depth[callee];
+        }
+        if (chains->ram_size[callee] > ram_size) {
+            ram_size = chains->ram_size[callee];
+        }
+    }
+
+    chains->done[func]     = true;
+    chains->depth[func]    = depth + 1;
+    chains->ram_size[func] = ram_size + data->frame_size;
+}
@@ -0,0 +1,664 @@
+#include "../../include/middle_end/constant_propagation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/utils.h"
+#include "../../include/middle_end/ast_optimization.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef enum CP_Kind {
+    CP_UNKNOWN,     // value is computed at runtime
+    CP_CONST,       // value is the int constant
+    CP_COPY         // value equals to the variable, which was copied
+} CP_Kind;
+
+typedef struct CP_Binding {
+    const char* name;
+    ConstType type;
+    bool global;        // may be changed by any call, it is never propagated
+    CP_Kind kind;
+    int value;          // CP_CONST
+    size_t source;      // CP_COPY, index of the copied binding
+} CP_Binding;
+
+/* values of the visible variables at some point of the program */
+typedef struct CP_State {
+    CP_Binding* bindings;
+    size_t size;
+    bool reachable;
+} CP_State;
+
+typedef struct CP_Setup {
+    Buffer_t* bindings;     // CP_Binding, visible variables, inner ones are at the end
+    bool reachable;         // control may reach the current statement
+    bool rewrite;           // false while the fixed point of a loop is searched
+    bool in_function;
+    CP_State* loop_exit;    // state after the innermost loop, breaks are merged into it
+    size_t propagated_cnt;
+    bool failed;
+} CP_Setup;
+
+typedef struct CP_Value {
+    bool known;
+    int value;
+} CP_Value;
+
+static void PropagateChain(CP_Setup* cp, AST_Node* link);
+static void PropagateStatement(CP_Setup* cp, AST_Node* statement);
+static void PropagateFunction(CP_Setup* cp, AST_Node* func_dec);
+static void PropagateVarDec(CP_Setup* cp, AST_Node* var_dec);
+static void PropagateAssignment(CP_Setup* cp, AST_Node* assignment);
+static void PropagateIf(CP_Setup* cp, AST_Node* if_node);
+static void PropagateElse(CP_Setup* cp, AST_Node* else_part);
+static void PropagateWhile(CP_Setup* cp, AST_Node* while_node);
+static void PropagateBreak(CP_Setup* cp);
+
+static CP_Value Evaluate(CP_Setup* cp, const AST_Node* node);
+static void Substitute(CP_Setup* cp, AST_Node* node);
+static CP_Binding ValueOf(CP_Setup* cp, AST_Node* expression);
+static void Assign(CP_Setup* cp, size_t target, CP_Binding value);
+
+static void Bind(CP_Setup* cp, const char* name, ConstType type, CP_Binding value);
+static size_t LookUp(CP_Setup* cp, const char* name);
+static CP_Binding* Bindings(CP_Setup* cp);
+
+static bool SaveState(CP_Setup* cp, CP_State* state);
+static void RestoreState(CP_Setup* cp, const CP_State* state);
+static bool MeetStates(CP_Binding* dst, bool* dst_reachable, const CP_Binding* src, bool src_reachable, size_t size);
+static void DropOutOfScope(CP_Binding* bindings, size_t size);
+
+static const size_t NO_BINDING = (size_t)-1;
+
+/*
+ * Flow-sensitive propagation of int constants and copies between variables.
+ * Reads of the variables with the known value are replaced with the constant
+ * or with the copied variable. Only the taken branch of if with the known condition
+ * is analyzed, loops are analyzed until the state at the condition stops changing.
+ * The folding and the dead code elimination clean up the rest.
+ */
+MiddleEndErr_t ConstantPropagation(AST* ast, size_t* propagated_cnt) {
+    assert( ast != NULL );
+
+    CP_Setup cp = {
+        .bindings       = BufferInit(0, sizeof(CP_Binding)),
+        .reachable      = true,
+        .rewrite        = true,
+        .in_function    = false,
+        .loop_exit      = NULL,
+        .propagated_cnt = 0,
+        .failed         = false
+    };
+
+    if (cp.bindings == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    PropagateChain(&cp, ast->root);
+
+    BufferDestroy(&cp.bindings);
+
+    if (propagated_cnt != NULL) {
+        *propagated_cnt = cp.propagated_cnt;
+    }
+
+    return cp.failed ? MIDDLE_END_BUFFER_FAILED : MIDDLE_END_OK;
+}
+
+// ================================= STATEMENTS =================================
+
+static void PropagateChain(CP_Setup* cp, AST_Node* link) {
+    assert( cp != NULL );
+
+    size_t visible = cp->bindings->size;
+
+    for (; link != NULL && cp->reachable; link = AST_ChainNext(link)) {
+        PropagateStatement(cp, AST_ChainStatement(link));
+    }
+
+    cp->bindings->size = visible; // block scope ends
+    DropOutOfScope(Bindings(cp), visible);
+}
+
+static void PropagateStatement(CP_Setup* cp, AST_Node* statement) {
+    assert( cp        != NULL );
+    assert( statement != NULL );
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        PropagateChain(cp, statement);
+
+    } else if (AST_IsFuncDec(statement)) {
+        PropagateFunction(cp, statement);
+
+    } else if (AST_IsVarDec(statement)) {
+        PropagateVarDec(cp, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        PropagateIf(cp, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        PropagateWhile(cp, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        PropagateAssignment(cp, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_BREAK)) {
+        PropagateBreak(cp);
+
+    } else if (   AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)
+               || AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        Substitute(cp, statement->right);
+
+        if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+            cp->reachable = false;
+        }
+
+    } else {
+        Substitute(cp, statement); // expression statement
+    }
+}
+
+/* function may be called with any arguments, the state of the caller does not flow into it */
+static void PropagateFunction(CP_Setup* cp, AST_Node* func_dec) {
+    assert( cp       != NULL );
+    assert( func_dec != NULL );
+
+    AST_Node* identifier = func_dec->right;
+    size_t visible = cp->bindings->size;
+
+    CP_Binding unknown = {};
+    unknown.kind = CP_UNKNOWN;
+
+    for (AST_Node* param = identifier->left; param != NULL; param = param->left) {
+        Bind(cp, param->right->data.variable, param->data.declaration_type, unknown);
+    }
+
+    CP_State* outer_exit = cp->loop_exit;
+    bool outer_function  = cp->in_function;
+
+    cp->loop_exit   = NULL;
+    cp->in_function = true;
+
+    PropagateChain(cp, identifier->right);
+
+    cp->loop_exit   = outer_exit;
+    cp->in_function = outer_function;
+    cp->reachable   = true;
+    cp->bindings->size = visible;
+}
+
+static void PropagateVarDec(CP_Setup* cp, AST_Node* var_dec) {
+    assert( cp      != NULL );
+    assert( var_dec != NULL );
+
+    AST_Node* initializer = AST_VarDecInitializer(var_dec);
+
+    CP_Binding value = {};
+    value.kind = CP_UNKNOWN;
+
+    // initializer sees the variables of the enclosing scope
+    if (initializer != NULL) {
+        Substitute(cp, initializer);
+        value = ValueOf(cp, initializer);
+    }
+
+    Bind(cp, AST_VarDecIdentifier(var_dec)->data.variable, var_dec->data.declaration_type, value);
+    if (cp->failed) {
+        return;
+    }
+
+    size_t target = cp->bindings->size - 1;
+    Assign(cp, target, value); // the binding type is known only now
+}
+
+/* x = y = expr; is stored as =(=(x, y), expr) */
+static void PropagateAssignment(CP_Setup* cp, AST_Node* assignment) {
+    assert( cp         != NULL );
+    assert( assignment != NULL );
+
+    Substitute(cp, assignment->right);
+
+    // only declarations are copies: the store to an existing variable would stay, but become dead
+    CP_Binding value = ValueOf(cp, assignment->right);
+    if (value.kind == CP_COPY) {
+        value.kind = CP_UNKNOWN;
+    }
+
+    AST_Node* target = assignment->left;
+    while (target != NULL) {
+        AST_Node* variable = AST_IsOperation(target, AST_ELEM_OPERATION_ASSIGNMENT) ? target->right : target;
+
+        size_t index = LookUp(cp, variable->data.variable);
+        if (index != NO_BINDING) {
+            Assign(cp, index, value);
+        }
+
+        target = AST_IsOperation(target, AST_ELEM_OPERATION_ASSIGNMENT) ? target->left : NULL;
+    }
+}
+
+static void PropagateIf(CP_Setup* cp, AST_Node* if_node) {
+    assert( cp      != NULL );
+    assert( if_node != NULL );
+
+    Substitute(cp, if_node->left);
+
+    AST_Node* else_part = AST_ChainElse(if_node->right);
+    CP_Value condition  = Evaluate(cp, if_node->left);
+
+    if (condition.known) {
+        if (condition.value != 0) {
+            PropagateChain(cp, if_node->right);
+        } else {
+            PropagateElse(cp, else_part);
+        }
+        return;
+    }
+
+    CP_State before = {};
+    if (!SaveState(cp, &before)) {
+        return;
+    }
+
+    PropagateChain(cp, if_node->right);
+
+    CP_State then_state = {};
+    if (SaveState(cp, &then_state)) {
+        RestoreState(cp, &before);
+        PropagateElse(cp, else_part);
+
+        MeetStates(Bindings(cp), &cp->reachable, then_state.bindings, then_state.reachable, then_state.size);
+        FREE(then_state.bindings);
+    }
+
+    FREE(before.bindings);
+}
+
+static void PropagateElse(CP_Setup* cp, AST_Node* else_part) {
+    assert( cp != NULL );
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        PropagateIf(cp, else_part);
+
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        PropagateChain(cp, else_part->right);
+    }
+}
+
+/*
+ * The state at the condition is the meet of the state before the loop and
+ * the states at the end of the body. It is found without rewriting,
+ * then the body is rewritten once with the fixed point.
+ */
+static void PropagateWhile(CP_Setup* cp, AST_Node* while_node) {
+    assert( cp         != NULL );
+    assert( while_node != NULL );
+
+    CP_Value condition = Evaluate(cp, while_node->left);
+    if (condition.known && condition.value == 0) {
+        Substitute(cp, while_node->left); // the body is never executed
+        return;
+    }
+
+    CP_State head = {}, exit = {};
+    if (!SaveState(cp, &head)) {
+        return;
+    }
+    if (!SaveState(cp, &exit)) {
+        FREE(head.bindings);
+        return;
+    }
+
+    CP_State* outer_exit = cp->loop_exit;
+    bool rewrite = cp->rewrite;
+
+    cp->loop_exit = &exit;
+    cp->rewrite   = false;
+
+    bool changed = true;
+    while (changed && !cp->failed) {
+        PropagateChain(cp, while_node->right);
+
+        changed = MeetStates(head.bindings, &head.reachable, Bindings(cp), cp->reachable, head.size);
+        RestoreState(cp, &head);
+    }
+
+    cp->rewrite = rewrite;
+    exit.reachable = false;
+
+    Substitute(cp, while_node->left);
+    PropagateChain(cp, while_node->right);
+
+    RestoreState(cp, &head);
+
+    condition = Evaluate(cp, while_node->left);
+    if (condition.known && condition.value != 0) {
+        cp->reachable = false; // the loop is left only by break
+    }
+
+    MeetStates(Bindings(cp), &cp->reachable, exit.bindings, exit.reachable, exit.size);
+
+    cp->loop_exit = outer_exit;
+
+    FREE(head.bindings);
+    FREE(exit.bindings);
+}
+
+static void PropagateBreak(CP_Setup* cp) {
+    assert( cp != NULL );
+
+    if (cp->loop_exit != NULL) {
+        CP_State* exit = cp->loop_exit;
+        MeetStates(exit->bindings, &exit->reachable, Bindings(cp), cp->reachable, exit->size);
+    }
+
+    cp->reachable = false;
+}
+
+// ================================ EXPRESSIONS ================================
+
+static CP_Value Evaluate(CP_Setup* cp, const AST_Node* node) {
+    assert( cp != NULL );
+
+    CP_Value unknown = {
+        .known = false,
+        .value = 0
+    };
+
+    if (node == NULL) {
+        return unknown;
+    }
+
+    if (node->type == AST_ELEM_TYPE_CONST) {
+        if (node->data.constant.type != CONST_TYPE_INT) {
+            return unknown;
+        }
+
+        CP_Value value = {
+            .known = true,
+            .value = node->data.constant.data.int_const
+        };
+        return value;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        size_t index = LookUp(cp, node->data.variable);
+        if (index == NO_BINDING || Bindings(cp)[index].kind != CP_CONST) {
+            return unknown;
+        }
+
+        CP_Value value = {
+            .known = true,
+            .value = Bindings(cp)[index].value
+        };
+        return value;
+    }
+
+    if (node->type != AST_ELEM_TYPE_OPERATION || node->left == NULL || node->right == NULL) {
+        return unknown;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_SELECT)) {
+        CP_Value condition = Evaluate(cp, node->left);
+        if (!condition.known) {
+            return unknown;
+        }
+
+        return Evaluate(cp, condition.value != 0 ? node->right->left : node->right->right);
+    }
+
+    CP_Value left  = Evaluate(cp, node->left);
+    CP_Value right = Evaluate(cp, node->right);
+
+    CP_Value result = {
+        .known = false,
+        .value = 0
+    };
+
+    if (left.known && right.known) {
+        result.known = EvalOperation(node->data.operation, left.value, right.value, &result.value);
+    }
+
+    return result;
+}
+
+/* replaces reads of the variables with their known values */
+static void Substitute(CP_Setup* cp, AST_Node* node) {
+    assert( cp != NULL );
+
+    if (node == NULL || !cp->rewrite || cp->failed) {
+        return;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        for (AST_Node* argument = node->left; argument != NULL; argument = argument->left) {
+            Substitute(cp, argument->right);
+        }
+        return;
+    }
+
+    if (node->type != AST_ELEM_TYPE_VARIABLE) {
+        Substitute(cp, node->left);
+        Substitute(cp, node->right);
+        return;
+    }
+
+    size_t index = LookUp(cp, node->data.variable);
+    if (index == NO_BINDING) {
+        return;
+    }
+
+    const CP_Binding* binding = &Bindings(cp)[index];
+
+    if (binding->kind == CP_CONST) {
+        FREE(node->data.variable);
+
+        node->type = AST_ELEM_TYPE_CONST;
+        node->data.constant.type = CONST_TYPE_INT;
+        node->data.constant.data.int_const = binding->value;
+
+        ++cp->propagated_cnt;
+
+    } else if (binding->kind == CP_COPY) {
+        const char* source = Bindings(cp)[binding->source].name;
+
+        // copied variable may be shadowed here
+        if (LookUp(cp, source) != binding->source) {
+            return;
+        }
+
+        char* name = strdup(source);
+        if (name == NULL) {
+            cp->failed = true;
+            return;
+        }
+
+        FREE(node->data.variable);
+        node->data.variable = name;
+
+        ++cp->propagated_cnt;
+    }
+}
+
+static CP_Binding ValueOf(CP_Setup* cp, AST_Node* expression) {
+    assert( cp         != NULL );
+    assert( expression != NULL );
+
+    CP_Binding value = {};
+    value.kind = CP_UNKNOWN;
+
+    CP_Value constant = Evaluate(cp, expression);
+    if (constant.known) {
+        value.kind  = CP_CONST;
+        value.value = constant.value;
+        return value;
+    }
+
+    if (expression->type != AST_ELEM_TYPE_VARIABLE) {
+        return value;
+    }
+
+    size_t source = LookUp(cp, expression->data.variable);
+    if (source == NO_BINDING || Bindings(cp)[source].global) {
+        return value;
+    }
+
+    if (Bindings(cp)[source].kind == CP_COPY) {
+        source = Bindings(cp)[source].source;
+    }
+
+    value.kind   = CP_COPY;
+    value.source = source;
+
+    return value;
+}
+
+/* only int variables are propagated, other types may truncate or widen the value */
+static void Assign(CP_Setup* cp, size_t target, CP_Binding value) {
+    assert( cp != NULL );
+    assert( target < cp->bindings->size );
+
+    CP_Binding* bindings = Bindings(cp);
+
+    for (size_t i = 0; i < cp->bindings->size; i++) {
+        if (bindings[i].kind == CP_COPY && bindings[i].source == target) {
+            bindings[i].kind = CP_UNKNOWN;
+        }
+    }
+
+    bindings[target].kind = CP_UNKNOWN;
+
+    if (bindings[target].global || bindings[target].type != CONST_TYPE_INT) {
+        return;
+    }
+
+    if (value.kind == CP_COPY && bindings[value.source].type != CONST_TYPE_INT) {
+        return;
+    }
+
+    bindings[target].kind   = value.kind;
+    bindings[target].value  = value.value;
+    bindings[target].source = value.source;
+}
+
+// =================================== HELPERS ===================================
+
+static void Bind(CP_Setup* cp, const char* name, ConstType type, CP_Binding value) {
+    assert( cp   != NULL );
+    assert( name != NULL );
+
+    value.name   = name;
+    value.type   = type;
+    value.global = !cp->in_function;
+
+    if (value.global) {
+        value.kind = CP_UNKNOWN;
+    }
+
+    if (BufferPush(cp->bindings, &value, sizeof(CP_Binding)) != BUFFER_OK) {
+        cp->failed = true; // outer variable with the same name must not be seen instead
+    }
+}
+
+static size_t LookUp(CP_Setup* cp, const char* name) {
+    assert( cp   != NULL );
+    assert( name != NULL );
+
+    const CP_Binding* bindings = Bindings(cp);
+    for (size_t i = cp->bindings->size; i-- > 0; ) {
+        if (strcmp(bindings[i].name, name) == 0) {
+            return i;
+        }
+    }
+
+    return NO_BINDING;
+}
+
+static CP_Binding* Bindings(CP_Setup* cp) {
+    assert( cp != NULL );
+
+    return (CP_Binding*)cp->bindings->data;
+}
+
+static bool SaveState(CP_Setup* cp, CP_State* state) {
+    assert( cp    != NULL );
+    assert( state != NULL );
+
+    state->size      = cp->bindings->size;
+    state->reachable = cp->reachable;
+    state->bindings  = (CP_Binding*)calloc(state->size + 1, sizeof(CP_Binding));
+
+    if (state->bindings == NULL) {
+        cp->failed = true;
+        return false;
+    }
+
+    if (state->size != 0) {
+        memcpy(state->bindings, Bindings(cp), state->size * sizeof(CP_Binding));
+    }
+
+    return true;
+}
+
+/* inner bindings are already out of scope, when the state is restored */
+static void RestoreState(CP_Setup* cp, const CP_State* state) {
+    assert( cp    != NULL );
+    assert( state != NULL );
+    assert( cp->bindings->size == state->size );
+
+    if (state->size != 0) {
+        memcpy(Bindings(cp), state->bindings, state->size * sizeof(CP_Binding));
+    }
+
+    cp->reachable = state->reachable;
+}
+
+/* dst becomes the meet of both states, returns true if dst has changed */
+static bool MeetStates(CP_Binding* dst, bool* dst_reachable, const CP_Binding* src, bool src_reachable, size_t size) {
+    assert( dst_reachable != NULL );
+
+    if (!src_reachable) {
+        return false;
+    }
+
+    if (!*dst_reachable) {
+        if (size != 0) {
+            memcpy(dst, src, size * sizeof(CP_Binding));
+        }
+        DropOutOfScope(dst, size);
+        *dst_reachable = true;
+        return true;
+    }
+
+    bool changed = false;
+
+    for (size_t i = 0; i < size; i++) {
+        if (dst[i].kind == CP_UNKNOWN) {
+            continue;
+        }
+
+        // copies in dst refer only to the bindings below size
+        bool same =    dst[i].kind == src[i].kind
+                    && (dst[i].kind != CP_CONST || dst[i].value  == src[i].value)
+                    && (dst[i].kind != CP_COPY  || dst[i].source == src[i].source);
+
+        if (!same) {
+            dst[i].kind = CP_UNKNOWN;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+/* copies of the variables, which went out of scope, are forgotten, their slots are reused */
+static void DropOutOfScope(CP_Binding* bindings, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (bindings[i].kind == CP_COPY && bindings[i].source >= size) {
+            bindings[i].kind = CP_UNKNOWN;
+        }
+    }
+}
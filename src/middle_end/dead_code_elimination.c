@@ -0,0 +1,613 @@
+#include "../../include/middle_end/dead_code_elimination.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct DCE_Setup {
+    AST* ast;
+    size_t removed_cnt;
+} DCE_Setup;
+
+typedef struct VarUses {
+    const char* name;
+    size_t reads;
+    bool complex_write;     // write that can not be removed with the declaration
+    Buffer_t* writes;       // links of "name = pure_expr;" statements
+} VarUses;
+
+static MiddleEndErr_t RemoveUnusedFunctions(DCE_Setup* dce);
+
+static void SimplifyChain(DCE_Setup* dce, AST_Node* link);
+static AST_Node* SimplifyStatement(DCE_Setup* dce, AST_Node* link);
+static AST_Node* SimplifyIf(DCE_Setup* dce, AST_Node* link);
+static AST_Node* SimplifyVarDec(DCE_Setup* dce, AST_Node* link);
+static void SimplifyElse(DCE_Setup* dce, AST_Node* else_part);
+
+static bool AlwaysReturns(AST_Node* statement);
+static bool ContainsBreak(const AST_Node* node);
+static bool CanDrop(const AST_Node* node);
+
+static bool CanRemoveLink(const AST_Node* link);
+static AST_Node* RemoveLink(DCE_Setup* dce, AST_Node* link);
+static AST_Node* ReplaceLinkStatement(DCE_Setup* dce, AST_Node* link, AST_Node* chain);
+static void CutAfterLink(DCE_Setup* dce, AST_Node* link);
+static AST_Node** LinkSlot(DCE_Setup* dce, AST_Node* link);
+static AST_Node* ChainHead(AST_Node* link);
+static size_t ChainLength(AST_Node* chain);
+
+static void ScanChain(AST_Node* link, VarUses* uses);
+static void ScanStatement(AST_Node* statement, AST_Node* link, VarUses* uses);
+static void ScanElse(AST_Node* else_part, VarUses* uses);
+static void ScanAssignment(AST_Node* assignment, AST_Node* link, VarUses* uses);
+static void ScanExpression(AST_Node* node, VarUses* uses);
+
+MiddleEndErr_t DeadCodeElimination(AST* ast, size_t* removed_cnt) {
+    assert( ast != NULL );
+
+    DCE_Setup dce = {
+        .ast = ast,
+        .removed_cnt = 0
+    };
+
+    if (ast->root != NULL) {
+        MiddleEndErr_t flag = RemoveUnusedFunctions(&dce);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+
+        SimplifyChain(&dce, ast->root);
+    }
+
+    if (removed_cnt != NULL) {
+        *removed_cnt = dce.removed_cnt;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ============================== UNUSED FUNCTIONS ==============================
+
+static MiddleEndErr_t RemoveUnusedFunctions(DCE_Setup* dce) {
+    assert( dce != NULL );
+
+    AST_Node* main_func = FindFuncDec(dce->ast, "main");
+    if (main_func == NULL) {
+        return MIDDLE_END_OK;
+    }
+
+    Buffer_t* reachable = BufferInit(0, sizeof(AST_Node*));
+    if (reachable == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    if (BufferPush(reachable, &main_func, sizeof(AST_Node*)) != BUFFER_OK) {
+        BufferDestroy(&reachable);
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    // functions, which the global initializers call, are kept with main
+    for (AST_Node* link = dce->ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        MiddleEndErr_t flag = AST_IsFuncDec(statement) ? MIDDLE_END_OK
+                                                       : CollectCallees(dce->ast, statement, reachable);
+        if (flag != MIDDLE_END_OK) {
+            BufferDestroy(&reachable);
+            return flag;
+        }
+    }
+
+    for (size_t i = 0; i < reachable->size; i++) {
+        AST_Node* func_dec = ((AST_Node**)reachable->data)[i];
+
+        MiddleEndErr_t flag = CollectCallees(dce->ast, func_dec->right->right, reachable);
+        if (flag != MIDDLE_END_OK) {
+            BufferDestroy(&reachable);
+            return flag;
+        }
+    }
+
+    AST_Node* link = dce->ast->root;
+    while (link != NULL) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement) && !ContainsNode(reachable, statement) && CanRemoveLink(link)) {
+            link = RemoveLink(dce, link);
+        } else {
+            link = AST_ChainNext(link);
+        }
+    }
+
+    BufferDestroy(&reachable);
+
+    return MIDDLE_END_OK;
+}
+
+// ================================= STATEMENTS =================================
+
+static void SimplifyChain(DCE_Setup* dce, AST_Node* link) {
+    assert( dce != NULL );
+
+    while (link != NULL && AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)) {
+        link = SimplifyStatement(dce, link);
+    }
+}
+
+/* returns the link to continue with */
+static AST_Node* SimplifyStatement(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+
+    AST_Node* statement = link->left;
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        if (statement->left->type == AST_ELEM_TYPE_CONST) {
+            AST_Node* next = SimplifyIf(dce, link);
+            if (next != link || link->left != statement) {
+                return next;
+            }
+        }
+
+        SimplifyChain(dce, statement->right);
+        SimplifyElse(dce, AST_ChainElse(statement->right));
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        if (    statement->left->type == AST_ELEM_TYPE_CONST
+             && statement->left->data.constant.data.int_const == 0 && CanRemoveLink(link)) {
+            return RemoveLink(dce, link);
+        }
+
+        SimplifyChain(dce, statement->right);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        SimplifyChain(dce, statement);
+
+        if (AST_IsOperation(link->left, AST_ELEM_OPERATION_RETURN)) {
+            return ReplaceLinkStatement(dce, link, link->left); // only the return is left in the block
+        }
+
+    } else if (AST_IsFuncDec(statement)) {
+        SimplifyChain(dce, statement->right->right);
+
+    } else if (AST_IsVarDec(statement)) {
+        AST_Node* next = SimplifyVarDec(dce, link);
+        if (next != link) {
+            return next;
+        }
+
+    } else if (    !AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)
+                && !AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)
+                && !AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)
+                && CanDrop(statement) && CanRemoveLink(link)) {
+        return RemoveLink(dce, link); // expression statement without effect
+    }
+
+    if (AlwaysReturns(link->left) && AST_ChainNext(link) != NULL) {
+        CutAfterLink(dce, link);
+    }
+
+    return AST_ChainNext(link);
+}
+
+static AST_Node* SimplifyIf(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+
+    AST_Node* if_node    = link->left;
+    AST_Node* then_chain = if_node->right;
+    AST_Node* else_part  = AST_ChainElse(then_chain);
+
+    AST_Node* taken = NULL;
+    if (if_node->left->data.constant.data.int_const != 0) {
+        taken = then_chain;
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        taken = else_part->right;
+    } else if (else_part != NULL) {
+        taken = else_part; // "else if" becomes the statement itself
+    }
+
+    if (taken == NULL) {
+        return CanRemoveLink(link) ? RemoveLink(dce, link) : link;
+    }
+
+    if (AST_IsOperation(taken, AST_ELEM_OPERATION_RETURN) && AST_ChainElse(link) != NULL) {
+        return link;
+    }
+
+    if (else_part != NULL) {
+        AST_Node** else_slot = GetParentNodePointer(else_part);
+        *else_slot = NULL;
+        else_part->parent = NULL;
+    }
+
+    if (taken == then_chain) {
+        if_node->right = NULL;
+    } else if (taken != else_part) {
+        else_part->right = NULL;
+    }
+    taken->parent = NULL;
+
+    AST_Node* next = ReplaceLinkStatement(dce, link, taken);
+
+    AST_SubtreeDestroy(if_node);
+    if (else_part != NULL && taken != else_part) {
+        AST_SubtreeDestroy(else_part);
+    }
+
+    return next;
+}
+
+static AST_Node* SimplifyVarDec(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+
+    AST_Node* initializer = AST_VarDecInitializer(link->left);
+    if (!CanDrop(initializer) || !CanRemoveLink(link)) {
+        return link;
+    }
+
+    VarUses uses = {
+        .name = AST_VarDecIdentifier(link->left)->data.variable,
+        .reads = 0,
+        .complex_write = false,
+        .writes = BufferInit(0, sizeof(AST_Node*))
+    };
+    if (uses.writes == NULL) {
+        return link;
+    }
+
+    if (AST_ChainNext(link) != NULL) {
+        ScanChain(AST_ChainNext(link), &uses);
+    }
+
+    AST_Node** writes = (AST_Node**)uses.writes->data;
+    bool removable = uses.reads == 0 && !uses.complex_write;
+
+    for (size_t i = 0; removable && i < uses.writes->size; i++) {
+        AST_Node* head = ChainHead(writes[i]);
+        size_t removed_in_chain = 0;
+
+        if (ChainHead(link) == head) {
+            ++removed_in_chain;
+        }
+        for (size_t j = 0; j < uses.writes->size; j++) {
+            if (ChainHead(writes[j]) == head) {
+                ++removed_in_chain;
+            }
+        }
+
+        removable = removed_in_chain < ChainLength(head);
+    }
+
+    if (!removable) {
+        BufferDestroy(&uses.writes);
+        return link;
+    }
+
+    for (size_t i = 0; i < uses.writes->size; i++) {
+        RemoveLink(dce, writes[i]);
+    }
+
+    BufferDestroy(&uses.writes);
+
+    return RemoveLink(dce, link);
+}
+
+static void SimplifyElse(DCE_Setup* dce, AST_Node* else_part) {
+    assert( dce != NULL );
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        SimplifyChain(dce, else_part->right);
+        SimplifyElse(dce, AST_ChainElse(else_part->right));
+
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        SimplifyChain(dce, else_part->right);
+    }
+}
+
+/* statement never passes control to the next one */
+static bool AlwaysReturns(AST_Node* statement) {
+    if (statement == NULL) {
+        return false;
+    }
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        return true;
+    }
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        for (AST_Node* link = statement; link != NULL; link = AST_ChainNext(link)) {
+            if (AlwaysReturns(AST_ChainStatement(link))) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        return     statement->left->type == AST_ELEM_TYPE_CONST
+                && statement->left->data.constant.data.int_const != 0
+                && !ContainsBreak(statement->right);
+    }
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        AST_Node* else_part = AST_ChainElse(statement->right);
+        if (else_part == NULL || !AlwaysReturns(statement->right)) {
+            return false;
+        }
+
+        return AlwaysReturns(AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE) ? else_part->right
+                                                                                  : else_part);
+    }
+
+    return false;
+}
+
+static bool ContainsBreak(const AST_Node* node) {
+    if (node == NULL) {
+        return false;
+    }
+
+    return     AST_IsOperation(node, AST_ELEM_OPERATION_BREAK)
+            || ContainsBreak(node->left) || ContainsBreak(node->right);
+}
+
+/* division may stop the program, so the expression with it is kept, as if it had side effects */
+static bool CanDrop(const AST_Node* node) {
+    return !HasSideEffects(node) && !ContainsDivision(node);
+}
+
+// ================================ CHAIN EDITING ================================
+
+/* block must keep at least one statement */
+static bool CanRemoveLink(const AST_Node* link) {
+    assert( link != NULL );
+
+    if (!AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)) {
+        return false;
+    }
+
+    bool is_head = !(    AST_IsOperation(link->parent, AST_ELEM_OPERATION_SENTINEL)
+                      && link->parent->right == link );
+
+    return !is_head || AST_ChainNext(link) != NULL;
+}
+
+/* returns the link, which took place of the removed one */
+static AST_Node* RemoveLink(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+    assert( CanRemoveLink(link) );
+
+    AST_Node** slot = LinkSlot(dce, link);
+    AST_Node*  next = link->right;
+
+    *slot = next;
+    if (next != NULL) {
+        next->parent = link->parent;
+    }
+
+    link->right  = NULL;
+    link->parent = NULL;
+    AST_SubtreeDestroy(link);
+
+    ++dce->removed_cnt;
+
+    if (AST_IsOperation(next, AST_ELEM_OPERATION_SENTINEL) || AST_IsOperation(next, AST_ELEM_OPERATION_RETURN)) {
+        return next;
+    }
+
+    return NULL;
+}
+
+/* replaces the statement of the link with a block, the old statement is left to the caller */
+static AST_Node* ReplaceLinkStatement(DCE_Setup* dce, AST_Node* link, AST_Node* chain) {
+    assert( dce   != NULL );
+    assert( link  != NULL );
+    assert( chain != NULL );
+
+    ++dce->removed_cnt;
+
+    if (!AST_IsOperation(chain, AST_ELEM_OPERATION_RETURN)) {
+        link->left->parent = NULL;
+        link->left = chain;
+        chain->parent = link;
+
+        return link;
+    }
+
+    // block of a single return terminates the enclosing block
+    AST_Node** slot = LinkSlot(dce, link);
+
+    *slot = chain;
+    chain->parent = link->parent;
+
+    if (link->left != chain) {
+        link->left->parent = NULL;
+    }
+    link->left = NULL;
+    link->parent = NULL;
+    AST_SubtreeDestroy(link);
+
+    return NULL;
+}
+
+static void CutAfterLink(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+
+    AST_Node* else_part = AST_ChainElse(link);
+    if (else_part != NULL) {
+        *GetParentNodePointer(else_part) = NULL;
+    }
+
+    AST_Node* rest = link->right;
+    link->right = else_part;
+
+    if (else_part != NULL) {
+        else_part->parent = link;
+    }
+
+    if (rest != NULL && rest != else_part) {
+        rest->parent = NULL;
+        dce->removed_cnt += ChainLength(rest);
+        AST_SubtreeDestroy(rest);
+    }
+}
+
+static AST_Node** LinkSlot(DCE_Setup* dce, AST_Node* link) {
+    assert( dce  != NULL );
+    assert( link != NULL );
+
+    if (link->parent == NULL) {
+        return &dce->ast->root;
+    }
+
+    return GetParentNodePointer(link);
+}
+
+static AST_Node* ChainHead(AST_Node* link) {
+    assert( link != NULL );
+
+    while (AST_IsOperation(link->parent, AST_ELEM_OPERATION_SENTINEL) && link->parent->right == link) {
+        link = link->parent;
+    }
+
+    return link;
+}
+
+static size_t ChainLength(AST_Node* chain) {
+    size_t length = 0;
+
+    for (AST_Node* link = chain; link != NULL; link = AST_ChainNext(link)) {
+        ++length;
+    }
+
+    return length;
+}
+
+// ================================ VARIABLE USES ================================
+
+static void ScanChain(AST_Node* link, VarUses* uses) {
+    assert( uses != NULL );
+
+    for (; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsVarDec(statement) && strcmp(AST_VarDecIdentifier(statement)->data.variable, uses->name) == 0) {
+            ScanExpression(AST_VarDecInitializer(statement), uses);
+            return; // shadowed till the end of the block
+        }
+
+        ScanStatement(statement, link, uses);
+    }
+}
+
+static void ScanStatement(AST_Node* statement, AST_Node* link, VarUses* uses) {
+    assert( statement != NULL );
+    assert( uses      != NULL );
+
+    if (AST_IsVarDec(statement)) {
+        ScanExpression(AST_VarDecInitializer(statement), uses);
+
+    } else if (AST_IsFuncDec(statement)) {
+        for (AST_Node* param = statement->right->left; param != NULL; param = param->left) {
+            if (strcmp(param->right->data.variable, uses->name) == 0) {
+                return;
+            }
+        }
+
+        ScanChain(statement->right->right, uses);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        ScanAssignment(statement, link, uses);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        ScanExpression(statement->left, uses);
+        ScanChain(statement->right, uses);
+        ScanElse(AST_ChainElse(statement->right), uses);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        ScanExpression(statement->left, uses);
+        ScanChain(statement->right, uses);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        ScanChain(statement, uses);
+
+    } else {
+        ScanExpression(statement, uses);
+    }
+}
+
+static void ScanElse(AST_Node* else_part, VarUses* uses) {
+    assert( uses != NULL );
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        ScanStatement(else_part, NULL, uses);
+
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        ScanChain(else_part->right, uses);
+    }
+}
+
+/* x = y = expr; is stored as =(=(x, y), expr) */
+static void ScanAssignment(AST_Node* assignment, AST_Node* link, VarUses* uses) {
+    assert( assignment != NULL );
+    assert( uses       != NULL );
+
+    size_t targets_cnt = 0, matched_cnt = 0;
+
+    AST_Node* target = assignment->left;
+    while (target != NULL) {
+        AST_Node* variable = AST_IsOperation(target, AST_ELEM_OPERATION_ASSIGNMENT) ? target->right : target;
+
+        ++targets_cnt;
+        if (strcmp(variable->data.variable, uses->name) == 0) {
+            ++matched_cnt;
+        }
+
+        target = AST_IsOperation(target, AST_ELEM_OPERATION_ASSIGNMENT) ? target->left : NULL;
+    }
+
+    if (matched_cnt != 0) {
+        if (    targets_cnt == 1 && link != NULL && AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)
+             && CanDrop(assignment->right) ) {
+            BufferPush(uses->writes, &link, sizeof(AST_Node*));
+        } else {
+            uses->complex_write = true;
+        }
+    }
+
+    ScanExpression(assignment->right, uses);
+}
+
+static void ScanExpression(AST_Node* node, VarUses* uses) {
+    assert( uses != NULL );
+
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        if (strcmp(node->data.variable, uses->name) == 0) {
+            ++uses->reads;
+        }
+        return;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        for (AST_Node* argument = node->left; argument != NULL; argument = argument->left) {
+            ScanExpression(argument->right, uses);
+        }
+        return;
+    }
+
+    ScanExpression(node->left, uses);
+    ScanExpression(node->right, uses);
+}
@@ -0,0 +1,194 @@
+#include "../../include/middle_end/if_conversion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+
+const size_t IF_CONVERSION_VALUE_BUDGET = 5;    // nodes of a value, which is computed on both ways
+
+typedef struct IfConverter {
+    AST* ast;
+    size_t converted_cnt;
+} IfConverter;
+
+static void ConvertNode(IfConverter* conv, AST_Node* node);
+static bool ConvertAssignment(AST_Node* link);
+
+static const char* AssignedName(AST_Node* if_node);
+static AST_Node* BlockAssignment(AST_Node* chain);
+static AST_Node* SelectOf(AST_Node* if_node, const char* name);
+static AST_Node* MakeSelect(AST_Node* condition, AST_Node* then_value, AST_Node* else_value);
+
+static bool IsCheapValue(const AST_Node* node);
+
+/*
+ * Branch, which only chooses the value of one variable, becomes the select: the back end computes
+ * both values and keeps one of them without the jumps and the block scopes.
+ * Values are small and can not stop the program, the condition has no side effects,
+ * so the order of the computations does not matter.
+ *
+ *     if (a < b) { m = a; } else { m = b; }    =>    m = select(a < b, a, b);
+ *
+ * Each instruction of the processor is one step, so the branch without else stays:
+ * the select would compute the kept value, which the branch does not touch.
+ */
+MiddleEndErr_t IfConversion(AST* ast, size_t* converted_cnt) {
+    assert( ast != NULL );
+
+    IfConverter conv = {
+        .ast = ast,
+        .converted_cnt = 0
+    };
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement)) {
+            ConvertNode(&conv, statement->right->right);
+        }
+    }
+
+    if (converted_cnt != NULL) {
+        *converted_cnt = conv.converted_cnt;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ================================= STATEMENTS =================================
+
+/* inner branches go first, so the outer one may choose between their selects */
+static void ConvertNode(IfConverter* conv, AST_Node* node) {
+    assert( conv != NULL );
+
+    if (node == NULL) {
+        return;
+    }
+
+    ConvertNode(conv, node->left);
+    ConvertNode(conv, node->right);
+
+    if (!AST_IsOperation(node, AST_ELEM_OPERATION_SENTINEL) || !AST_IsOperation(node->left, AST_ELEM_OPERATION_IF)) {
+        return;
+    }
+
+    if (ConvertAssignment(node)) {
+        ++conv->converted_cnt;
+    }
+}
+
+/* if, its else ifs and else assign the same variable */
+static bool ConvertAssignment(AST_Node* link) {
+    assert( link != NULL );
+
+    AST_Node* if_node = link->left;
+
+    const char* name = AssignedName(if_node);
+    if (name == NULL) {
+        return false;
+    }
+
+    AST_Node* target = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_VARIABLE, name);
+    AST_Node* select = SelectOf(if_node, name);
+
+    link->left = AST_NodeInit(link, target, select, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_ASSIGNMENT);
+
+    if_node->parent = NULL;
+    AST_SubtreeDestroy(if_node);
+
+    return true;
+}
+
+// =================================== SELECTS ===================================
+
+/* name of the variable, which every block of the branch assigns, NULL if the branch does more */
+static const char* AssignedName(AST_Node* if_node) {
+    assert( if_node != NULL );
+
+    AST_Node* assignment = BlockAssignment(if_node->right);
+    AST_Node* else_part  = AST_ChainElse(if_node->right);
+
+    if (assignment == NULL || else_part == NULL || HasSideEffects(if_node->left)) {
+        return NULL;
+    }
+
+    const char* name = assignment->left->data.variable;
+    const char* else_name = NULL;
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        else_name = AssignedName(else_part);
+    } else {
+        AST_Node* else_assignment = BlockAssignment(else_part->right);
+        else_name = else_assignment != NULL ? else_assignment->left->data.variable : NULL;
+    }
+
+    return else_name != NULL && strcmp(else_name, name) == 0 ? name : NULL;
+}
+
+/* "x = e;" with the cheap e, which is the only statement of the block, NULL for the other blocks */
+static AST_Node* BlockAssignment(AST_Node* chain) {
+    if (    !AST_IsOperation(chain, AST_ELEM_OPERATION_SENTINEL)
+        ||  (chain->right != NULL && chain->right != AST_ChainElse(chain)) ) {
+        return NULL;
+    }
+
+    AST_Node* assignment = chain->left;
+
+    if (    !AST_IsOperation(assignment, AST_ELEM_OPERATION_ASSIGNMENT)
+        ||  assignment->left == NULL || assignment->left->type != AST_ELEM_TYPE_VARIABLE
+        ||  !IsCheapValue(assignment->right) ) {
+        return NULL;
+    }
+
+    return assignment;
+}
+
+/* takes the condition and the values out of the branch, AssignedName has checked its shape */
+static AST_Node* SelectOf(AST_Node* if_node, const char* name) {
+    assert( if_node != NULL );
+    assert( name    != NULL );
+
+    AST_Node* condition = if_node->left;
+    if_node->left = NULL;
+
+    AST_Node* assignment = BlockAssignment(if_node->right);
+    AST_Node* then_value = assignment->right;
+    assignment->right = NULL;
+
+    AST_Node* else_part  = AST_ChainElse(if_node->right);
+    AST_Node* else_value = NULL;
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        else_value = SelectOf(else_part, name);
+    } else {
+        AST_Node* else_assignment = BlockAssignment(else_part->right);
+        else_value = else_assignment->right;
+        else_assignment->right = NULL;
+    }
+
+    return MakeSelect(condition, then_value, else_value);
+}
+
+/* select(cond, a, b) is SELECT(cond, SENTINEL(a, b)) */
+static AST_Node* MakeSelect(AST_Node* condition, AST_Node* then_value, AST_Node* else_value) {
+    assert( condition  != NULL );
+    assert( then_value != NULL );
+    assert( else_value != NULL );
+
+    AST_Node* values = AST_NodeInit(NULL, then_value, else_value, AST_ELEM_TYPE_OPERATION,
+                                    AST_ELEM_OPERATION_SENTINEL);
+
+    return AST_NodeInit(NULL, condition, values, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SELECT);
+}
+
+// =================================== HELPERS ===================================
+
+/* the value, which is not chosen, is computed too, so the division by zero in it would stop the program */
+static bool IsCheapValue(const AST_Node* node) {
+    return     node != NULL && !HasSideEffects(node) && !ContainsDivision(node)
+            && SubtreeSize(node) <= IF_CONVERSION_VALUE_BUDGET;
+}
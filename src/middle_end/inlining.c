@@ -0,0 +1,726 @@
+#include "../../include/middle_end/inlining.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t INLINE_BODY_BUDGET   = 40;     // nodes in the body of an inlined function
+const size_t INLINE_GROWTH_BUDGET = 4096;   // nodes added to the tree by all inlinings of one run
+const size_t INLINE_COPY_ARG_SIZE = 3;      // pure argument is repeated only if it is not bigger
+const int    INLINE_PREFIX_LEN    = 32;
+
+const char INLINE_PREFIX[] = "__inl";
+
+typedef struct Inliner {
+    AST* ast;
+    size_t inlined_cnt;
+    size_t next_id;         // makes names of the inlined locals unique
+    size_t growth;
+    MiddleEndErr_t flag;
+} Inliner;
+
+typedef struct Callee {
+    AST_Node* func_dec;
+    AST_Node* params;       // first parameter declaration, next ones are linked by left
+    AST_Node* body;
+    size_t body_size;
+} Callee;
+
+static void InlineChain(Inliner* inl, AST_Node* link);
+static void InlineStatement(Inliner* inl, AST_Node* link);
+static void InlineElse(Inliner* inl, AST_Node* else_part);
+static void InlineExpression(Inliner* inl, AST_Node* node);
+
+static bool GetCallee(Inliner* inl, AST_Node* call, Callee* callee);
+static bool IsRecursive(Inliner* inl, AST_Node* func_dec);
+static AST_Node* StatementCall(AST_Node* statement);
+
+static bool InlineAsExpression(Inliner* inl, AST_Node* call, const Callee* callee);
+static void ReplaceParams(AST_Node* node, const AST_Node* params, const AST_Node* args);
+
+static bool InlineAsBlock(Inliner* inl, AST_Node* link, AST_Node* call, const Callee* callee);
+static bool BuildParamDecs(const AST_Node* params, const AST_Node* args, const char* prefix, AST_Node** chain);
+static AST_Node* BuildParamDec(const AST_Node* param, const AST_Node* value, const char* prefix);
+static AST_Node* DetachResult(AST_Node** body);
+
+static bool CollectNames(const AST_Node* params, const AST_Node* body, Buffer_t* names);
+static bool UsesOnlyNames(const AST_Node* node, const Buffer_t* names);
+static bool RenameNames(AST_Node* node, const Buffer_t* names, const char* prefix);
+static char* PrefixedName(const char* prefix, const char* name);
+static bool ContainsName(const Buffer_t* names, const char* name);
+static size_t FirstFreeId(const AST_Node* node);
+/* names made by the previous runs stay in the tree, so the numbering goes on after them */
+static size_t FirstFreeId(const AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    size_t free_id    = 0;
+    size_t prefix_len = sizeof(INLINE_PREFIX) - 1;
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE && strncmp(node->data.variable, INLINE_PREFIX, prefix_len) == 0) {
+        char* end = NULL;
+        size_t id = strtoul(node->data.variable + prefix_len, &end, 10);
+
+        if (*end == '_') {
+            free_id = id + 1;
+        }
+    }
+
+    size_t left_id  = FirstFreeId(node->left);
+    size_t right_id = FirstFreeId(node->right);
+
+    if (left_id > free_id) {
+        free_id = left_id;
+    }
+
+    return right_id > free_id ? right_id : free_id;
+}
+
+static size_t CountReturns(const AST_Node* node);
+static bool ContainsAssignment(const AST_Node* node);
+
+MiddleEndErr_t FunctionInlining(AST* ast, size_t* inlined_cnt) {
+    assert( ast != NULL );
+
+    Inliner inl = {
+        .ast         = ast,
+        .inlined_cnt = 0,
+        .next_id     = FirstFreeId(ast->root),
+        .growth      = 0,
+        .flag        = MIDDLE_END_OK
+    };
+
+    InlineChain(&inl, ast->root);
+
+    if (inlined_cnt != NULL) {
+        *inlined_cnt = inl.inlined_cnt;
+    }
+
+    return inl.flag;
+}
+
+// ================================= STATEMENTS =================================
+
+static void InlineChain(Inliner* inl, AST_Node* link) {
+    assert( inl != NULL );
+
+    while (link != NULL && inl->flag == MIDDLE_END_OK) {
+        AST_Node* next = AST_ChainNext(link); // block inlined after the link is not walked again
+        InlineStatement(inl, link);
+        link = next;
+    }
+}
+
+static void InlineStatement(Inliner* inl, AST_Node* link) {
+    assert( inl  != NULL );
+    assert( link != NULL );
+
+    AST_Node* statement = AST_ChainStatement(link);
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        InlineExpression(inl, statement->left);
+        InlineChain(inl, statement->right);
+        InlineElse(inl, AST_ChainElse(statement->right));
+        return;
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        InlineExpression(inl, statement->left);
+        InlineChain(inl, statement->right);
+        return;
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        InlineChain(inl, statement);
+        return;
+
+    } else if (AST_IsFuncDec(statement)) {
+        InlineChain(inl, statement->right->right);
+        return;
+
+    } else if (AST_IsVarDec(statement)) {
+        InlineExpression(inl, AST_VarDecInitializer(statement));
+
+    } else if (    AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)
+                || AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)
+                || AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN) ) {
+        InlineExpression(inl, statement->right);
+
+    } else {
+        InlineExpression(inl, statement);
+    }
+
+    // calls left after the expression inlining
+    AST_Node* call = StatementCall(AST_ChainStatement(link));
+    Callee callee = {};
+
+    if (call != NULL && inl->flag == MIDDLE_END_OK && GetCallee(inl, call, &callee)) {
+        InlineAsBlock(inl, link, call, &callee);
+    }
+}
+
+static void InlineElse(Inliner* inl, AST_Node* else_part) {
+    assert( inl != NULL );
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        InlineExpression(inl, else_part->left);
+        InlineChain(inl, else_part->right);
+        InlineElse(inl, AST_ChainElse(else_part->right));
+
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        InlineChain(inl, else_part->right);
+    }
+}
+
+static void InlineExpression(Inliner* inl, AST_Node* node) {
+    assert( inl != NULL );
+
+    if (node == NULL || inl->flag != MIDDLE_END_OK) {
+        return;
+    }
+
+    InlineExpression(inl, node->left);
+    InlineExpression(inl, node->right);
+
+    Callee callee = {};
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL) && GetCallee(inl, node, &callee)) {
+        InlineAsExpression(inl, node, &callee);
+    }
+}
+
+// =================================== CALLEE ===================================
+
+static bool GetCallee(Inliner* inl, AST_Node* call, Callee* callee) {
+    assert( inl    != NULL );
+    assert( call   != NULL );
+    assert( callee != NULL );
+
+    // else after "return f(a);" is hung on the name of the function by the parser
+    if (call->right->right != NULL) {
+        return false;
+    }
+
+    const char* func_name = call->right->data.variable;
+    if (strcmp(func_name, "main") == 0) {
+        return false;
+    }
+
+    AST_Node* func_dec = FindFuncDec(inl->ast, func_name);
+    if (func_dec == NULL || func_dec->right->right == NULL) {
+        return false;
+    }
+
+    callee->func_dec  = func_dec;
+    callee->params    = func_dec->right->left;
+    callee->body      = func_dec->right->right;
+    callee->body_size = SubtreeSize(callee->body);
+
+    if (callee->body_size > INLINE_BODY_BUDGET || inl->growth + callee->body_size > INLINE_GROWTH_BUDGET) {
+        return false;
+    }
+
+    // types are not inferred yet, so the conversions of doubles at the call would be lost
+    if (func_dec->data.declaration_type == CONST_TYPE_DOUBLE) {
+        return false;
+    }
+
+    const AST_Node* param = callee->params;
+    const AST_Node* arg   = call->left;
+    while (param != NULL && arg != NULL) {
+        if (param->data.declaration_type == CONST_TYPE_DOUBLE) {
+            return false;
+        }
+
+        param = param->left;
+        arg   = arg->left;
+    }
+
+    if (param != NULL || arg != NULL) {
+        return false;
+    }
+
+    return !IsRecursive(inl, func_dec);
+}
+
+/* function reaches itself through the calls */
+static bool IsRecursive(Inliner* inl, AST_Node* func_dec) {
+    assert( inl      != NULL );
+    assert( func_dec != NULL );
+
+    Buffer_t* callees = BufferInit(0, sizeof(AST_Node*));
+    if (callees == NULL) {
+        return true;
+    }
+
+    bool recursive = CollectCallees(inl->ast, func_dec->right->right, callees) != MIDDLE_END_OK;
+
+    for (size_t i = 0; !recursive && i < callees->size; i++) {
+        AST_Node* callee = ((AST_Node**)callees->data)[i];
+
+        if (callee == func_dec) {
+            recursive = true;
+        } else {
+            recursive = CollectCallees(inl->ast, callee->right->right, callees) != MIDDLE_END_OK;
+        }
+    }
+
+    BufferDestroy(&callees);
+
+    return recursive;
+}
+
+/* call, which is the whole value of the statement */
+static AST_Node* StatementCall(AST_Node* statement) {
+    if (statement == NULL) {
+        return NULL;
+    }
+
+    AST_Node* value = NULL;
+
+    if (AST_IsVarDec(statement)) {
+        value = AST_VarDecInitializer(statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        if (statement->left->type == AST_ELEM_TYPE_VARIABLE) {
+            value = statement->right;
+        }
+
+    } else if (    AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)
+                || AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN) ) {
+        value = statement->right;
+
+    } else {
+        value = statement;
+    }
+
+    return AST_IsOperation(value, AST_ELEM_OPERATION_CALL) ? value : NULL;
+}
+
+// ============================== EXPRESSION FORM ==============================
+
+/* f(a, b) with body "return e;" becomes e with parameters replaced by the arguments */
+static bool InlineAsExpression(Inliner* inl, AST_Node* call, const Callee* callee) {
+    assert( inl    != NULL );
+    assert( call   != NULL );
+    assert( callee != NULL );
+
+    if (!AST_IsOperation(callee->body, AST_ELEM_OPERATION_RETURN) || callee->body->right == NULL) {
+        return false;
+    }
+
+    AST_Node* result = callee->body->right;
+
+    Buffer_t* params = BufferInit(0, sizeof(const char*));
+    if (params == NULL) {
+        return false;
+    }
+
+    bool can_inline = CollectNames(callee->params, NULL, params) && UsesOnlyNames(result, params);
+    BufferDestroy(&params);
+
+    size_t effect_cnt = 0;
+
+    const AST_Node* param = callee->params;
+    const AST_Node* arg   = call->left;
+    for (; can_inline && param != NULL; param = param->left, arg = arg->left) {
+        AST_Node* value = arg->right;
+        size_t uses = CountUses(result, param->right->data.variable);
+
+        if (value->type == AST_ELEM_TYPE_CONST || value->type == AST_ELEM_TYPE_VARIABLE) {
+            continue;
+        }
+
+        if (ContainsAssignment(value)) {
+            can_inline = false;
+        } else if (HasSideEffects(value)) {
+            ++effect_cnt;
+            can_inline = uses == 1;
+        } else if (uses > 1) {
+            can_inline = SubtreeSize(value) <= INLINE_COPY_ARG_SIZE;
+        }
+    }
+
+    // effects of the arguments must happen in the same order
+    if (!can_inline || effect_cnt > 1 || (effect_cnt == 1 && HasSideEffects(result))) {
+        return false;
+    }
+
+    AST_Node* expression = AST_SubtreeCopy(result);
+
+    AST_Node** slot = GetParentNodePointer(call);
+    *slot = expression;
+    expression->parent = call->parent;
+    call->parent = NULL;
+
+    ReplaceParams(expression, callee->params, call->left);
+
+    inl->growth += SubtreeSize(expression);
+    ++inl->inlined_cnt;
+
+    AST_SubtreeDestroy(call);
+
+    return true;
+}
+
+static void ReplaceParams(AST_Node* node, const AST_Node* params, const AST_Node* args) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE && !IsCallName(node)) {
+        for (; params != NULL; params = params->left, args = args->left) {
+            if (strcmp(params->right->data.variable, node->data.variable) == 0) {
+                AST_Node* value = AST_SubtreeCopy(args->right);
+
+                *GetParentNodePointer(node) = value;
+                value->parent = node->parent;
+                node->parent = NULL;
+                AST_SubtreeDestroy(node);
+
+                return;
+            }
+        }
+
+        return;
+    }
+
+    ReplaceParams(node->left,  params, args);
+    ReplaceParams(node->right, params, args);
+}
+
+// ================================= BLOCK FORM =================================
+
+/*
+ * statement with f(a, b) as its value becomes the block
+ *      { int p_a = a; int p_b = b; body; statement with the returned value; }
+ * locals of the body are renamed, so they can not hide the variables of the caller
+ */
+static bool InlineAsBlock(Inliner* inl, AST_Node* link, AST_Node* call, const Callee* callee) {
+    assert( inl    != NULL );
+    assert( link   != NULL );
+    assert( call   != NULL );
+    assert( callee != NULL );
+
+    AST_Node* statement = AST_ChainStatement(link);
+
+    // body has the only return and it is the last statement
+    AST_Node* last = callee->body;
+    while (AST_ChainNext(last) != NULL) {
+        last = AST_ChainNext(last);
+    }
+
+    if (    !AST_IsOperation(last, AST_ELEM_OPERATION_RETURN) || last->right == NULL
+         || CountReturns(callee->body) != 1 ) {
+        return false;
+    }
+
+    if (link->parent == NULL) {
+        return false; // statement of the global chain is never executed
+    }
+
+    // "int x = f(x);" reads the outer x, but the block goes after the declaration
+    if (AST_IsVarDec(statement) && CountUses(call->left, AST_VarDecIdentifier(statement)->data.variable) != 0) {
+        return false;
+    }
+
+    Buffer_t* names = BufferInit(0, sizeof(const char*));
+    if (names == NULL) {
+        return false;
+    }
+
+    if (!CollectNames(callee->params, callee->body, names) || !UsesOnlyNames(callee->body, names)) {
+        BufferDestroy(&names);
+        return false;
+    }
+
+    char prefix[INLINE_PREFIX_LEN] = "";
+    snprintf(prefix, INLINE_PREFIX_LEN, "%s%zu_", INLINE_PREFIX, inl->next_id);
+
+    // nothing is changed at the call site until all the copies are made
+    AST_Node* body = AST_SubtreeCopy(callee->body);
+    AST_Node* param_decs = NULL;
+
+    bool built = body != NULL && RenameNames(body, names, prefix)
+                 && BuildParamDecs(callee->params, call->left, prefix, &param_decs);
+    BufferDestroy(&names);
+
+    if (!built) {
+        if (body != NULL) {
+            AST_SubtreeDestroy(body);
+        }
+        inl->flag = MIDDLE_END_ERROR;
+        return false;
+    }
+
+    ++inl->next_id;
+
+    AST_Node* result = DetachResult(&body);
+    AST_Node* block  = ChainAppend(param_decs, body);
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        // block ending with the return takes place of the return
+        AST_Node*  parent = link->parent;
+        AST_Node** slot   = GetParentNodePointer(link);
+        statement->parent = NULL;
+
+        statement->right = result;
+        result->parent = statement;
+
+        block = ChainAppend(block, statement);
+
+        *slot = AST_NodeInit(NULL, block, NULL, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+        (*slot)->parent = parent;
+
+    } else if (AST_IsVarDec(statement)) {
+        // "int v = f(a);" becomes "int v; { ... v = result; }"
+        AST_Node* assignment = statement->right;
+        AST_Node* identifier = assignment->left;
+
+        assignment->left  = NULL;
+        assignment->right = NULL;
+        assignment->parent = NULL;
+        AST_SubtreeDestroy(assignment);
+
+        statement->right = identifier;
+        identifier->parent = statement;
+
+        AST_Node* target = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_VARIABLE, identifier->data.variable);
+        AST_Node* final  = AST_NodeInit(NULL, target, result, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_ASSIGNMENT);
+
+        block = ChainAppend(block, AST_NodeInit(NULL, final, NULL, AST_ELEM_TYPE_OPERATION,
+                                                AST_ELEM_OPERATION_SENTINEL));
+
+        AST_Node* next = link->right;
+        link->right = AST_NodeInit(link, block, next, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+
+    } else {
+        AST_Node* final = result;
+
+        if (statement != call) {
+            // assignment or print keeps its place in the end of the block
+            statement->right = result;
+            result->parent = statement;
+            final = statement;
+        }
+
+        statement->parent = NULL;
+        link->left = NULL;
+
+        block = ChainAppend(block, AST_NodeInit(NULL, final, NULL, AST_ELEM_TYPE_OPERATION,
+                                                AST_ELEM_OPERATION_SENTINEL));
+
+        link->left = block;
+        block->parent = link;
+    }
+
+    call->parent = NULL;
+    AST_SubtreeDestroy(call);
+
+    inl->growth += callee->body_size;
+    ++inl->inlined_cnt;
+
+    return true;
+}
+
+/* "int prefix_p = a;" for every parameter, arguments are copied, so the call stays whole on failure */
+static bool BuildParamDecs(const AST_Node* params, const AST_Node* args, const char* prefix, AST_Node** chain) {
+    assert( prefix != NULL );
+    assert( chain  != NULL );
+
+    *chain = NULL;
+
+    for (; params != NULL; params = params->left, args = args->left) {
+        AST_Node* param_dec = BuildParamDec(params, args->right, prefix);
+        AST_Node* link = NULL;
+
+        if (param_dec != NULL) {
+            link = AST_NodeInit(NULL, param_dec, NULL, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+        }
+
+        if (link == NULL) {
+            if (param_dec != NULL) {
+                AST_SubtreeDestroy(param_dec);
+            }
+            if (*chain != NULL) {
+                AST_SubtreeDestroy(*chain);
+                *chain = NULL;
+            }
+            return false;
+        }
+
+        *chain = ChainAppend(*chain, link);
+    }
+
+    return true;
+}
+
+static AST_Node* BuildParamDec(const AST_Node* param, const AST_Node* value, const char* prefix) {
+    assert( param  != NULL );
+    assert( value  != NULL );
+    assert( prefix != NULL );
+
+    char* name = PrefixedName(prefix, param->right->data.variable);
+    if (name == NULL) {
+        return NULL;
+    }
+
+    AST_Node* identifier = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_VARIABLE, name);
+    free(name);
+
+    AST_Node* copy = AST_SubtreeCopy(value);
+    AST_Node* assignment = NULL;
+
+    if (identifier != NULL && copy != NULL) {
+        assignment = AST_NodeInit(NULL, identifier, copy, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_ASSIGNMENT);
+    }
+
+    if (assignment == NULL) {
+        if (identifier != NULL) {
+            AST_SubtreeDestroy(identifier);
+        }
+        if (copy != NULL) {
+            AST_SubtreeDestroy(copy);
+        }
+        return NULL;
+    }
+
+    AST_Node* param_dec = AST_NodeInit(NULL, NULL, assignment, AST_ELEM_TYPE_DECLARATION,
+                                       param->data.declaration_type);
+    if (param_dec == NULL) {
+        AST_SubtreeDestroy(assignment);
+    }
+
+    return param_dec;
+}
+
+/* cuts the final return off the body and returns its value */
+static AST_Node* DetachResult(AST_Node** body) {
+    assert( body  != NULL );
+    assert( *body != NULL );
+
+    AST_Node* last = *body;
+    while (AST_ChainNext(last) != NULL) {
+        last = AST_ChainNext(last);
+    }
+
+    AST_Node* result = last->right;
+    last->right = NULL;
+    result->parent = NULL;
+
+    if (last == *body) {
+        *body = NULL;
+    }
+
+    AST_SubtreeDestroy(last);
+
+    return result;
+}
+
+// =================================== NAMES ===================================
+
+/* parameters and locals declared anywhere in the body */
+static bool CollectNames(const AST_Node* params, const AST_Node* body, Buffer_t* names) {
+    assert( names != NULL );
+
+    for (; params != NULL; params = params->left) {
+        if (BufferPush(names, &params->right->data.variable, sizeof(const char*)) != BUFFER_OK) {
+            return false;
+        }
+    }
+
+    if (body == NULL) {
+        return true;
+    }
+
+    if (AST_IsVarDec(body)) {
+        if (BufferPush(names, &AST_VarDecIdentifier(body)->data.variable, sizeof(const char*)) != BUFFER_OK) {
+            return false;
+        }
+    }
+
+    return CollectNames(NULL, body->left, names) && CollectNames(NULL, body->right, names);
+}
+
+static bool UsesOnlyNames(const AST_Node* node, const Buffer_t* names) {
+    assert( names != NULL );
+
+    if (node == NULL) {
+        return true;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE && !IsCallName(node)) {
+        return ContainsName(names, node->data.variable);
+    }
+
+    return UsesOnlyNames(node->left, names) && UsesOnlyNames(node->right, names);
+}
+
+static bool RenameNames(AST_Node* node, const Buffer_t* names, const char* prefix) {
+    assert( names  != NULL );
+    assert( prefix != NULL );
+
+    if (node == NULL) {
+        return true;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE && !IsCallName(node) && ContainsName(names, node->data.variable)) {
+        char* name = PrefixedName(prefix, node->data.variable);
+        if (name == NULL) {
+            return false;
+        }
+
+        free(node->data.variable);
+        node->data.variable = name;
+    }
+
+    return RenameNames(node->left, names, prefix) && RenameNames(node->right, names, prefix);
+}
+
+static char* PrefixedName(const char* prefix, const char* name) {
+    assert( prefix != NULL );
+    assert( name   != NULL );
+
+    char* prefixed = (char*)calloc(strlen(prefix) + strlen(name) + 1, sizeof(char));
+    if (prefixed == NULL) {
+        return NULL;
+    }
+
+    return strcat(strcpy(prefixed, prefix), name);
+}
+
+static bool ContainsName(const Buffer_t* names, const char* name) {
+    assert( names != NULL );
+    assert( name  != NULL );
+
+    for (size_t i = 0; i < names->size; i++) {
+        if (strcmp(((const char**)names->data)[i], name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t CountReturns(const AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    size_t returns = AST_IsOperation(node, AST_ELEM_OPERATION_RETURN);
+
+    return returns + CountReturns(node->left) + CountReturns(node->right);
+}
+
+static bool ContainsAssignment(const AST_Node* node) {
+    if (node == NULL) {
+        return false;
+    }
+
+    return    AST_IsOperation(node, AST_ELEM_OPERATION_ASSIGNMENT)
+           || ContainsAssignment(node->left) || ContainsAssignment(node->right);
+}
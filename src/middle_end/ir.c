@@ -0,0 +1,682 @@
+#include "../../include/middle_end/ir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+static MiddleEndErr_t RemoveUnreachableBlocks(IR_Function* func);
+static void MarkReachable(const IR_Function* func, size_t id, bool* reachable);
+static void RenumberTargets(IR_Function* func, const size_t* new_ids);
+static MiddleEndErr_t BlockDestroy(IR_Block** block);
+static size_t Intersect(const IR_Function* func, const size_t* order, size_t a, size_t b);
+static void PostOrder(const IR_Function* func, size_t id, bool* visited, size_t* post, size_t* cnt);
+
+// ================================== MODULE ==================================
+
+IR_Module* IR_ModuleInit() {
+    IR_Module* module = (IR_Module*)calloc(1, sizeof(IR_Module));
+    if (module == NULL) {
+        return NULL;
+    }
+
+    module->functions = BufferInit(0, sizeof(IR_Function*));
+    if (module->functions == NULL) {
+        FREE(module);
+        return NULL;
+    }
+
+    return module;
+}
+
+MiddleEndErr_t IR_ModuleDestroy(IR_Module** module) {
+    assert( module  != NULL );
+    assert( *module != NULL );
+
+    IR_Function** functions = (IR_Function**)(*module)->functions->data;
+    for (size_t i = 0; i < (*module)->functions->size; i++) {
+        IR_FunctionDestroy(&functions[i]);
+    }
+
+    BufferDestroy(&(*module)->functions);
+    FREE(*module);
+
+    return MIDDLE_END_OK;
+}
+
+// ================================= FUNCTION =================================
+
+IR_Function* IR_FunctionInit(const char* name) {
+    assert( name != NULL );
+
+    IR_Function* func = (IR_Function*)calloc(1, sizeof(IR_Function));
+    if (func == NULL) {
+        return NULL;
+    }
+
+    func->name   = strdup(name);
+    func->blocks = BufferInit(0, sizeof(IR_Block*));
+    func->values = BufferInit(0, sizeof(IR_Value));
+
+    if (func->name == NULL || func->blocks == NULL || func->values == NULL) {
+        IR_FunctionDestroy(&func);
+        return NULL;
+    }
+
+    func->param_cnt = 0;
+    func->is_ssa = false;
+
+    return func;
+}
+
+MiddleEndErr_t IR_FunctionDestroy(IR_Function** func) {
+    assert( func  != NULL );
+    assert( *func != NULL );
+
+    if ((*func)->blocks != NULL) {
+        IR_Block** blocks = (IR_Block**)(*func)->blocks->data;
+        for (size_t i = 0; i < (*func)->blocks->size; i++) {
+            BlockDestroy(&blocks[i]);
+        }
+        BufferDestroy(&(*func)->blocks);
+    }
+
+    if ((*func)->values != NULL) {
+        IR_Value* values = (IR_Value*)(*func)->values->data;
+        for (size_t i = 0; i < (*func)->values->size; i++) {
+            FREE(values[i].name);
+        }
+        BufferDestroy(&(*func)->values);
+    }
+
+    FREE((*func)->name);
+    FREE(*func);
+
+    return MIDDLE_END_OK;
+}
+
+IR_Function* IR_FindFunction(const IR_Module* module, const char* name) {
+    assert( module != NULL );
+    assert( name   != NULL );
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        if (strcmp(functions[i]->name, name) == 0) {
+            return functions[i];
+        }
+    }
+
+    return NULL;
+}
+
+// =================================== BLOCK ===================================
+
+IR_Block* IR_BlockAdd(IR_Function* func) {
+    assert( func != NULL );
+
+    IR_Block* block = (IR_Block*)calloc(1, sizeof(IR_Block));
+    if (block == NULL) {
+        return NULL;
+    }
+
+    block->id     = func->blocks->size;
+    block->idom   = IR_NO_BLOCK;
+    block->instrs = BufferInit(0, sizeof(IR_Instr));
+    block->preds  = BufferInit(0, sizeof(size_t));
+    block->succs  = BufferInit(0, sizeof(size_t));
+
+    if (block->instrs == NULL || block->preds == NULL || block->succs == NULL) {
+        BlockDestroy(&block);
+        return NULL;
+    }
+
+    BufferPush(func->blocks, &block, sizeof(IR_Block*));
+
+    return block;
+}
+
+IR_Block* IR_GetBlock(const IR_Function* func, size_t id) {
+    assert( func != NULL );
+    assert( id < func->blocks->size );
+
+    return ((IR_Block**)func->blocks->data)[id];
+}
+
+size_t IR_BlockCount(const IR_Function* func) {
+    assert( func != NULL );
+
+    return func->blocks->size;
+}
+
+size_t IR_InstrCount(const IR_Block* block) {
+    assert( block != NULL );
+
+    return block->instrs->size;
+}
+
+IR_Instr* IR_GetInstr(const IR_Block* block, size_t idx) {
+    assert( block != NULL );
+    assert( idx < block->instrs->size );
+
+    return &((IR_Instr*)block->instrs->data)[idx];
+}
+
+IR_Instr* IR_Terminator(const IR_Block* block) {
+    assert( block != NULL );
+
+    if (block->instrs->size == 0) {
+        return NULL;
+    }
+
+    IR_Instr* last = IR_GetInstr(block, block->instrs->size - 1);
+
+    return IR_IsTerminator(last->opcode) ? last : NULL;
+}
+
+static MiddleEndErr_t BlockDestroy(IR_Block** block) {
+    assert( block  != NULL );
+    assert( *block != NULL );
+
+    if ((*block)->instrs != NULL) {
+        for (size_t i = 0; i < (*block)->instrs->size; i++) {
+            IR_InstrClear(IR_GetInstr(*block, i));
+        }
+        BufferDestroy(&(*block)->instrs);
+    }
+
+    if ((*block)->preds != NULL) {
+        BufferDestroy(&(*block)->preds);
+    }
+    if ((*block)->succs != NULL) {
+        BufferDestroy(&(*block)->succs);
+    }
+
+    FREE(*block);
+
+    return MIDDLE_END_OK;
+}
+
+// =================================== VALUE ===================================
+
+size_t IR_ValueAdd(IR_Function* func, const char* name, ConstType type) {
+    assert( func != NULL );
+
+    IR_Value value = {
+        .name = name != NULL ? strdup(name) : NULL,
+        .type = type
+    };
+
+    BufferPush(func->values, &value, sizeof(IR_Value));
+
+    return func->values->size - 1;
+}
+
+size_t IR_ValueCount(const IR_Function* func) {
+    assert( func != NULL );
+
+    return func->values->size;
+}
+
+IR_Value* IR_GetValue(const IR_Function* func, size_t value) {
+    assert( func != NULL );
+    assert( value < func->values->size );
+
+    return &((IR_Value*)func->values->data)[value];
+}
+
+// ================================ INSTRUCTION ================================
+
+IR_Instr IR_InstrMake(IR_Opcode opcode, ConstType type, size_t dst, size_t a, size_t b) {
+    IR_Instr instr = {
+        .opcode    = opcode,
+        .type      = type,
+        .dst       = dst,
+        .args      = {a, b},
+        .imm       = 0,
+        .targets   = {IR_NO_BLOCK, IR_NO_BLOCK},
+        .callee    = NULL,
+        .call_args = NULL,
+        .phi_args  = NULL
+    };
+
+    return instr;
+}
+
+/* block takes the ownership of the callee and argument buffers */
+MiddleEndErr_t IR_Emit(IR_Block* block, IR_Instr instr) {
+    assert( block != NULL );
+
+    if (BufferPush(block->instrs, &instr, sizeof(IR_Instr)) != BUFFER_OK) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+MiddleEndErr_t IR_Insert(IR_Block* block, size_t idx, IR_Instr instr) {
+    assert( block != NULL );
+    assert( idx <= block->instrs->size );
+
+    MiddleEndErr_t flag = IR_Emit(block, instr);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    IR_Instr* instrs = (IR_Instr*)block->instrs->data;
+    size_t last = block->instrs->size - 1;
+
+    memmove(instrs + idx + 1, instrs + idx, (last - idx) * sizeof(IR_Instr));
+    instrs[idx] = instr;
+
+    return MIDDLE_END_OK;
+}
+
+/* turns the instruction into nop and frees its buffers */
+void IR_InstrClear(IR_Instr* instr) {
+    assert( instr != NULL );
+
+    FREE(instr->callee);
+
+    if (instr->call_args != NULL) {
+        BufferDestroy(&instr->call_args);
+    }
+    if (instr->phi_args != NULL) {
+        BufferDestroy(&instr->phi_args);
+    }
+
+    *instr = IR_InstrMake(IR_OP_NOP, CONST_TYPE_VOID, IR_NO_VALUE, IR_NO_VALUE, IR_NO_VALUE);
+}
+
+void IR_RemoveNops(IR_Function* func) {
+    assert( func != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+        IR_Instr* instrs = (IR_Instr*)block->instrs->data;
+        size_t kept = 0;
+
+        for (size_t j = 0; j < block->instrs->size; j++) {
+            if (instrs[j].opcode != IR_OP_NOP) {
+                instrs[kept++] = instrs[j];
+            }
+        }
+
+        block->instrs->size = kept;
+    }
+}
+
+/* every operand and phi argument old_value is replaced by new_value */
+void IR_ReplaceUses(IR_Function* func, size_t old_value, size_t new_value) {
+    assert( func != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            for (size_t k = 0; k < IR_OperandCount(instr); k++) {
+                size_t* operand = IR_Operand(instr, k);
+                if (*operand == old_value) {
+                    *operand = new_value;
+                }
+            }
+
+            if (instr->opcode == IR_OP_PHI) {
+                IR_PhiArg* phi_args = (IR_PhiArg*)instr->phi_args->data;
+                for (size_t k = 0; k < instr->phi_args->size; k++) {
+                    if (phi_args[k].value == old_value) {
+                        phi_args[k].value = new_value;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool IR_IsTerminator(IR_Opcode opcode) {
+    return opcode == IR_OP_JUMP || opcode == IR_OP_BRANCH || opcode == IR_OP_RETURN;
+}
+
+bool IR_IsBinary(IR_Opcode opcode) {
+    return IR_OP_ADD <= opcode && opcode <= IR_OP_LOR;
+}
+
+bool IR_IsCommutative(IR_Opcode opcode) {
+    return    opcode == IR_OP_ADD  || opcode == IR_OP_MUL
+           || opcode == IR_OP_EE   || opcode == IR_OP_NE
+           || opcode == IR_OP_LAND || opcode == IR_OP_LOR;
+}
+
+/* instruction, which can not be removed even if its result is unused */
+bool IR_HasSideEffects(const IR_Instr* instr) {
+    assert( instr != NULL );
+
+    return    instr->opcode == IR_OP_INPUT || instr->opcode == IR_OP_PRINT
+           || instr->opcode == IR_OP_CALL  || IR_IsTerminator(instr->opcode)
+           || instr->opcode == IR_OP_DIV; // division by zero stops the processor
+}
+
+/* number of values read by the instruction, phi arguments are not counted */
+size_t IR_OperandCount(const IR_Instr* instr) {
+    assert( instr != NULL );
+
+    if (instr->opcode == IR_OP_CALL) {
+        return instr->call_args->size;
+    }
+
+    if (instr->opcode == IR_OP_PHI) {
+        return 0;
+    }
+
+    size_t cnt = 0;
+    while (cnt < 2 && instr->args[cnt] != IR_NO_VALUE) {
+        ++cnt;
+    }
+
+    return cnt;
+}
+
+/* operands go in the order of evaluation */
+size_t* IR_Operand(IR_Instr* instr, size_t idx) {
+    assert( instr != NULL );
+    assert( idx < IR_OperandCount(instr) );
+
+    if (instr->opcode == IR_OP_CALL) {
+        return &((size_t*)instr->call_args->data)[idx];
+    }
+
+    return &instr->args[idx];
+}
+
+size_t IR_SuccCount(const IR_Instr* terminator) {
+    if (terminator == NULL) {
+        return 0;
+    }
+
+    switch (terminator->opcode) {
+    case IR_OP_JUMP:
+        return 1;
+
+    case IR_OP_BRANCH:
+        return 2;
+
+    case IR_OP_RETURN:
+        return 0;
+
+    case IR_OP_NOP:
+    case IR_OP_PARAM:
+    case IR_OP_CONST:
+    case IR_OP_COPY:
+    case IR_OP_ADD:
+    case IR_OP_SUB:
+    case IR_OP_MUL:
+    case IR_OP_DIV:
+    case IR_OP_SHL:
+    case IR_OP_SHR:
+    case IR_OP_LT:
+    case IR_OP_GT:
+    case IR_OP_LE:
+    case IR_OP_GE:
+    case IR_OP_EE:
+    case IR_OP_NE:
+    case IR_OP_LAND:
+    case IR_OP_LOR:
+    case IR_OP_INPUT:
+    case IR_OP_PRINT:
+    case IR_OP_CALL:
+    case IR_OP_PHI:
+    default:
+        return 0;
+    }
+}
+
+// ==================================== CFG ====================================
+
+/* removes unreachable blocks and fills predecessors and successors */
+MiddleEndErr_t IR_BuildCFG(IR_Function* func) {
+    assert( func != NULL );
+
+    MiddleEndErr_t flag = RemoveUnreachableBlocks(func);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+        block->preds->size = 0;
+        block->succs->size = 0;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+        IR_Instr* terminator = IR_Terminator(block);
+
+        for (size_t j = 0; j < IR_SuccCount(terminator); j++) {
+            size_t target = terminator->targets[j];
+            if (j == 1 && target == terminator->targets[0]) {
+                continue; // both edges of the branch go to the same block
+            }
+
+            BufferPush(block->succs, &target, sizeof(size_t));
+            BufferPush(IR_GetBlock(func, target)->preds, &block->id, sizeof(size_t));
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t RemoveUnreachableBlocks(IR_Function* func) {
+    assert( func != NULL );
+
+    size_t block_cnt = IR_BlockCount(func);
+    if (block_cnt == 0) {
+        return MIDDLE_END_OK;
+    }
+
+    bool*   reachable = (bool*)  calloc(block_cnt, sizeof(bool));
+    size_t* new_ids   = (size_t*)calloc(block_cnt, sizeof(size_t));
+    if (reachable == NULL || new_ids == NULL) {
+        free(reachable);
+        free(new_ids);
+        return MIDDLE_END_ERROR;
+    }
+
+    MarkReachable(func, 0, reachable);
+
+    IR_Block** blocks = (IR_Block**)func->blocks->data;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < block_cnt; i++) {
+        if (reachable[i]) {
+            new_ids[i] = kept;
+            blocks[kept] = blocks[i];
+            blocks[kept]->id = kept;
+            ++kept;
+        } else {
+            new_ids[i] = IR_NO_BLOCK;
+            BlockDestroy(&blocks[i]);
+        }
+    }
+
+    func->blocks->size = kept;
+
+    RenumberTargets(func, new_ids);
+
+    FREE(reachable);
+    FREE(new_ids);
+
+    return MIDDLE_END_OK;
+}
+
+static void MarkReachable(const IR_Function* func, size_t id, bool* reachable) {
+    assert( func      != NULL );
+    assert( reachable != NULL );
+
+    if (reachable[id]) {
+        return;
+    }
+
+    reachable[id] = true;
+
+    IR_Instr* terminator = IR_Terminator(IR_GetBlock(func, id));
+    for (size_t i = 0; i < IR_SuccCount(terminator); i++) {
+        MarkReachable(func, terminator->targets[i], reachable);
+    }
+}
+
+static void RenumberTargets(IR_Function* func, const size_t* new_ids) {
+    assert( func    != NULL );
+    assert( new_ids != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            for (size_t k = 0; k < IR_SuccCount(instr); k++) {
+                instr->targets[k] = new_ids[instr->targets[k]];
+            }
+
+            if (instr->opcode == IR_OP_PHI) {
+                IR_PhiArg* phi_args = (IR_PhiArg*)instr->phi_args->data;
+                size_t kept = 0;
+
+                for (size_t k = 0; k < instr->phi_args->size; k++) {
+                    if (new_ids[phi_args[k].block] != IR_NO_BLOCK) {
+                        phi_args[kept] = phi_args[k];
+                        phi_args[kept].block = new_ids[phi_args[k].block];
+                        ++kept;
+                    }
+                }
+
+                instr->phi_args->size = kept;
+            }
+        }
+    }
+}
+
+// ================================ DOMINATORS ================================
+
+/* Cooper, Harvey, Kennedy "A Simple, Fast Dominance Algorithm", CFG must be built */
+MiddleEndErr_t IR_ComputeDominators(IR_Function* func) {
+    assert( func != NULL );
+
+    size_t block_cnt = IR_BlockCount(func);
+    if (block_cnt == 0) {
+        return MIDDLE_END_OK;
+    }
+
+    bool*   visited = (bool*)  calloc(block_cnt, sizeof(bool));
+    size_t* post    = (size_t*)calloc(block_cnt, sizeof(size_t));
+    size_t* order   = (size_t*)calloc(block_cnt, sizeof(size_t));  // postorder number of the block
+    if (visited == NULL || post == NULL || order == NULL) {
+        free(visited);
+        free(post);
+        free(order);
+        return MIDDLE_END_ERROR;
+    }
+
+    size_t post_cnt = 0;
+    PostOrder(func, 0, visited, post, &post_cnt);
+
+    for (size_t i = 0; i < post_cnt; i++) {
+        order[post[i]] = i;
+    }
+
+    for (size_t i = 0; i < block_cnt; i++) {
+        IR_GetBlock(func, i)->idom = IR_NO_BLOCK;
+    }
+    IR_GetBlock(func, 0)->idom = 0;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = post_cnt; i-- > 0; ) {
+            IR_Block* block = IR_GetBlock(func, post[i]);
+            if (block->id == 0) {
+                continue;
+            }
+
+            const size_t* preds = (const size_t*)block->preds->data;
+            size_t new_idom = IR_NO_BLOCK;
+
+            for (size_t j = 0; j < block->preds->size; j++) {
+                if (IR_GetBlock(func, preds[j])->idom == IR_NO_BLOCK) {
+                    continue;
+                }
+
+                new_idom = new_idom == IR_NO_BLOCK ? preds[j] : Intersect(func, order, preds[j], new_idom);
+            }
+
+            if (block->idom != new_idom) {
+                block->idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    FREE(visited);
+    FREE(post);
+    FREE(order);
+
+    return MIDDLE_END_OK;
+}
+
+bool IR_Dominates(const IR_Function* func, size_t dominator, size_t block) {
+    assert( func != NULL );
+
+    while (true) {
+        if (block == dominator) {
+            return true;
+        }
+
+        size_t idom = IR_GetBlock(func, block)->idom;
+        if (idom == IR_NO_BLOCK || idom == block) {
+            return false;
+        }
+
+        block = idom;
+    }
+}
+
+static size_t Intersect(const IR_Function* func, const size_t* order, size_t a, size_t b) {
+    assert( func  != NULL );
+    assert( order != NULL );
+
+    while (a != b) {
+        while (order[a] < order[b]) {
+            a = IR_GetBlock(func, a)->idom;
+        }
+        while (order[b] < order[a]) {
+            b = IR_GetBlock(func, b)->idom;
+        }
+    }
+
+    return a;
+}
+
+static void PostOrder(const IR_Function* func, size_t id, bool* visited, size_t* post, size_t* cnt) {
+    assert( func    != NULL );
+    assert( visited != NULL );
+    assert( post    != NULL );
+    assert( cnt     != NULL );
+
+    visited[id] = true;
+
+    IR_Block* block = IR_GetBlock(func, id);
+    const size_t* succs = (const size_t*)block->succs->data;
+
+    for (size_t i = 0; i < block->succs->size; i++) {
+        if (!visited[succs[i]]) {
+            PostOrder(func, succs[i], visited, post, cnt);
+        }
+    }
+
+    post[(*cnt)++] = id;
+}
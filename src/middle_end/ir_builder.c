@@ -0,0 +1,674 @@
+#include "../../include/middle_end/ir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct IR_Binding {
+    const char* name;
+    size_t value;
+} IR_Binding;
+
+typedef struct IR_Break {
+    size_t loop_depth;
+    IR_Block* block;        // block ending with the jump to the loop exit
+} IR_Break;
+
+typedef struct IR_Builder {
+    AST* ast;
+    IR_Function* func;
+    IR_Block* block;        // block, which gets the next instruction
+    Buffer_t* bindings;     // IR_Binding, visible variables, inner ones are at the end
+    Buffer_t* breaks;       // IR_Break, jumps waiting for the exit block of their loop
+    size_t loop_depth;
+    MiddleEndErr_t flag;
+} IR_Builder;
+
+static MiddleEndErr_t BuildFunction(IR_Module* module, AST* ast, AST_Node* func_dec);
+
+static void BuildChain(IR_Builder* builder, AST_Node* link);
+static void BuildStatement(IR_Builder* builder, AST_Node* statement);
+static void BuildIf(IR_Builder* builder, AST_Node* if_node);
+static void BuildWhile(IR_Builder* builder, AST_Node* while_node);
+static void BuildVarDec(IR_Builder* builder, AST_Node* var_dec);
+static void BuildAssignment(IR_Builder* builder, AST_Node* assignment);
+
+static size_t BuildExpression(IR_Builder* builder, AST_Node* node);
+static size_t BuildCall(IR_Builder* builder, AST_Node* call);
+static size_t BuildSelect(IR_Builder* builder, AST_Node* select);
+static size_t BuildLogic(IR_Builder* builder, AST_Node* logic);
+
+static IR_Block* Emit(IR_Builder* builder, IR_Instr instr);
+static IR_Block* EmitJump(IR_Builder* builder, size_t target);
+static size_t EmitConst(IR_Builder* builder, int imm);
+static size_t NewTemp(IR_Builder* builder, ConstType type);
+static void CheckType(IR_Builder* builder, ConstType type);
+
+static void Bind(IR_Builder* builder, const char* name, size_t value);
+static size_t LookUp(IR_Builder* builder, const char* name);
+static bool IsGlobalName(const AST* ast, const char* name);
+static IR_Opcode BinaryOpcode(AST_ElemOperation operation);
+
+MiddleEndErr_t IR_Build(AST* ast, IR_Module** module) {
+    assert( ast    != NULL );
+    assert( module != NULL );
+
+    *module = IR_ModuleInit();
+    if (*module == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    // statements out of functions are never executed
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement)) {
+            MiddleEndErr_t flag = BuildFunction(*module, ast, statement);
+            if (flag != MIDDLE_END_OK) {
+                IR_ModuleDestroy(module);
+                return flag;
+            }
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t BuildFunction(IR_Module* module, AST* ast, AST_Node* func_dec) {
+    assert( module   != NULL );
+    assert( ast      != NULL );
+    assert( func_dec != NULL );
+
+    AST_Node* identifier = func_dec->right;
+
+    IR_Builder builder = {
+        .ast        = ast,
+        .func       = IR_FunctionInit(identifier->data.variable),
+        .block      = NULL,
+        .bindings   = BufferInit(0, sizeof(IR_Binding)),
+        .breaks     = BufferInit(0, sizeof(IR_Break)),
+        .loop_depth = 0,
+        .flag       = MIDDLE_END_OK
+    };
+
+    if (builder.func == NULL || builder.bindings == NULL || builder.breaks == NULL) {
+        builder.flag = MIDDLE_END_BUFFER_FAILED;
+    } else {
+        builder.block = IR_BlockAdd(builder.func);
+    }
+
+    if (builder.block != NULL) {
+        CheckType(&builder, func_dec->data.declaration_type);
+
+        for (AST_Node* param = identifier->left; param != NULL; param = param->left) {
+            const char* name = param->right->data.variable;
+            CheckType(&builder, param->data.declaration_type);
+
+            size_t value = IR_ValueAdd(builder.func, name, param->data.declaration_type);
+
+            IR_Instr instr = IR_InstrMake(IR_OP_PARAM, param->data.declaration_type, value, IR_NO_VALUE, IR_NO_VALUE);
+            instr.imm = (int)builder.func->param_cnt++;
+
+            Emit(&builder, instr);
+            Bind(&builder, name, value);
+        }
+
+        BuildChain(&builder, identifier->right);
+
+        // falling off the end returns zero
+        if (IR_Terminator(builder.block) == NULL) {
+            size_t zero = EmitConst(&builder, 0);
+            Emit(&builder, IR_InstrMake(IR_OP_RETURN, func_dec->data.declaration_type, IR_NO_VALUE, zero, IR_NO_VALUE));
+        }
+    }
+
+    if (builder.flag == MIDDLE_END_OK) {
+        builder.flag = IR_BuildCFG(builder.func);
+    }
+
+    if (builder.flag == MIDDLE_END_OK) {
+        BufferPush(module->functions, &builder.func, sizeof(IR_Function*));
+    } else if (builder.func != NULL) {
+        IR_FunctionDestroy(&builder.func);
+    }
+
+    if (builder.bindings != NULL) {
+        BufferDestroy(&builder.bindings);
+    }
+    if (builder.breaks != NULL) {
+        BufferDestroy(&builder.breaks);
+    }
+
+    return builder.flag;
+}
+
+// ================================= STATEMENTS =================================
+
+static void BuildChain(IR_Builder* builder, AST_Node* link) {
+    assert( builder != NULL );
+
+    size_t visible = builder->bindings->size;
+
+    for (; link != NULL; link = AST_ChainNext(link)) {
+        BuildStatement(builder, AST_ChainStatement(link));
+    }
+
+    builder->bindings->size = visible; // block scope ends
+}
+
+static void BuildStatement(IR_Builder* builder, AST_Node* statement) {
+    assert( builder   != NULL );
+    assert( statement != NULL );
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        BuildChain(builder, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        BuildIf(builder, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        BuildWhile(builder, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_BREAK)) {
+        if (builder->loop_depth != 0) {
+            IR_Break jump = {
+                .loop_depth = builder->loop_depth,
+                .block = EmitJump(builder, IR_NO_BLOCK)
+            };
+            BufferPush(builder->breaks, &jump, sizeof(IR_Break));
+        }
+
+    } else if (AST_IsVarDec(statement)) {
+        BuildVarDec(builder, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        BuildAssignment(builder, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)) {
+        size_t value = BuildExpression(builder, statement->right);
+        Emit(builder, IR_InstrMake(IR_OP_PRINT, CONST_TYPE_VOID, IR_NO_VALUE, value, IR_NO_VALUE));
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        size_t value = statement->right != NULL ? BuildExpression(builder, statement->right) : EmitConst(builder, 0);
+        Emit(builder, IR_InstrMake(IR_OP_RETURN, statement->value_type, IR_NO_VALUE, value, IR_NO_VALUE));
+
+    } else {
+        BuildExpression(builder, statement); // value of the expression statement is dropped
+    }
+}
+
+/*
+ *      branch cond, then, else     (else is the end block without else part)
+ *  then:
+ *      ...
+ *      jump end
+ *  else:
+ *      ...
+ *      jump end
+ *  end:
+ */
+static void BuildIf(IR_Builder* builder, AST_Node* if_node) {
+    assert( builder != NULL );
+    assert( if_node != NULL );
+
+    size_t condition = BuildExpression(builder, if_node->left);
+
+    IR_Block* branch_block = Emit(builder, IR_InstrMake(IR_OP_BRANCH, CONST_TYPE_VOID, IR_NO_VALUE,
+                                                        condition, IR_NO_VALUE));
+
+    builder->block = IR_BlockAdd(builder->func);
+    IR_Terminator(branch_block)->targets[0] = builder->block->id;
+
+    BuildChain(builder, if_node->right);
+    IR_Block* then_end = EmitJump(builder, IR_NO_BLOCK);
+
+    AST_Node* else_part = AST_ChainElse(if_node->right);
+    IR_Block* else_end  = NULL;
+
+    if (else_part != NULL) {
+        builder->block = IR_BlockAdd(builder->func);
+        IR_Terminator(branch_block)->targets[1] = builder->block->id;
+
+        if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+            BuildIf(builder, else_part);
+        } else {
+            BuildChain(builder, else_part->right);
+        }
+
+        else_end = EmitJump(builder, IR_NO_BLOCK);
+    }
+
+    builder->block = IR_BlockAdd(builder->func);
+
+    IR_Terminator(then_end)->targets[0] = builder->block->id;
+    if (else_end != NULL) {
+        IR_Terminator(else_end)->targets[0] = builder->block->id;
+    } else {
+        IR_Terminator(branch_block)->targets[1] = builder->block->id;
+    }
+}
+
+/*
+ *      jump cond
+ *  cond:
+ *      branch cond, body, exit
+ *  body:
+ *      ...
+ *      jump cond
+ *  exit:
+ */
+static void BuildWhile(IR_Builder* builder, AST_Node* while_node) {
+    assert( builder    != NULL );
+    assert( while_node != NULL );
+
+    IR_Block* cond_block = IR_BlockAdd(builder->func);
+    EmitJump(builder, cond_block->id);
+
+    builder->block = cond_block;
+    size_t condition = BuildExpression(builder, while_node->left);
+
+    IR_Block* branch_block = Emit(builder, IR_InstrMake(IR_OP_BRANCH, CONST_TYPE_VOID, IR_NO_VALUE,
+                                                        condition, IR_NO_VALUE));
+
+    builder->block = IR_BlockAdd(builder->func);
+    IR_Terminator(branch_block)->targets[0] = builder->block->id;
+
+    ++builder->loop_depth;
+    BuildChain(builder, while_node->right);
+    EmitJump(builder, cond_block->id);
+
+    builder->block = IR_BlockAdd(builder->func);
+    IR_Terminator(branch_block)->targets[1] = builder->block->id;
+
+    IR_Break* breaks = (IR_Break*)builder->breaks->data;
+    while (builder->breaks->size != 0 && breaks[builder->breaks->size - 1].loop_depth == builder->loop_depth) {
+        IR_Terminator(breaks[--builder->breaks->size].block)->targets[0] = builder->block->id;
+    }
+
+    --builder->loop_depth;
+}
+
+static void BuildVarDec(IR_Builder* builder, AST_Node* var_dec) {
+    assert( builder != NULL );
+    assert( var_dec != NULL );
+
+    AST_Node* initializer = AST_VarDecInitializer(var_dec);
+    const char* name = AST_VarDecIdentifier(var_dec)->data.variable;
+
+    CheckType(builder, var_dec->data.declaration_type);
+
+    // initializer sees the variables of the enclosing scope
+    size_t init_value = initializer != NULL ? BuildExpression(builder, initializer) : IR_NO_VALUE;
+
+    size_t value = IR_ValueAdd(builder->func, name, var_dec->data.declaration_type);
+
+    if (init_value != IR_NO_VALUE) {
+        Emit(builder, IR_InstrMake(IR_OP_COPY, var_dec->data.declaration_type, value, init_value, IR_NO_VALUE));
+    } else {
+        IR_Instr instr = IR_InstrMake(IR_OP_CONST, var_dec->data.declaration_type, value, IR_NO_VALUE, IR_NO_VALUE);
+        Emit(builder, instr);
+    }
+
+    Bind(builder, name, value);
+}
+
+/* x = y = expr, the targets are assigned from right to left as in the back end */
+static void BuildAssignment(IR_Builder* builder, AST_Node* assignment) {
+    assert( builder    != NULL );
+    assert( assignment != NULL );
+
+    size_t value = BuildExpression(builder, assignment->right);
+
+    AST_Node* target = assignment->left;
+    while (target->right != NULL) {
+        size_t variable = LookUp(builder, target->right->data.variable);
+        Emit(builder, IR_InstrMake(IR_OP_COPY, IR_GetValue(builder->func, variable)->type, variable,
+                                   value, IR_NO_VALUE));
+        target = target->left;
+    }
+
+    size_t variable = LookUp(builder, target->data.variable);
+    Emit(builder, IR_InstrMake(IR_OP_COPY, IR_GetValue(builder->func, variable)->type, variable, value, IR_NO_VALUE));
+}
+
+// ================================ EXPRESSIONS ================================
+
+/* returns the temporary with the value of the expression */
+static size_t BuildExpression(IR_Builder* builder, AST_Node* node) {
+    assert( builder != NULL );
+    assert( node    != NULL );
+
+    CheckType(builder, node->value_type);
+
+    if (node->type == AST_ELEM_TYPE_CONST) {
+        const ConstData* data = &node->data.constant.data;
+
+        switch (node->data.constant.type) {
+        case CONST_TYPE_SHORT:  return EmitConst(builder, data->short_const);
+        case CONST_TYPE_INT:    return EmitConst(builder, data->int_const);
+        case CONST_TYPE_LONG:   return EmitConst(builder, (int)data->long_const);
+        case CONST_TYPE_CHAR:   return EmitConst(builder, data->char_const);
+
+        case CONST_TYPE_UNDEFINED:
+        case CONST_TYPE_DOUBLE:
+        case CONST_TYPE_VOID:
+        default:
+            return EmitConst(builder, 0); // rejected by CheckType
+        }
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE) {
+        // variable is read at this point of the evaluation
+        size_t variable = LookUp(builder, node->data.variable);
+        size_t temp = NewTemp(builder, IR_GetValue(builder->func, variable)->type);
+
+        Emit(builder, IR_InstrMake(IR_OP_COPY, IR_GetValue(builder->func, variable)->type, temp,
+                                   variable, IR_NO_VALUE));
+        return temp;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        return BuildCall(builder, node);
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_SELECT)) {
+        return BuildSelect(builder, node);
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_LAND) || AST_IsOperation(node, AST_ELEM_OPERATION_LOR)) {
+        return BuildLogic(builder, node);
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_INPUT)) {
+        size_t temp = NewTemp(builder, CONST_TYPE_INT);
+        Emit(builder, IR_InstrMake(IR_OP_INPUT, CONST_TYPE_INT, temp, IR_NO_VALUE, IR_NO_VALUE));
+        return temp;
+    }
+
+    IR_Opcode opcode = node->type == AST_ELEM_TYPE_OPERATION ? BinaryOpcode(node->data.operation) : IR_OP_NOP;
+    if (opcode == IR_OP_NOP || node->left == NULL || node->right == NULL) {
+        fprintf(stderr, "IR_Build: unsupported expression in \"%s\"\n", builder->func->name);
+        builder->flag = MIDDLE_END_ERROR;
+        return EmitConst(builder, 0);
+    }
+
+    size_t left  = BuildExpression(builder, node->left);
+    size_t right = BuildExpression(builder, node->right);
+    size_t temp  = NewTemp(builder, node->value_type);
+
+    Emit(builder, IR_InstrMake(opcode, node->value_type, temp, left, right));
+
+    return temp;
+}
+
+static size_t BuildCall(IR_Builder* builder, AST_Node* call) {
+    assert( builder != NULL );
+    assert( call    != NULL );
+
+    Buffer_t* call_args = BufferInit(0, sizeof(size_t));
+    if (call_args == NULL) {
+        builder->flag = MIDDLE_END_BUFFER_FAILED;
+        return EmitConst(builder, 0);
+    }
+
+    for (AST_Node* arg = call->left; arg != NULL; arg = arg->left) {
+        size_t value = BuildExpression(builder, arg->right);
+        BufferPush(call_args, &value, sizeof(size_t));
+    }
+
+    size_t temp = NewTemp(builder, call->value_type);
+
+    IR_Instr instr = IR_InstrMake(IR_OP_CALL, call->value_type, temp, IR_NO_VALUE, IR_NO_VALUE);
+    instr.callee    = strdup(call->right->data.variable);
+    instr.call_args = call_args;
+
+    Emit(builder, instr);
+
+    return temp;
+}
+
+/*
+ * The instructions have two operands, so select is the branch again: both ways copy
+ * their value to the same temporary, which is the phi after the construction of SSA.
+ *
+ *      branch cond, then, else
+ *  then:
+ *      temp = a
+ *      jump end
+ *  else:
+ *      temp = b
+ *      jump end
+ *  end:
+ */
+static size_t BuildSelect(IR_Builder* builder, AST_Node* select) {
+    assert( builder != NULL );
+    assert( select  != NULL );
+
+    size_t condition = BuildExpression(builder, select->left);
+    size_t temp = NewTemp(builder, select->value_type);
+
+    IR_Block* branch_block = Emit(builder, IR_InstrMake(IR_OP_BRANCH, CONST_TYPE_VOID, IR_NO_VALUE,
+                                                        condition, IR_NO_VALUE));
+    IR_Block* ends[2] = {};
+
+    for (size_t i = 0; i < 2; i++) {
+        builder->block = IR_BlockAdd(builder->func);
+        IR_Terminator(branch_block)->targets[i] = builder->block->id;
+
+        size_t value = BuildExpression(builder, i == 0 ? select->right->left : select->right->right);
+        Emit(builder, IR_InstrMake(IR_OP_COPY, select->value_type, temp, value, IR_NO_VALUE));
+
+        ends[i] = EmitJump(builder, IR_NO_BLOCK);
+    }
+
+    builder->block = IR_BlockAdd(builder->func);
+
+    IR_Terminator(ends[0])->targets[0] = builder->block->id;
+    IR_Terminator(ends[1])->targets[0] = builder->block->id;
+
+    return temp;
+}
+
+/*
+ * Right operand runs only if the left one does not decide the result, as in the tree back end.
+ * The branch takes the first target for the true left operand:
+ *
+ *      branch left, right, short       (short, right for ||)
+ *  right:
+ *      temp = right != 0
+ *      jump end
+ *  short:
+ *      temp = 0                        (1 for ||)
+ *      jump end
+ *  end:
+ */
+static size_t BuildLogic(IR_Builder* builder, AST_Node* logic) {
+    assert( builder != NULL );
+    assert( logic   != NULL );
+
+    bool is_land = AST_IsOperation(logic, AST_ELEM_OPERATION_LAND);
+    size_t right_target = is_land ? 0 : 1;
+
+    size_t left = BuildExpression(builder, logic->left);
+    size_t temp = NewTemp(builder, logic->value_type);
+
+    IR_Block* branch_block = Emit(builder, IR_InstrMake(IR_OP_BRANCH, CONST_TYPE_VOID, IR_NO_VALUE,
+                                                        left, IR_NO_VALUE));
+    IR_Block* ends[2] = {};
+
+    for (size_t i = 0; i < 2; i++) {
+        builder->block = IR_BlockAdd(builder->func);
+        IR_Terminator(branch_block)->targets[i] = builder->block->id;
+
+        size_t value = IR_NO_VALUE;
+
+        if (i == right_target) {
+            size_t right = BuildExpression(builder, logic->right);
+            size_t zero  = EmitConst(builder, 0);
+
+            value = NewTemp(builder, logic->value_type);
+            Emit(builder, IR_InstrMake(IR_OP_NE, logic->value_type, value, right, zero));
+        } else {
+            value = EmitConst(builder, is_land ? 0 : 1);
+        }
+
+        Emit(builder, IR_InstrMake(IR_OP_COPY, logic->value_type, temp, value, IR_NO_VALUE));
+
+        ends[i] = EmitJump(builder, IR_NO_BLOCK);
+    }
+
+    builder->block = IR_BlockAdd(builder->func);
+
+    IR_Terminator(ends[0])->targets[0] = builder->block->id;
+    IR_Terminator(ends[1])->targets[0] = builder->block->id;
+
+    return temp;
+}
+
+// ================================== EMITTING ==================================
+
+/* returns the block, which got the instruction */
+static IR_Block* Emit(IR_Builder* builder, IR_Instr instr) {
+    assert( builder != NULL );
+
+    // code after return or break goes to an unreachable block, which is removed with the CFG
+    if (IR_Terminator(builder->block) != NULL) {
+        builder->block = IR_BlockAdd(builder->func);
+    }
+
+    if (IR_Emit(builder->block, instr) != MIDDLE_END_OK) {
+        builder->flag = MIDDLE_END_BUFFER_FAILED;
+    }
+
+    return builder->block;
+}
+
+static IR_Block* EmitJump(IR_Builder* builder, size_t target) {
+    assert( builder != NULL );
+
+    IR_Instr jump = IR_InstrMake(IR_OP_JUMP, CONST_TYPE_VOID, IR_NO_VALUE, IR_NO_VALUE, IR_NO_VALUE);
+    jump.targets[0] = target;
+
+    return Emit(builder, jump);
+}
+
+static size_t EmitConst(IR_Builder* builder, int imm) {
+    assert( builder != NULL );
+
+    size_t temp = NewTemp(builder, CONST_TYPE_INT);
+
+    IR_Instr instr = IR_InstrMake(IR_OP_CONST, CONST_TYPE_INT, temp, IR_NO_VALUE, IR_NO_VALUE);
+    instr.imm = imm;
+
+    Emit(builder, instr);
+
+    return temp;
+}
+
+static size_t NewTemp(IR_Builder* builder, ConstType type) {
+    assert( builder != NULL );
+
+    return IR_ValueAdd(builder->func, NULL, type);
+}
+
+/* integer types share the representation, immediates and the back end of IR have no doubles */
+static void CheckType(IR_Builder* builder, ConstType type) {
+    assert( builder != NULL );
+
+    if (type == CONST_TYPE_DOUBLE && builder->flag == MIDDLE_END_OK) {
+        fprintf(stderr, "IR_Build: double values are not supported in \"%s\"\n", builder->func->name);
+        builder->flag = MIDDLE_END_ERROR;
+    }
+}
+
+// =================================== NAMES ===================================
+
+static void Bind(IR_Builder* builder, const char* name, size_t value) {
+    assert( builder != NULL );
+    assert( name    != NULL );
+
+    IR_Binding binding = {
+        .name = name,
+        .value = value
+    };
+
+    BufferPush(builder->bindings, &binding, sizeof(IR_Binding));
+}
+
+static size_t LookUp(IR_Builder* builder, const char* name) {
+    assert( builder != NULL );
+    assert( name    != NULL );
+
+    IR_Binding* bindings = (IR_Binding*)builder->bindings->data;
+    for (size_t i = builder->bindings->size; i-- > 0; ) {
+        if (strcmp(bindings[i].name, name) == 0) {
+            return bindings[i].value;
+        }
+    }
+
+    if (IsGlobalName(builder->ast, name)) {
+        fprintf(stderr, "IR_Build: global variable \"%s\" in \"%s\" is not supported by the IR, "
+                        "compile without -ir\n", name, builder->func->name);
+    } else {
+        fprintf(stderr, "IR_Build: unknown variable \"%s\" in \"%s\"\n", name, builder->func->name);
+    }
+    builder->flag = MIDDLE_END_ERROR;
+
+    size_t value = IR_ValueAdd(builder->func, name, CONST_TYPE_INT);
+    Bind(builder, name, value);
+
+    return value;
+}
+
+/* IR values live in the frames of the functions, there is no storage for the globals */
+static bool IsGlobalName(const AST* ast, const char* name) {
+    assert( ast  != NULL );
+    assert( name != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsVarDec(statement) && strcmp(AST_VarDecIdentifier(statement)->data.variable, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static IR_Opcode BinaryOpcode(AST_ElemOperation operation) {
+    switch (operation) {
+    case AST_ELEM_OPERATION_ADD:    return IR_OP_ADD;
+    case AST_ELEM_OPERATION_SUB:    return IR_OP_SUB;
+    case AST_ELEM_OPERATION_MUL:    return IR_OP_MUL;
+    case AST_ELEM_OPERATION_DIV:    return IR_OP_DIV;
+
+    case AST_ELEM_OPERATION_LT:     return IR_OP_LT;
+    case AST_ELEM_OPERATION_GT:     return IR_OP_GT;
+    case AST_ELEM_OPERATION_LE:     return IR_OP_LE;
+    case AST_ELEM_OPERATION_GE:     return IR_OP_GE;
+    case AST_ELEM_OPERATION_EE:     return IR_OP_EE;
+    case AST_ELEM_OPERATION_NE:     return IR_OP_NE;
+
+    case AST_ELEM_OPERATION_UNDEFINED:
+    case AST_ELEM_OPERATION_LAND:
+    case AST_ELEM_OPERATION_LOR:
+    case AST_ELEM_OPERATION_SENTINEL:
+    case AST_ELEM_OPERATION_SELECT:
+    case AST_ELEM_OPERATION_INPUT:
+    case AST_ELEM_OPERATION_PRINT:
+    case AST_ELEM_OPERATION_ASSIGNMENT:
+    case AST_ELEM_OPERATION_IF:
+    case AST_ELEM_OPERATION_ELSE:
+    case AST_ELEM_OPERATION_WHILE:
+    case AST_ELEM_OPERATION_BREAK:
+    case AST_ELEM_OPERATION_CALL:
+    case AST_ELEM_OPERATION_RETURN:
+    default:
+        return IR_OP_NOP;
+    }
+}
@@ -0,0 +1,203 @@
+#include "../../include/middle_end/ir_dump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../../include/ast/ast_dump.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+static void DumpInstr(const IR_Function* func, const IR_Instr* instr, FILE* fp);
+static void DumpValue(const IR_Function* func, size_t value, FILE* fp);
+
+typedef struct IR_OpcodeMapping {
+    const char* string;
+    IR_Opcode opcode;
+} IR_OpcodeMapping;
+
+IR_OpcodeMapping ir_opcode_dict[] = {
+    {"nop"   ,      IR_OP_NOP   },
+
+    {"param" ,      IR_OP_PARAM },
+    {"const" ,      IR_OP_CONST },
+    {"copy"  ,      IR_OP_COPY  },
+
+    {"add"   ,      IR_OP_ADD   },
+    {"sub"   ,      IR_OP_SUB   },
+    {"mul"   ,      IR_OP_MUL   },
+    {"div"   ,      IR_OP_DIV   },
+    {"shl"   ,      IR_OP_SHL   },
+    {"shr"   ,      IR_OP_SHR   },
+
+    {"lt"    ,      IR_OP_LT    },
+    {"gt"    ,      IR_OP_GT    },
+    {"le"    ,      IR_OP_LE    },
+    {"ge"    ,      IR_OP_GE    },
+    {"ee"    ,      IR_OP_EE    },
+    {"ne"    ,      IR_OP_NE    },
+
+    {"land"  ,      IR_OP_LAND  },
+    {"lor"   ,      IR_OP_LOR   },
+
+    {"input" ,      IR_OP_INPUT },
+    {"print" ,      IR_OP_PRINT },
+    {"call"  ,      IR_OP_CALL  },
+    {"phi"   ,      IR_OP_PHI   },
+
+    {"jump"  ,      IR_OP_JUMP  },
+    {"br"    ,      IR_OP_BRANCH},
+    {"ret"   ,      IR_OP_RETURN}
+};
+
+size_t ir_opcode_dict_size = sizeof(ir_opcode_dict)/sizeof(IR_OpcodeMapping);
+
+const char* IR_GetStrOpcode(IR_Opcode opcode) {
+    for (size_t i = 0; i < ir_opcode_dict_size; i++) {
+        if (ir_opcode_dict[i].opcode == opcode) {
+            return ir_opcode_dict[i].string;
+        }
+    }
+
+    return "unknown";
+}
+
+MiddleEndErr_t IR_Dump(const IR_Module* module, const char* file_name) {
+    assert( module    != NULL );
+    assert( file_name != NULL );
+
+    FILE* fp = fopen(file_name, "w");
+    if (fp == NULL) {
+        return MIDDLE_END_ERROR;
+    }
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        IR_DumpFunction(functions[i], fp);
+    }
+
+    fclose(fp);
+
+    return MIDDLE_END_OK;
+}
+
+/*
+ * func fact(1 params):
+ * bb0:                             ; preds:
+ *     %n.0 = int param 0
+ *     ...
+ */
+void IR_DumpFunction(const IR_Function* func, FILE* fp) {
+    assert( func != NULL );
+    assert( fp   != NULL );
+
+    fprintf(fp, "func %s(%lu params)%s:\n", func->name, func->param_cnt, func->is_ssa ? " ssa" : "");
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        fprintf(fp, "bb%lu:\t\t\t\t; preds:", block->id);
+
+        const size_t* preds = (const size_t*)block->preds->data;
+        for (size_t j = 0; j < block->preds->size; j++) {
+            fprintf(fp, " bb%lu", preds[j]);
+        }
+        fprintf(fp, "\n");
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            DumpInstr(func, IR_GetInstr(block, j), fp);
+        }
+    }
+
+    fprintf(fp, "\n");
+}
+
+static void DumpInstr(const IR_Function* func, const IR_Instr* instr, FILE* fp) {
+    assert( func  != NULL );
+    assert( instr != NULL );
+    assert( fp    != NULL );
+
+    fprintf(fp, "    ");
+
+    if (instr->dst != IR_NO_VALUE) {
+        DumpValue(func, instr->dst, fp);
+        fprintf(fp, " = %s ", GetStrConst(instr->type));
+    }
+
+    fprintf(fp, "%s", IR_GetStrOpcode(instr->opcode));
+
+    switch (instr->opcode) {
+    case IR_OP_PARAM:
+    case IR_OP_CONST:
+        fprintf(fp, " %d", instr->imm);
+        break;
+
+    case IR_OP_CALL: {
+        fprintf(fp, " %s(", instr->callee);
+
+        const size_t* call_args = (const size_t*)instr->call_args->data;
+        for (size_t i = 0; i < instr->call_args->size; i++) {
+            fprintf(fp, i == 0 ? "" : ", ");
+            DumpValue(func, call_args[i], fp);
+        }
+
+        fprintf(fp, ")");
+        break;
+    }
+
+    case IR_OP_PHI: {
+        const IR_PhiArg* phi_args = (const IR_PhiArg*)instr->phi_args->data;
+        for (size_t i = 0; i < instr->phi_args->size; i++) {
+            fprintf(fp, i == 0 ? " [bb%lu: " : ", [bb%lu: ", phi_args[i].block);
+            DumpValue(func, phi_args[i].value, fp);
+            fprintf(fp, "]");
+        }
+        break;
+    }
+
+    case IR_OP_NOP:
+    case IR_OP_COPY:
+    case IR_OP_ADD:
+    case IR_OP_SUB:
+    case IR_OP_MUL:
+    case IR_OP_DIV:
+    case IR_OP_SHL:
+    case IR_OP_SHR:
+    case IR_OP_LT:
+    case IR_OP_GT:
+    case IR_OP_LE:
+    case IR_OP_GE:
+    case IR_OP_EE:
+    case IR_OP_NE:
+    case IR_OP_LAND:
+    case IR_OP_LOR:
+    case IR_OP_INPUT:
+    case IR_OP_PRINT:
+    case IR_OP_JUMP:
+    case IR_OP_BRANCH:
+    case IR_OP_RETURN:
+    default:
+        for (size_t i = 0; i < 2 && instr->args[i] != IR_NO_VALUE; i++) {
+            fprintf(fp, i == 0 ? " " : ", ");
+            DumpValue(func, instr->args[i], fp);
+        }
+        break;
+    }
+
+    for (size_t i = 0; i < IR_SuccCount(instr); i++) {
+        fprintf(fp, i == 0 && instr->args[0] == IR_NO_VALUE ? " bb%lu" : ", bb%lu", instr->targets[i]);
+    }
+
+    fprintf(fp, "\n");
+}
+
+static void DumpValue(const IR_Function* func, size_t value, FILE* fp) {
+    assert( func != NULL );
+    assert( fp   != NULL );
+
+    const char* name = IR_GetValue(func, value)->name;
+    if (name != NULL) {
+        fprintf(fp, "%%%s.%lu", name, value);
+    } else {
+        fprintf(fp, "%%%lu", value);
+    }
+}
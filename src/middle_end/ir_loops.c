@@ -0,0 +1,155 @@
+#include "../../include/middle_end/ir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+static MiddleEndErr_t AddLoopBody(IR_Function* func, IR_Loop* loop, size_t latch);
+static int LoopSizeCmp(const void* a, const void* b);
+
+/* edge to the dominator is the back edge, loops with the same header are merged, inner loops go first */
+MiddleEndErr_t IR_FindLoops(IR_Function* func, Buffer_t* loops) {
+    assert( func  != NULL );
+    assert( loops != NULL );
+
+    MiddleEndErr_t flag = IR_ComputeDominators(func);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+        const size_t* succs = (const size_t*)block->succs->data;
+
+        for (size_t j = 0; j < block->succs->size; j++) {
+            if (!IR_Dominates(func, succs[j], i)) {
+                continue;
+            }
+
+            IR_Loop* loop_array = (IR_Loop*)loops->data;
+            IR_Loop* loop = NULL;
+
+            for (size_t k = 0; k < loops->size; k++) {
+                if (loop_array[k].header == succs[j]) {
+                    loop = &loop_array[k];
+                }
+            }
+
+            if (loop == NULL) {
+                IR_Loop new_loop = {
+                    .header = succs[j],
+                    .body   = (bool*)calloc(IR_BlockCount(func), sizeof(bool)),
+                    .size   = 1
+                };
+
+                if (new_loop.body == NULL || BufferPush(loops, &new_loop, sizeof(IR_Loop)) != BUFFER_OK) {
+                    free(new_loop.body);
+                    return MIDDLE_END_BUFFER_FAILED;
+                }
+
+                loop = &((IR_Loop*)loops->data)[loops->size - 1];
+                loop->body[loop->header] = true;
+            }
+
+            flag = AddLoopBody(func, loop, i);
+            if (flag != MIDDLE_END_OK) {
+                return flag;
+            }
+        }
+    }
+
+    // function without loops has no data to sort
+    if (loops->size > 1) {
+        qsort(loops->data, loops->size, sizeof(IR_Loop), LoopSizeCmp);
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* blocks, which reach the latch without passing the header */
+static MiddleEndErr_t AddLoopBody(IR_Function* func, IR_Loop* loop, size_t latch) {
+    assert( func != NULL );
+    assert( loop != NULL );
+
+    Buffer_t* work = BufferInit(0, sizeof(size_t));
+    if (work == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    if (!loop->body[latch]) {
+        loop->body[latch] = true;
+        loop->size++;
+        BufferPush(work, &latch, sizeof(size_t));
+    }
+
+    while (work->size != 0) {
+        IR_Block* block = IR_GetBlock(func, ((size_t*)work->data)[--work->size]);
+        const size_t* preds = (const size_t*)block->preds->data;
+
+        for (size_t i = 0; i < block->preds->size; i++) {
+            if (!loop->body[preds[i]]) {
+                loop->body[preds[i]] = true;
+                loop->size++;
+                BufferPush(work, &preds[i], sizeof(size_t));
+            }
+        }
+    }
+
+    BufferDestroy(&work);
+
+    return MIDDLE_END_OK;
+}
+
+/* the only predecessor out of the loop, which always goes to the header */
+size_t IR_LoopPreheader(const IR_Function* func, const IR_Loop* loop) {
+    assert( func != NULL );
+    assert( loop != NULL );
+
+    IR_Block* header = IR_GetBlock(func, loop->header);
+    const size_t* preds = (const size_t*)header->preds->data;
+
+    size_t preheader = IR_NO_BLOCK;
+
+    for (size_t i = 0; i < header->preds->size; i++) {
+        if (loop->body[preds[i]]) {
+            continue;
+        }
+        if (preheader != IR_NO_BLOCK) {
+            return IR_NO_BLOCK;
+        }
+
+        preheader = preds[i];
+    }
+
+    if (preheader == IR_NO_BLOCK || IR_GetBlock(func, preheader)->succs->size != 1) {
+        return IR_NO_BLOCK;
+    }
+
+    return preheader;
+}
+
+
+static int LoopSizeCmp(const void* a, const void* b) {
+    assert( a != NULL );
+    assert( b != NULL );
+
+    size_t size_a = ((const IR_Loop*)a)->size;
+    size_t size_b = ((const IR_Loop*)b)->size;
+
+    return (size_a > size_b) - (size_a < size_b);
+}
+
+void IR_LoopsDestroy(Buffer_t** loops) {
+    assert( loops  != NULL );
+    assert( *loops != NULL );
+
+    IR_Loop* loop_array = (IR_Loop*)(*loops)->data;
+    for (size_t i = 0; i < (*loops)->size; i++) {
+        FREE(loop_array[i].body);
+    }
+
+    BufferDestroy(loops);
+}
@@ -0,0 +1,720 @@
+#include "../../include/middle_end/ir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct SSA_Renamer {
+    IR_Function* func;
+    size_t var_cnt;             // values before the construction
+    bool* is_var;               // value is defined more than once and needs renaming
+    Buffer_t** stacks;          // size_t, current names of each variable
+    size_t* undefined;          // zero, which is read before any definition of the variable
+    Buffer_t** dom_children;    // size_t
+} SSA_Renamer;
+
+typedef struct SSA_Copy {
+    size_t dst;
+    size_t src;
+    ConstType type;
+} SSA_Copy;
+
+static MiddleEndErr_t ComputeFrontiers(IR_Function* func, Buffer_t** frontiers);
+static MiddleEndErr_t InsertPhis(IR_Function* func, const bool* is_var, Buffer_t** frontiers);
+static MiddleEndErr_t InsertVarPhis(IR_Function* func, size_t var, Buffer_t** frontiers, bool* has_phi, bool* in_work);
+
+static MiddleEndErr_t RenameBlock(SSA_Renamer* renamer, size_t id);
+static size_t CurrentName(SSA_Renamer* renamer, size_t var);
+static MiddleEndErr_t InsertUndefined(SSA_Renamer* renamer);
+static MiddleEndErr_t RemoveDeadPhis(IR_Function* func);
+
+static MiddleEndErr_t SplitCriticalEdges(IR_Function* func);
+static MiddleEndErr_t LowerPhis(IR_Function* func, IR_Block* block);
+static MiddleEndErr_t SequentializeCopies(IR_Function* func, IR_Block* pred, Buffer_t* copies);
+
+static Buffer_t** BufferArrayInit(size_t cnt, size_t elem_size);
+static void BufferArrayDestroy(Buffer_t** buffers, size_t cnt);
+
+MiddleEndErr_t IR_ModuleToSSA(IR_Module* module) {
+    assert( module != NULL );
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        MiddleEndErr_t flag = IR_ConstructSSA(functions[i]);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+MiddleEndErr_t IR_ModuleFromSSA(IR_Module* module) {
+    assert( module != NULL );
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        MiddleEndErr_t flag = IR_DestructSSA(functions[i]);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ================================ CONSTRUCTION ================================
+
+/*
+ * Cytron et al.: phis of each variable go to the iterated dominance frontier of its definitions,
+ * then the dominator tree walk gives every definition its own value.
+ * Values with a single definition already are in SSA form and keep their numbers.
+ */
+MiddleEndErr_t IR_ConstructSSA(IR_Function* func) {
+    assert( func != NULL );
+
+    if (func->is_ssa) {
+        return MIDDLE_END_OK;
+    }
+
+    MiddleEndErr_t flag = IR_BuildCFG(func);
+    if (flag == MIDDLE_END_OK) {
+        flag = IR_ComputeDominators(func);
+    }
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t block_cnt = IR_BlockCount(func);
+    size_t var_cnt   = IR_ValueCount(func);
+
+    SSA_Renamer renamer = {
+        .func         = func,
+        .var_cnt      = var_cnt,
+        .is_var       = (bool*)  calloc(var_cnt + 1, sizeof(bool)),
+        .stacks       = BufferArrayInit(var_cnt, sizeof(size_t)),
+        .undefined    = (size_t*)calloc(var_cnt + 1, sizeof(size_t)),
+        .dom_children = BufferArrayInit(block_cnt, sizeof(size_t))
+    };
+
+    size_t*    def_cnt   = (size_t*)calloc(var_cnt + 1, sizeof(size_t));
+    Buffer_t** frontiers = BufferArrayInit(block_cnt, sizeof(size_t));
+
+    if (    renamer.is_var == NULL || renamer.stacks == NULL || renamer.undefined == NULL
+         || renamer.dom_children == NULL || def_cnt == NULL || frontiers == NULL ) {
+        flag = MIDDLE_END_BUFFER_FAILED;
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        for (size_t i = 0; i < block_cnt; i++) {
+            IR_Block* block = IR_GetBlock(func, i);
+
+            for (size_t j = 0; j < IR_InstrCount(block); j++) {
+                size_t dst = IR_GetInstr(block, j)->dst;
+                if (dst != IR_NO_VALUE && ++def_cnt[dst] > 1) {
+                    renamer.is_var[dst] = true;
+                }
+            }
+
+            if (i != 0) {
+                BufferPush(renamer.dom_children[block->idom], &block->id, sizeof(size_t));
+            }
+        }
+
+        for (size_t i = 0; i < var_cnt; i++) {
+            renamer.undefined[i] = IR_NO_VALUE;
+        }
+
+        flag = ComputeFrontiers(func, frontiers);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = InsertPhis(func, renamer.is_var, frontiers);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = RenameBlock(&renamer, 0);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = InsertUndefined(&renamer);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = RemoveDeadPhis(func);
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        func->is_ssa = true;
+    }
+
+    FREE(renamer.is_var);
+    FREE(renamer.undefined);
+    FREE(def_cnt);
+    BufferArrayDestroy(renamer.stacks, var_cnt);
+    BufferArrayDestroy(renamer.dom_children, block_cnt);
+    BufferArrayDestroy(frontiers, block_cnt);
+
+    return flag;
+}
+
+/* Cooper, Harvey, Kennedy: join points are in the frontier of every block on the way up to their idom */
+static MiddleEndErr_t ComputeFrontiers(IR_Function* func, Buffer_t** frontiers) {
+    assert( func      != NULL );
+    assert( frontiers != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+        if (block->preds->size < 2) {
+            continue;
+        }
+
+        const size_t* preds = (const size_t*)block->preds->data;
+        for (size_t j = 0; j < block->preds->size; j++) {
+            size_t runner = preds[j];
+
+            while (runner != block->idom) {
+                Buffer_t* frontier = frontiers[runner];
+
+                size_t* ids = (size_t*)frontier->data;
+                if (frontier->size == 0 || ids[frontier->size - 1] != block->id) {
+                    if (BufferPush(frontier, &block->id, sizeof(size_t)) != BUFFER_OK) {
+                        return MIDDLE_END_BUFFER_FAILED;
+                    }
+                }
+
+                runner = IR_GetBlock(func, runner)->idom;
+            }
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t InsertPhis(IR_Function* func, const bool* is_var, Buffer_t** frontiers) {
+    assert( func      != NULL );
+    assert( is_var    != NULL );
+    assert( frontiers != NULL );
+
+    size_t block_cnt = IR_BlockCount(func);
+
+    bool* has_phi = (bool*)calloc(block_cnt, sizeof(bool));
+    bool* in_work = (bool*)calloc(block_cnt, sizeof(bool));
+    if (has_phi == NULL || in_work == NULL) {
+        free(has_phi);
+        free(in_work);
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    for (size_t var = 0; var < IR_ValueCount(func) && flag == MIDDLE_END_OK; var++) {
+        if (is_var[var]) {
+            memset(has_phi, 0, block_cnt * sizeof(bool));
+            memset(in_work, 0, block_cnt * sizeof(bool));
+
+            flag = InsertVarPhis(func, var, frontiers, has_phi, in_work);
+        }
+    }
+
+    FREE(has_phi);
+    FREE(in_work);
+
+    return flag;
+}
+
+/* phi keeps the variable in args[0] until the renaming */
+static MiddleEndErr_t InsertVarPhis(IR_Function* func, size_t var, Buffer_t** frontiers, bool* has_phi, bool* in_work) {
+    assert( func      != NULL );
+    assert( frontiers != NULL );
+    assert( has_phi   != NULL );
+    assert( in_work   != NULL );
+
+    Buffer_t* work = BufferInit(0, sizeof(size_t));
+    if (work == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            if (IR_GetInstr(block, j)->dst == var) {
+                in_work[i] = true;
+                BufferPush(work, &block->id, sizeof(size_t));
+                break;
+            }
+        }
+    }
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    while (work->size != 0 && flag == MIDDLE_END_OK) {
+        size_t id = ((size_t*)work->data)[--work->size];
+
+        const size_t* frontier = (const size_t*)frontiers[id]->data;
+        for (size_t i = 0; i < frontiers[id]->size && flag == MIDDLE_END_OK; i++) {
+            size_t join = frontier[i];
+            if (has_phi[join]) {
+                continue;
+            }
+
+            IR_Instr phi = IR_InstrMake(IR_OP_PHI, IR_GetValue(func, var)->type, var, var, IR_NO_VALUE);
+            phi.phi_args = BufferInit(0, sizeof(IR_PhiArg));
+
+            if (phi.phi_args == NULL || IR_Insert(IR_GetBlock(func, join), 0, phi) != MIDDLE_END_OK) {
+                flag = MIDDLE_END_BUFFER_FAILED;
+                break;
+            }
+
+            has_phi[join] = true;
+
+            if (!in_work[join]) {
+                in_work[join] = true;
+                BufferPush(work, &join, sizeof(size_t));
+            }
+        }
+    }
+
+    BufferDestroy(&work);
+
+    return flag;
+}
+
+static MiddleEndErr_t RenameBlock(SSA_Renamer* renamer, size_t id) {
+    assert( renamer != NULL );
+
+    IR_Function* func = renamer->func;
+    IR_Block* block = IR_GetBlock(func, id);
+
+    size_t* saved_sizes = (size_t*)calloc(renamer->var_cnt + 1, sizeof(size_t));
+    if (saved_sizes == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    for (size_t var = 0; var < renamer->var_cnt; var++) {
+        saved_sizes[var] = renamer->stacks[var]->size;
+    }
+
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < IR_InstrCount(block); i++) {
+        IR_Instr* instr = IR_GetInstr(block, i);
+
+        if (instr->opcode != IR_OP_PHI) {
+            for (size_t j = 0; j < IR_OperandCount(instr); j++) {
+                size_t* operand = IR_Operand(instr, j);
+                if (*operand < renamer->var_cnt && renamer->is_var[*operand]) {
+                    *operand = CurrentName(renamer, *operand);
+                }
+            }
+        }
+
+        if (instr->dst != IR_NO_VALUE && instr->dst < renamer->var_cnt && renamer->is_var[instr->dst]) {
+            size_t var = instr->dst;
+            IR_Value* value = IR_GetValue(func, var);
+
+            char* name = value->name != NULL ? strdup(value->name) : NULL;
+            instr->dst = IR_ValueAdd(func, name, value->type);
+            FREE(name);
+
+            if (BufferPush(renamer->stacks[var], &instr->dst, sizeof(size_t)) != BUFFER_OK) {
+                flag = MIDDLE_END_BUFFER_FAILED;
+            }
+        }
+    }
+
+    const size_t* succs = (const size_t*)block->succs->data;
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < block->succs->size; i++) {
+        IR_Block* succ = IR_GetBlock(func, succs[i]);
+
+        for (size_t j = 0; j < IR_InstrCount(succ) && IR_GetInstr(succ, j)->opcode == IR_OP_PHI; j++) {
+            IR_Instr* phi = IR_GetInstr(succ, j);
+
+            IR_PhiArg arg = {
+                .block = id,
+                .value = CurrentName(renamer, phi->args[0])
+            };
+
+            if (BufferPush(phi->phi_args, &arg, sizeof(IR_PhiArg)) != BUFFER_OK) {
+                flag = MIDDLE_END_BUFFER_FAILED;
+                break;
+            }
+        }
+    }
+
+    const size_t* children = (const size_t*)renamer->dom_children[id]->data;
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < renamer->dom_children[id]->size; i++) {
+        flag = RenameBlock(renamer, children[i]);
+    }
+
+    for (size_t var = 0; var < renamer->var_cnt; var++) {
+        renamer->stacks[var]->size = saved_sizes[var];
+    }
+
+    FREE(saved_sizes);
+
+    return flag;
+}
+
+static size_t CurrentName(SSA_Renamer* renamer, size_t var) {
+    assert( renamer != NULL );
+    assert( var < renamer->var_cnt );
+
+    Buffer_t* stack = renamer->stacks[var];
+    if (stack->size != 0) {
+        return ((size_t*)stack->data)[stack->size - 1];
+    }
+
+    if (renamer->undefined[var] == IR_NO_VALUE) {
+        renamer->undefined[var] = IR_ValueAdd(renamer->func, NULL, IR_GetValue(renamer->func, var)->type);
+    }
+
+    return renamer->undefined[var];
+}
+
+/* zeros for the variables read before definition go to the entry after the parameters */
+static MiddleEndErr_t InsertUndefined(SSA_Renamer* renamer) {
+    assert( renamer != NULL );
+
+    IR_Block* entry = IR_GetBlock(renamer->func, 0);
+
+    size_t idx = 0;
+    while (idx < IR_InstrCount(entry) && IR_GetInstr(entry, idx)->opcode == IR_OP_PARAM) {
+        ++idx;
+    }
+
+    for (size_t var = 0; var < renamer->var_cnt; var++) {
+        if (renamer->undefined[var] == IR_NO_VALUE) {
+            continue;
+        }
+
+        IR_Instr zero = IR_InstrMake(IR_OP_CONST, IR_GetValue(renamer->func, var)->type,
+                                     renamer->undefined[var], IR_NO_VALUE, IR_NO_VALUE);
+
+        if (IR_Insert(entry, idx, zero) != MIDDLE_END_OK) {
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* phi is alive, if its value reaches an instruction other than phi */
+static MiddleEndErr_t RemoveDeadPhis(IR_Function* func) {
+    assert( func != NULL );
+
+    size_t value_cnt = IR_ValueCount(func);
+
+    bool*      live     = (bool*)     calloc(value_cnt + 1, sizeof(bool));
+    IR_Instr** phi_defs = (IR_Instr**)calloc(value_cnt + 1, sizeof(IR_Instr*));
+    Buffer_t*  work     = BufferInit(0, sizeof(size_t));
+    if (live == NULL || phi_defs == NULL || work == NULL) {
+        free(live);
+        free(phi_defs);
+        if (work != NULL) {
+            BufferDestroy(&work);
+        }
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            if (instr->opcode == IR_OP_PHI) {
+                phi_defs[instr->dst] = instr;
+                continue;
+            }
+
+            for (size_t k = 0; k < IR_OperandCount(instr); k++) {
+                size_t operand = *IR_Operand(instr, k);
+                if (!live[operand]) {
+                    live[operand] = true;
+                    BufferPush(work, &operand, sizeof(size_t));
+                }
+            }
+        }
+    }
+
+    while (work->size != 0) {
+        size_t value = ((size_t*)work->data)[--work->size];
+
+        IR_Instr* phi = phi_defs[value];
+        if (phi == NULL) {
+            continue;
+        }
+
+        const IR_PhiArg* phi_args = (const IR_PhiArg*)phi->phi_args->data;
+        for (size_t i = 0; i < phi->phi_args->size; i++) {
+            if (!live[phi_args[i].value]) {
+                live[phi_args[i].value] = true;
+                BufferPush(work, &phi_args[i].value, sizeof(size_t));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            if (instr->opcode == IR_OP_PHI) {
+                if (live[instr->dst]) {
+                    instr->args[0] = IR_NO_VALUE; // variable is not needed after the renaming
+                } else {
+                    IR_InstrClear(instr);
+                }
+            }
+        }
+    }
+
+    IR_RemoveNops(func);
+
+    FREE(live);
+    FREE(phi_defs);
+    BufferDestroy(&work);
+
+    return MIDDLE_END_OK;
+}
+
+// ================================ DESTRUCTION ================================
+
+/* phis become copies at the ends of the predecessors */
+MiddleEndErr_t IR_DestructSSA(IR_Function* func) {
+    assert( func != NULL );
+
+    if (!func->is_ssa) {
+        return MIDDLE_END_OK;
+    }
+
+    MiddleEndErr_t flag = SplitCriticalEdges(func);
+
+    for (size_t i = 0; i < IR_BlockCount(func) && flag == MIDDLE_END_OK; i++) {
+        flag = LowerPhis(func, IR_GetBlock(func, i));
+    }
+
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    IR_RemoveNops(func);
+    func->is_ssa = false;
+
+    return IR_BuildCFG(func);
+}
+
+/* copies for the join must not run on the other edge of a branch */
+static MiddleEndErr_t SplitCriticalEdges(IR_Function* func) {
+    assert( func != NULL );
+
+    MiddleEndErr_t flag = IR_BuildCFG(func);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t block_cnt = IR_BlockCount(func);
+
+    for (size_t i = 0; i < block_cnt; i++) {
+        IR_Instr* terminator = IR_Terminator(IR_GetBlock(func, i));
+        if (terminator == NULL || terminator->opcode != IR_OP_BRANCH) {
+            continue;
+        }
+
+        for (size_t j = 0; j < 2; j++) {
+            IR_Block* succ = IR_GetBlock(func, terminator->targets[j]);
+            if (    succ->preds->size < 2 || IR_InstrCount(succ) == 0
+                 || IR_GetInstr(succ, 0)->opcode != IR_OP_PHI ) {
+                continue;
+            }
+
+            IR_Block* edge = IR_BlockAdd(func);
+            if (edge == NULL) {
+                return MIDDLE_END_BUFFER_FAILED;
+            }
+
+            IR_Instr jump = IR_InstrMake(IR_OP_JUMP, CONST_TYPE_VOID, IR_NO_VALUE, IR_NO_VALUE, IR_NO_VALUE);
+            jump.targets[0] = succ->id;
+            IR_Emit(edge, jump);
+
+            for (size_t k = 0; k < IR_InstrCount(succ) && IR_GetInstr(succ, k)->opcode == IR_OP_PHI; k++) {
+                IR_Instr* phi = IR_GetInstr(succ, k);
+
+                IR_PhiArg* phi_args = (IR_PhiArg*)phi->phi_args->data;
+                for (size_t l = 0; l < phi->phi_args->size; l++) {
+                    if (phi_args[l].block == i) {
+                        phi_args[l].block = edge->id;
+                    }
+                }
+            }
+
+            if (terminator->targets[1 - j] == succ->id) {
+                terminator->targets[1 - j] = edge->id;
+            }
+            terminator->targets[j] = edge->id;
+        }
+    }
+
+    return IR_BuildCFG(func);
+}
+
+/* copies of one predecessor run in parallel */
+static MiddleEndErr_t LowerPhis(IR_Function* func, IR_Block* block) {
+    assert( func  != NULL );
+    assert( block != NULL );
+
+    size_t phi_cnt = 0;
+    while (phi_cnt < IR_InstrCount(block) && IR_GetInstr(block, phi_cnt)->opcode == IR_OP_PHI) {
+        ++phi_cnt;
+    }
+
+    if (phi_cnt == 0) {
+        return MIDDLE_END_OK;
+    }
+
+    Buffer_t* copies = BufferInit(0, sizeof(SSA_Copy));
+    if (copies == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    const size_t* preds = (const size_t*)block->preds->data;
+    for (size_t i = 0; i < block->preds->size && flag == MIDDLE_END_OK; i++) {
+        copies->size = 0;
+
+        for (size_t j = 0; j < phi_cnt; j++) {
+            IR_Instr* phi = IR_GetInstr(block, j);
+            const IR_PhiArg* phi_args = (const IR_PhiArg*)phi->phi_args->data;
+
+            SSA_Copy copy = {
+                .dst  = phi->dst,
+                .src  = IR_NO_VALUE,
+                .type = phi->type
+            };
+
+            for (size_t k = 0; k < phi->phi_args->size; k++) {
+                if (phi_args[k].block == preds[i]) {
+                    copy.src = phi_args[k].value;
+                }
+            }
+
+            if (copy.src == IR_NO_VALUE) {
+                flag = MIDDLE_END_ERROR;
+                break;
+            }
+
+            if (copy.src != copy.dst) {
+                BufferPush(copies, &copy, sizeof(SSA_Copy));
+            }
+        }
+
+        if (flag == MIDDLE_END_OK) {
+            flag = SequentializeCopies(func, IR_GetBlock(func, preds[i]), copies);
+        }
+    }
+
+    BufferDestroy(&copies);
+
+    for (size_t i = 0; i < phi_cnt; i++) {
+        IR_InstrClear(IR_GetInstr(block, i));
+    }
+
+    return flag;
+}
+
+/*
+ * Copy goes first, if no other copy reads its destination.
+ * Only a cycle of copies, like a swap, needs the temporary.
+ */
+static MiddleEndErr_t SequentializeCopies(IR_Function* func, IR_Block* pred, Buffer_t* copies) {
+    assert( func   != NULL );
+    assert( pred   != NULL );
+    assert( copies != NULL );
+
+    SSA_Copy* pending = (SSA_Copy*)copies->data;
+
+    while (copies->size != 0) {
+        size_t ready = IR_NO_VALUE;
+
+        for (size_t i = 0; i < copies->size && ready == IR_NO_VALUE; i++) {
+            ready = i;
+
+            for (size_t j = 0; j < copies->size; j++) {
+                if (j != i && pending[j].src == pending[i].dst) {
+                    ready = IR_NO_VALUE;
+                    break;
+                }
+            }
+        }
+
+        IR_Instr copy = IR_InstrMake(IR_OP_COPY, CONST_TYPE_VOID, IR_NO_VALUE, IR_NO_VALUE, IR_NO_VALUE);
+
+        if (ready != IR_NO_VALUE) {
+            copy.type    = pending[ready].type;
+            copy.dst     = pending[ready].dst;
+            copy.args[0] = pending[ready].src;
+
+            pending[ready] = pending[--copies->size];
+        } else {
+            // the old value of the first destination is saved for its readers
+            size_t temp = IR_ValueAdd(func, NULL, pending[0].type);
+
+            copy.type    = pending[0].type;
+            copy.dst     = temp;
+            copy.args[0] = pending[0].dst;
+
+            for (size_t i = 0; i < copies->size; i++) {
+                if (pending[i].src == copy.args[0]) {
+                    pending[i].src = temp;
+                }
+            }
+        }
+
+        if (IR_Insert(pred, IR_InstrCount(pred) - 1, copy) != MIDDLE_END_OK) {
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ==================================== UTILS ====================================
+
+static Buffer_t** BufferArrayInit(size_t cnt, size_t elem_size) {
+    Buffer_t** buffers = (Buffer_t**)calloc(cnt + 1, sizeof(Buffer_t*));
+    if (buffers == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < cnt; i++) {
+        buffers[i] = BufferInit(0, elem_size);
+        if (buffers[i] == NULL) {
+            BufferArrayDestroy(buffers, i);
+            return NULL;
+        }
+    }
+
+    return buffers;
+}
+
+static void BufferArrayDestroy(Buffer_t** buffers, size_t cnt) {
+    if (buffers == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < cnt; i++) {
+        if (buffers[i] != NULL) {
+            BufferDestroy(&buffers[i]);
+        }
+    }
+
+    FREE(buffers);
+}
@@ -0,0 +1,290 @@
+#include "../../include/middle_end/ir.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct IR_DefSite {
+    size_t block;
+    size_t idx;
+} IR_DefSite;
+
+static MiddleEndErr_t VerifyFunction(const IR_Module* module, IR_Function* func);
+static MiddleEndErr_t VerifyBlock(const IR_Module* module, IR_Function* func, IR_Block* block);
+static MiddleEndErr_t VerifyPhi(const IR_Function* func, const IR_Block* block, const IR_Instr* phi);
+static MiddleEndErr_t VerifySSA(IR_Function* func);
+static bool IsPred(const IR_Block* block, size_t pred);
+static MiddleEndErr_t Fail(const IR_Function* func, size_t block, const char* message);
+
+/* checks the structure of every function, in SSA form also the single definition of each value */
+MiddleEndErr_t IR_Verify(const IR_Module* module) {
+    assert( module != NULL );
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        MiddleEndErr_t flag = VerifyFunction(module, functions[i]);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t VerifyFunction(const IR_Module* module, IR_Function* func) {
+    assert( module != NULL );
+    assert( func   != NULL );
+
+    if (IR_BlockCount(func) == 0) {
+        return Fail(func, IR_NO_BLOCK, "function without blocks");
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func); i++) {
+        MiddleEndErr_t flag = VerifyBlock(module, func, IR_GetBlock(func, i));
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    if (func->is_ssa) {
+        return VerifySSA(func);
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t VerifyBlock(const IR_Module* module, IR_Function* func, IR_Block* block) {
+    assert( module != NULL );
+    assert( func   != NULL );
+    assert( block  != NULL );
+
+    size_t value_cnt = IR_ValueCount(func);
+    size_t instr_cnt = IR_InstrCount(block);
+
+    if (IR_Terminator(block) == NULL) {
+        return Fail(func, block->id, "block does not end with a terminator");
+    }
+
+    bool phis_allowed = true;
+
+    for (size_t i = 0; i < instr_cnt; i++) {
+        IR_Instr* instr = IR_GetInstr(block, i);
+
+        if (IR_IsTerminator(instr->opcode) && i != instr_cnt - 1) {
+            return Fail(func, block->id, "terminator in the middle of the block");
+        }
+
+        for (size_t j = 0; j < IR_SuccCount(instr); j++) {
+            if (instr->targets[j] >= IR_BlockCount(func)) {
+                return Fail(func, block->id, "jump to the unknown block");
+            }
+        }
+
+        if (instr->dst != IR_NO_VALUE && instr->dst >= value_cnt) {
+            return Fail(func, block->id, "unknown destination value");
+        }
+
+        for (size_t j = 0; j < IR_OperandCount(instr); j++) {
+            if (*IR_Operand(instr, j) >= value_cnt) {
+                return Fail(func, block->id, "unknown operand value");
+            }
+        }
+
+        switch (instr->opcode) {
+        case IR_OP_PHI: {
+            if (!phis_allowed) {
+                return Fail(func, block->id, "phi after the ordinary instruction");
+            }
+
+            MiddleEndErr_t flag = VerifyPhi(func, block, instr);
+            if (flag != MIDDLE_END_OK) {
+                return flag;
+            }
+            break;
+        }
+
+        case IR_OP_CALL: {
+            const IR_Function* callee = IR_FindFunction(module, instr->callee);
+            if (callee == NULL) {
+                return Fail(func, block->id, "call of the unknown function");
+            }
+            if (callee->param_cnt != instr->call_args->size) {
+                return Fail(func, block->id, "wrong number of call arguments");
+            }
+            break;
+        }
+
+        case IR_OP_PARAM:
+            if (block->id != 0 || instr->imm < 0 || (size_t)instr->imm >= func->param_cnt) {
+                return Fail(func, block->id, "bad parameter");
+            }
+            break;
+
+        case IR_OP_NOP:
+        case IR_OP_CONST:
+        case IR_OP_COPY:
+        case IR_OP_ADD:
+        case IR_OP_SUB:
+        case IR_OP_MUL:
+        case IR_OP_DIV:
+        case IR_OP_SHL:
+        case IR_OP_SHR:
+        case IR_OP_LT:
+        case IR_OP_GT:
+        case IR_OP_LE:
+        case IR_OP_GE:
+        case IR_OP_EE:
+        case IR_OP_NE:
+        case IR_OP_LAND:
+        case IR_OP_LOR:
+        case IR_OP_INPUT:
+        case IR_OP_PRINT:
+        case IR_OP_JUMP:
+        case IR_OP_BRANCH:
+        case IR_OP_RETURN:
+        default:
+            break;
+        }
+
+        if (instr->opcode != IR_OP_PHI) {
+            phis_allowed = false;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* one argument for every predecessor */
+static MiddleEndErr_t VerifyPhi(const IR_Function* func, const IR_Block* block, const IR_Instr* phi) {
+    assert( func  != NULL );
+    assert( block != NULL );
+    assert( phi   != NULL );
+
+    if (!func->is_ssa) {
+        return Fail(func, block->id, "phi out of SSA form");
+    }
+
+    if (phi->phi_args->size != block->preds->size) {
+        return Fail(func, block->id, "phi arguments do not match the predecessors");
+    }
+
+    const IR_PhiArg* phi_args = (const IR_PhiArg*)phi->phi_args->data;
+    for (size_t i = 0; i < phi->phi_args->size; i++) {
+        if (!IsPred(block, phi_args[i].block) || phi_args[i].value >= IR_ValueCount(func)) {
+            return Fail(func, block->id, "bad phi argument");
+        }
+
+        for (size_t j = 0; j < i; j++) {
+            if (phi_args[j].block == phi_args[i].block) {
+                return Fail(func, block->id, "two phi arguments from the same block");
+            }
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* every value has one definition, which dominates its uses, phi uses are at the end of the predecessor */
+static MiddleEndErr_t VerifySSA(IR_Function* func) {
+    assert( func != NULL );
+
+    MiddleEndErr_t flag = IR_ComputeDominators(func);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t value_cnt = IR_ValueCount(func);
+
+    IR_DefSite* defs = (IR_DefSite*)calloc(value_cnt + 1, sizeof(IR_DefSite));
+    if (defs == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    for (size_t i = 0; i < value_cnt; i++) {
+        defs[i].block = IR_NO_BLOCK;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func) && flag == MIDDLE_END_OK; i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            size_t dst = IR_GetInstr(block, j)->dst;
+            if (dst == IR_NO_VALUE) {
+                continue;
+            }
+
+            if (defs[dst].block != IR_NO_BLOCK) {
+                flag = Fail(func, block->id, "value is defined twice");
+                break;
+            }
+
+            defs[dst].block = i;
+            defs[dst].idx   = j;
+        }
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(func) && flag == MIDDLE_END_OK; i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block) && flag == MIDDLE_END_OK; j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            if (instr->opcode == IR_OP_PHI) {
+                const IR_PhiArg* phi_args = (const IR_PhiArg*)instr->phi_args->data;
+
+                for (size_t k = 0; k < instr->phi_args->size; k++) {
+                    IR_DefSite def = defs[phi_args[k].value];
+                    if (def.block == IR_NO_BLOCK || !IR_Dominates(func, def.block, phi_args[k].block)) {
+                        flag = Fail(func, block->id, "phi argument is not available in the predecessor");
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            for (size_t k = 0; k < IR_OperandCount(instr); k++) {
+                IR_DefSite def = defs[*IR_Operand(instr, k)];
+
+                bool available = def.block == i ? def.idx < j
+                                                : def.block != IR_NO_BLOCK && IR_Dominates(func, def.block, i);
+                if (!available) {
+                    flag = Fail(func, block->id, "use is not dominated by the definition");
+                    break;
+                }
+            }
+        }
+    }
+
+    FREE(defs);
+
+    return flag;
+}
+
+static bool IsPred(const IR_Block* block, size_t pred) {
+    assert( block != NULL );
+
+    const size_t* preds = (const size_t*)block->preds->data;
+    for (size_t i = 0; i < block->preds->size; i++) {
+        if (preds[i] == pred) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static MiddleEndErr_t Fail(const IR_Function* func, size_t block, const char* message) {
+    assert( func    != NULL );
+    assert( message != NULL );
+
+    if (block == IR_NO_BLOCK) {
+        fprintf(stderr, "IR_Verify: %s: %s\n", func->name, message);
+    } else {
+        fprintf(stderr, "IR_Verify: %s.bb%lu: %s\n", func->name, block, message);
+    }
+
+    return MIDDLE_END_ERROR;
+}
@@ -0,0 +1,150 @@
+#include "../../include/middle_end/loop_invariant_motion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/middle_end/ir.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+static MiddleEndErr_t FunctionLoopInvariantMotion(IR_Function* func, size_t* hoisted_cnt);
+static size_t HoistInvariants(IR_Function* func, const IR_Loop* loop, size_t preheader, size_t* def_block);
+static bool IsInvariant(IR_Instr* instr, const IR_Loop* loop, const size_t* def_block);
+
+/*
+ * Pure instruction of the loop, which operands are defined out of it, is computed once in the preheader.
+ * Inner loops go first, so their invariants can leave the outer loops too.
+ * Division is never hoisted: the loop may skip it, when the divisor is zero.
+ */
+MiddleEndErr_t LoopInvariantMotion(IR_Module* module, size_t* hoisted_cnt) {
+    assert( module      != NULL );
+    assert( hoisted_cnt != NULL );
+
+    *hoisted_cnt = 0;
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        // invariant operands are defined once only in SSA form
+        if (!functions[i]->is_ssa) {
+            continue;
+        }
+
+        MiddleEndErr_t flag = FunctionLoopInvariantMotion(functions[i], hoisted_cnt);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t FunctionLoopInvariantMotion(IR_Function* func, size_t* hoisted_cnt) {
+    assert( func        != NULL );
+    assert( hoisted_cnt != NULL );
+
+    Buffer_t* loops     = BufferInit(0, sizeof(IR_Loop));
+    size_t*   def_block = (size_t*)calloc(IR_ValueCount(func) + 1, sizeof(size_t));
+    if (loops == NULL || def_block == NULL) {
+        if (loops != NULL) {
+            BufferDestroy(&loops);
+        }
+        free(def_block);
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = IR_FindLoops(func, loops);
+
+    if (flag == MIDDLE_END_OK) {
+        for (size_t i = 0; i < IR_BlockCount(func); i++) {
+            IR_Block* block = IR_GetBlock(func, i);
+
+            for (size_t j = 0; j < IR_InstrCount(block); j++) {
+                size_t dst = IR_GetInstr(block, j)->dst;
+                if (dst != IR_NO_VALUE) {
+                    def_block[dst] = i;
+                }
+            }
+        }
+
+        IR_Loop* loop_array = (IR_Loop*)loops->data;
+        for (size_t i = 0; i < loops->size; i++) {
+            size_t preheader = IR_LoopPreheader(func, &loop_array[i]);
+            if (preheader != IR_NO_BLOCK) {
+                *hoisted_cnt += HoistInvariants(func, &loop_array[i], preheader, def_block);
+            }
+        }
+
+        IR_RemoveNops(func);
+    }
+
+    IR_LoopsDestroy(&loops);
+    FREE(def_block);
+
+    return flag;
+}
+
+/* returns the number of hoisted instructions */
+static size_t HoistInvariants(IR_Function* func, const IR_Loop* loop, size_t preheader, size_t* def_block) {
+    assert( func      != NULL );
+    assert( loop      != NULL );
+    assert( def_block != NULL );
+
+    IR_Block* target = IR_GetBlock(func, preheader);
+    size_t hoisted_cnt = 0;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = 0; i < IR_BlockCount(func); i++) {
+            if (!loop->body[i]) {
+                continue;
+            }
+
+            IR_Block* block = IR_GetBlock(func, i);
+
+            for (size_t j = 0; j < IR_InstrCount(block); j++) {
+                IR_Instr* instr = IR_GetInstr(block, j);
+                if (!IsInvariant(instr, loop, def_block)) {
+                    continue;
+                }
+
+                if (IR_Insert(target, IR_InstrCount(target) - 1, *instr) != MIDDLE_END_OK) {
+                    return hoisted_cnt; //FIXME - error handler
+                }
+
+                def_block[instr->dst] = preheader;
+
+                // the preheader owns the instruction now
+                *instr = IR_InstrMake(IR_OP_NOP, CONST_TYPE_VOID, IR_NO_VALUE, IR_NO_VALUE, IR_NO_VALUE);
+
+                hoisted_cnt++;
+                changed = true;
+            }
+        }
+    }
+
+    return hoisted_cnt;
+}
+
+static bool IsInvariant(IR_Instr* instr, const IR_Loop* loop, const size_t* def_block) {
+    assert( instr     != NULL );
+    assert( loop      != NULL );
+    assert( def_block != NULL );
+
+    bool is_pure =    instr->opcode == IR_OP_CONST || instr->opcode == IR_OP_COPY
+                   || (IR_IsBinary(instr->opcode) && instr->opcode != IR_OP_DIV);
+    if (!is_pure) {
+        return false;
+    }
+
+    for (size_t i = 0; i < IR_OperandCount(instr); i++) {
+        if (loop->body[def_block[*IR_Operand(instr, i)]]) {
+            return false;
+        }
+    }
+
+    return true;
+}
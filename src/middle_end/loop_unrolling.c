@@ -0,0 +1,326 @@
+#include "../../include/middle_end/loop_unrolling.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+
+const size_t UNROLL_FACTOR      = 4;    // copies of the body in the loop, which is unrolled partially
+const size_t UNROLL_SIZE_BUDGET = 160;  // nodes of all the copies, which replace one loop
+
+typedef struct Unroller {
+    AST* ast;
+    size_t unrolled_cnt;
+} Unroller;
+
+typedef struct CountedLoop {
+    const char* counter;
+    size_t trip_cnt;
+    size_t body_size;
+    bool needs_blocks;      // locals of the body are declared once in each copy
+} CountedLoop;
+
+static void UnrollChain(Unroller* unr, AST_Node* chain);
+static void UnrollStatement(Unroller* unr, AST_Node* chain, AST_Node* link);
+static void UnrollElse(Unroller* unr, AST_Node* else_part);
+
+static bool GetCountedLoop(AST_Node* chain, AST_Node* loop_link, CountedLoop* loop);
+static bool GetInitialValue(AST_Node* chain, AST_Node* loop_link, const char* counter, long* value);
+static bool GetStep(AST_Node* body, const char* counter, long* step);
+static bool HasPlainBody(const AST_Node* node, const char* counter, const AST_Node* step_statement);
+
+static void UnrollLoop(Unroller* unr, AST_Node* loop_link, const CountedLoop* loop);
+static AST_Node* BodyCopies(const AST_Node* body, size_t copies_cnt, bool needs_blocks);
+
+/*
+ * Loops "int i = a; ... while (i < b) { ...; i = i + s; }" with constant a, b and s
+ * and no other writes of i are unrolled. The short ones are replaced with the copies of the body,
+ * the others get UNROLL_FACTOR copies in the body and the rest of the trips before the loop,
+ * so the condition is checked once per UNROLL_FACTOR trips.
+ */
+MiddleEndErr_t LoopUnrolling(AST* ast, size_t* unrolled_cnt) {
+    assert( ast != NULL );
+
+    Unroller unr = {
+        .ast = ast,
+        .unrolled_cnt = 0
+    };
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement)) {
+            UnrollChain(&unr, statement->right->right);
+        }
+    }
+
+    if (unrolled_cnt != NULL) {
+        *unrolled_cnt = unr.unrolled_cnt;
+    }
+
+    return MIDDLE_END_OK;
+}
+
+// ================================= STATEMENTS =================================
+
+static void UnrollChain(Unroller* unr, AST_Node* chain) {
+    assert( unr != NULL );
+
+    for (AST_Node* link = chain; link != NULL; link = AST_ChainNext(link)) {
+        UnrollStatement(unr, chain, link);
+    }
+}
+
+/* inner loops are unrolled first, so the budget goes to them */
+static void UnrollStatement(Unroller* unr, AST_Node* chain, AST_Node* link) {
+    assert( unr  != NULL );
+    assert( link != NULL );
+
+    AST_Node* statement = AST_ChainStatement(link);
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_IF)) {
+        UnrollChain(unr, statement->right);
+        UnrollElse(unr, AST_ChainElse(statement->right));
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        UnrollChain(unr, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        UnrollChain(unr, statement->right);
+
+        CountedLoop loop = {};
+        if (link != statement && GetCountedLoop(chain, link, &loop)) {
+            UnrollLoop(unr, link, &loop);
+        }
+    }
+}
+
+static void UnrollElse(Unroller* unr, AST_Node* else_part) {
+    assert( unr != NULL );
+
+    if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+        UnrollChain(unr, else_part->right);
+        UnrollElse(unr, AST_ChainElse(else_part->right));
+
+    } else if (AST_IsOperation(else_part, AST_ELEM_OPERATION_ELSE)) {
+        UnrollChain(unr, else_part->right);
+    }
+}
+
+// ================================ COUNTED LOOPS ================================
+
+static bool GetCountedLoop(AST_Node* chain, AST_Node* loop_link, CountedLoop* loop) {
+    assert( loop_link != NULL );
+    assert( loop      != NULL );
+
+    AST_Node* statement = AST_ChainStatement(loop_link);
+    AST_Node* condition = statement->left;
+    AST_Node* body      = statement->right;
+
+    bool inclusive = AST_IsOperation(condition, AST_ELEM_OPERATION_LE);
+
+    if (    body == NULL
+        ||  !(AST_IsOperation(condition, AST_ELEM_OPERATION_LT) || inclusive)
+        ||  condition->left->type != AST_ELEM_TYPE_VARIABLE
+        ||  !IsIntConst(condition->right) ) {
+        return false;
+    }
+
+    const char* counter = condition->left->data.variable;
+    long limit = condition->right->data.constant.data.int_const;
+    long start = 0;
+    long step  = 0;
+
+    if (!GetInitialValue(chain, loop_link, counter, &start) || !GetStep(body, counter, &step)) {
+        return false;
+    }
+
+    AST_Node* last = body;
+    while (AST_ChainNext(last) != NULL) {
+        last = AST_ChainNext(last);
+    }
+
+    if (!HasPlainBody(body, counter, AST_ChainStatement(last))) {
+        return false;
+    }
+
+    long trip_cnt = 0;
+    if (inclusive && limit >= start) {
+        trip_cnt = (limit - start) / step + 1;
+    } else if (!inclusive && limit > start) {
+        trip_cnt = (limit - start + step - 1) / step;
+    }
+
+    if (trip_cnt == 0) {
+        return false;
+    }
+
+    loop->counter      = counter;
+    loop->trip_cnt     = (size_t)trip_cnt;
+    loop->body_size    = SubtreeSize(body);
+    loop->needs_blocks = false;
+
+    for (AST_Node* link = body; link != NULL; link = AST_ChainNext(link)) {
+        loop->needs_blocks = loop->needs_blocks || AST_IsVarDec(AST_ChainStatement(link));
+    }
+
+    return true;
+}
+
+/* the last statement before the loop, which mentions the counter, declares it with the constant */
+static bool GetInitialValue(AST_Node* chain, AST_Node* loop_link, const char* counter, long* value) {
+    assert( loop_link != NULL );
+    assert( counter   != NULL );
+    assert( value     != NULL );
+
+    const AST_Node* init = NULL;
+
+    for (AST_Node* link = chain; link != NULL && link != loop_link; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        bool declares = AST_IsVarDec(statement) && strcmp(AST_VarDecIdentifier(statement)->data.variable, counter) == 0;
+
+        if (declares || CountUses(statement, counter) != 0) {
+            init = statement;
+        }
+    }
+
+    if (    !AST_IsVarDec(init)
+        ||  strcmp(AST_VarDecIdentifier(init)->data.variable, counter) != 0
+        ||  init->data.declaration_type == CONST_TYPE_DOUBLE
+        ||  !IsIntConst(AST_VarDecInitializer(init)) ) {
+        return false;
+    }
+
+    *value = AST_VarDecInitializer(init)->data.constant.data.int_const;
+
+    return true;
+}
+
+/* "i = i + s;" or "i = s + i;" ends the body */
+static bool GetStep(AST_Node* body, const char* counter, long* step) {
+    assert( body    != NULL );
+    assert( counter != NULL );
+    assert( step    != NULL );
+
+    AST_Node* last = body;
+    while (AST_ChainNext(last) != NULL) {
+        last = AST_ChainNext(last);
+    }
+
+    AST_Node* statement = AST_ChainStatement(last);
+    if (!AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT) || !IsVariable(statement->left, counter)) {
+        return false;
+    }
+
+    AST_Node* sum = statement->right;
+    if (!AST_IsOperation(sum, AST_ELEM_OPERATION_ADD)) {
+        return false;
+    }
+
+    const AST_Node* increment = NULL;
+    if (IsVariable(sum->left, counter)) {
+        increment = sum->right;
+    } else if (IsVariable(sum->right, counter)) {
+        increment = sum->left;
+    }
+
+    if (!IsIntConst(increment) || increment->data.constant.data.int_const <= 0) {
+        return false;
+    }
+
+    *step = increment->data.constant.data.int_const;
+
+    return true;
+}
+
+/* body neither leaves the loop nor writes the counter except the step, nor declares its own counter */
+static bool HasPlainBody(const AST_Node* node, const char* counter, const AST_Node* step_statement) {
+    assert( counter != NULL );
+
+    if (node == NULL || node == step_statement) {
+        return true;
+    }
+
+    if (    AST_IsOperation(node, AST_ELEM_OPERATION_RETURN)
+        ||  AST_IsOperation(node, AST_ELEM_OPERATION_BREAK) ) {
+        return false;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_ASSIGNMENT) && CountUses(node->left, counter) != 0) {
+        return false;
+    }
+
+    if (AST_IsVarDec(node) && strcmp(AST_VarDecIdentifier(node)->data.variable, counter) == 0) {
+        return false;
+    }
+
+    return HasPlainBody(node->left, counter, step_statement) && HasPlainBody(node->right, counter, step_statement);
+}
+
+// ================================== UNROLLING ==================================
+
+/* the loop statement is replaced with the block of the copies and, for the long loops, the shorter loop */
+static void UnrollLoop(Unroller* unr, AST_Node* loop_link, const CountedLoop* loop) {
+    assert( unr       != NULL );
+    assert( loop_link != NULL );
+    assert( loop      != NULL );
+
+    AST_Node* statement = loop_link->left;
+    AST_Node* block = NULL;
+
+    if (loop->trip_cnt * loop->body_size <= UNROLL_SIZE_BUDGET) {
+        block = BodyCopies(statement->right, loop->trip_cnt, loop->needs_blocks);
+
+        statement->parent = NULL;
+        AST_SubtreeDestroy(statement);
+
+    } else {
+        size_t rest_cnt = loop->trip_cnt % UNROLL_FACTOR;
+
+        if (    loop->trip_cnt < 2 * UNROLL_FACTOR
+            ||  (UNROLL_FACTOR + rest_cnt) * loop->body_size > UNROLL_SIZE_BUDGET ) {
+            return;
+        }
+
+        // the rest of the trips is a multiple of the factor, so the check of the condition is enough
+        AST_Node* body = statement->right;
+        statement->right = BodyCopies(body, UNROLL_FACTOR, loop->needs_blocks);
+        statement->right->parent = statement;
+
+        AST_Node* prologue = rest_cnt != 0 ? BodyCopies(body, rest_cnt, loop->needs_blocks) : NULL;
+
+        body->parent = NULL;
+        AST_SubtreeDestroy(body);
+
+        statement->parent = NULL;
+        block = ChainAppend(prologue, AST_NodeInit(NULL, statement, NULL, AST_ELEM_TYPE_OPERATION,
+                                                   AST_ELEM_OPERATION_SENTINEL));
+    }
+
+    loop_link->left = block;
+    block->parent = loop_link;
+
+    ++unr->unrolled_cnt;
+}
+
+static AST_Node* BodyCopies(const AST_Node* body, size_t copies_cnt, bool needs_blocks) {
+    assert( body != NULL );
+
+    AST_Node* chain = NULL;
+
+    for (size_t i = 0; i < copies_cnt; i++) {
+        AST_Node* copy = AST_SubtreeCopy(body);
+
+        if (needs_blocks) {
+            copy = AST_NodeInit(NULL, copy, NULL, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+        }
+
+        chain = ChainAppend(chain, copy);
+    }
+
+    return chain;
+}
@@ -1 +1,150 @@
-#include "../../include/middle_end/middle_end.h"
\ No newline at end of file
+#include "../../include/middle_end/middle_end.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+/* calls, input and assignments are the only operations with side effects */
+bool HasSideEffects(const AST_Node* node) {
+    if (node == NULL) {
+        return false;
+    }
+
+    if (    AST_IsOperation(node, AST_ELEM_OPERATION_CALL) 
+         || AST_IsOperation(node, AST_ELEM_OPERATION_INPUT)
+         || AST_IsOperation(node, AST_ELEM_OPERATION_PRINT)
+         || AST_IsOperation(node, AST_ELEM_OPERATION_ASSIGNMENT) ) {
+        return true;
+    }
+
+    return HasSideEffects(node->left) || HasSideEffects(node->right);
+}
+
+AST_Node* FindFuncDec(AST* ast, const char* func_name) {
+    assert( ast       != NULL );
+    assert( func_name != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement) && strcmp(statement->right->data.variable, func_name) == 0) {
+            return statement;
+        }
+    }
+
+    return NULL;
+}
+
+/* division by zero stops the program, so such expressions can not be dropped or evaluated eagerly */
+bool ContainsDivision(const AST_Node* node) {
+    if (node == NULL) {
+        return false;
+    }
+
+    return     AST_IsOperation(node, AST_ELEM_OPERATION_DIV)
+            || ContainsDivision(node->left) || ContainsDivision(node->right);
+}
+
+/* appends declarations of the functions called inside the subtree, each one once */
+MiddleEndErr_t CollectCallees(AST* ast, AST_Node* node, Buffer_t* callees) {
+    assert( ast     != NULL );
+    assert( callees != NULL );
+
+    if (node == NULL) {
+        return MIDDLE_END_OK;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        AST_Node* callee = FindFuncDec(ast, node->right->data.variable);
+
+        if (callee != NULL && !ContainsNode(callees, callee)) {
+            if (BufferPush(callees, &callee, sizeof(AST_Node*)) != BUFFER_OK) {
+                return MIDDLE_END_BUFFER_FAILED;
+            }
+        }
+    }
+
+    MiddleEndErr_t flag = CollectCallees(ast, node->left, callees);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    return CollectCallees(ast, node->right, callees);
+}
+
+bool ContainsNode(const Buffer_t* nodes, const AST_Node* node) {
+    assert( nodes != NULL );
+
+    for (size_t i = 0; i < nodes->size; i++) {
+        if (((AST_Node**)nodes->data)[i] == node) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool IsIntConst(const AST_Node* node) {
+    return node != NULL && node->type == AST_ELEM_TYPE_CONST && node->data.constant.type == CONST_TYPE_INT;
+}
+
+bool IsVariable(const AST_Node* node, const char* name) {
+    assert( name != NULL );
+
+    return node != NULL && node->type == AST_ELEM_TYPE_VARIABLE && strcmp(node->data.variable, name) == 0;
+}
+
+/* links the tail chain after the last link of the chain, returns the head of the joined chain */
+AST_Node* ChainAppend(AST_Node* chain, AST_Node* tail) {
+    if (chain == NULL) {
+        return tail;
+    }
+
+    if (tail == NULL) {
+        return chain;
+    }
+
+    AST_Node* last = chain;
+    while (AST_ChainNext(last) != NULL) {
+        last = AST_ChainNext(last);
+    }
+
+    assert( last->right == NULL );
+
+    last->right = tail;
+    tail->parent = last;
+
+    return chain;
+}
+
+/* name of the called function is a variable node too, but it is not a variable */
+bool IsCallName(const AST_Node* node) {
+    assert( node != NULL );
+
+    return AST_IsOperation(node->parent, AST_ELEM_OPERATION_CALL) && node->parent->right == node;
+}
+
+/* occurrences of the variable: reads, writes and its declaration, names of the called functions are skipped */
+size_t CountUses(const AST_Node* node, const char* name) {
+    assert( name != NULL );
+
+    if (node == NULL) {
+        return 0;
+    }
+
+    size_t self =    node->type == AST_ELEM_TYPE_VARIABLE && !IsCallName(node)
+                  && strcmp(node->data.variable, name) == 0;
+
+    return self + CountUses(node->left, name) + CountUses(node->right, name);
+}
+
+size_t SubtreeSize(const AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    return 1 + SubtreeSize(node->left) + SubtreeSize(node->right);
+}
@@ -0,0 +1,331 @@
+#include "../../include/middle_end/pass_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/ir.h"
+#include "../../include/middle_end/accumulation.h"
+#include "../../include/middle_end/ast_optimization.h"
+#include "../../include/middle_end/call_evaluation.h"
+#include "../../include/middle_end/constant_propagation.h"
+#include "../../include/middle_end/dead_code_elimination.h"
+#include "../../include/middle_end/if_conversion.h"
+#include "../../include/middle_end/inlining.h"
+#include "../../include/middle_end/loop_unrolling.h"
+#include "../../include/middle_end/specialization.h"
+#include "../../include/middle_end/type_inference.h"
+#include "../../include/middle_end/value_numbering.h"
+#include "../../include/middle_end/loop_invariant_motion.h"
+#include "../../include/middle_end/strength_reduction.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t PASS_MAX_ITERATIONS = 64;  // rounds of the fixed point pipeline
+
+const char AST_SIZE_UNIT[] = "nodes";   // size of the tree for the AST passes
+const char IR_SIZE_UNIT[]  = "instrs";  // size of the module for the IR passes
+
+typedef MiddleEndErr_t (*AST_PassFunc)(AST* ast, size_t* changed_cnt);
+typedef MiddleEndErr_t (*IR_PassFunc)(IR_Module* module, size_t* changed_cnt);
+
+typedef struct AST_Pass {
+    const char* name;
+    AST_PassFunc run;
+    OptLevel min_level;
+} AST_Pass;
+
+typedef struct IR_Pass {
+    const char* name;
+    IR_PassFunc run;
+    OptLevel min_level;
+} IR_Pass;
+
+static MiddleEndErr_t ToSSA(IR_Module* module, size_t* changed_cnt);
+static MiddleEndErr_t FromSSA(IR_Module* module, size_t* changed_cnt);
+
+/* each pass may open the way for the others, so they are repeated until nothing changes */
+static const AST_Pass ast_fixed_point_passes[] = {
+    {"constant-propagation",  ConstantPropagation,       OPT_LEVEL_1},
+    {"constant-folding",      ConstantFolding,           OPT_LEVEL_1},
+    {"call-evaluation",       CallEvaluation,            OPT_LEVEL_2},
+    {"inlining",              FunctionInlining,          OPT_LEVEL_2},
+    {"specialization",        FunctionSpecialization,    OPT_LEVEL_2},
+    {"accumulation",          AccumulatorTransformation, OPT_LEVEL_2},
+    {"loop-unrolling",        LoopUnrolling,             OPT_LEVEL_2},
+    {"dead-code-elimination", DeadCodeElimination,       OPT_LEVEL_1},
+    {"if-conversion",         IfConversion,              OPT_LEVEL_1},
+};
+
+// the tree does not change after that, the types stay valid for the back ends
+static const AST_Pass ast_final_passes[] = {
+    {"type-inference",        TypeInference,             OPT_LEVEL_0},
+};
+
+/* optimizations of the linear IR run in SSA form, the module is verified after each step */
+static const IR_Pass ir_passes[] = {
+    {"to-ssa",                ToSSA,                     OPT_LEVEL_0},
+    {"value-numbering",       ValueNumbering,            OPT_LEVEL_1},
+    {"loop-invariant-motion", LoopInvariantMotion,       OPT_LEVEL_2},
+    {"strength-reduction",    StrengthReduction,         OPT_LEVEL_2},
+    {"from-ssa",              FromSSA,                   OPT_LEVEL_0},
+};
+
+static MiddleEndErr_t RunASTPass(PassManager* manager, const AST_Pass* pass, AST* ast, size_t* changed_cnt);
+static MiddleEndErr_t RunIRPass(PassManager* manager, const IR_Pass* pass, IR_Module* module);
+static PassStats* GetStats(PassManager* manager, const char* name, const char* size_unit);
+static double NowMs();
+static size_t CountNodes(const AST_Node* node);
+static size_t CountInstrs(const IR_Module* module);
+
+PassManager* PassManagerInit(OptLevel level) {
+    PassManager* manager = (PassManager*)calloc(1, sizeof(PassManager));
+    if (manager == NULL) {
+        return NULL;
+    }
+
+    manager->level = level;
+    manager->stats = BufferInit(0, sizeof(PassStats));
+
+    if (manager->stats == NULL) {
+        FREE(manager);
+        return NULL;
+    }
+
+    return manager;
+}
+
+MiddleEndErr_t PassManagerDestroy(PassManager** manager) {
+    assert(  manager != NULL );
+    assert( *manager != NULL );
+
+    BufferDestroy(&(*manager)->stats);
+    FREE(*manager);
+
+    return MIDDLE_END_OK;
+}
+
+MiddleEndErr_t PassManagerRunAST(PassManager* manager, AST* ast) {
+    assert( manager != NULL );
+    assert( ast     != NULL );
+
+    size_t passes_cnt = sizeof(ast_fixed_point_passes) / sizeof(ast_fixed_point_passes[0]);
+
+    size_t changed_cnt = 0;
+    size_t iteration   = 0;
+    do {
+        changed_cnt = 0;
+
+        for (size_t i = 0; i < passes_cnt; i++) {
+            if (ast_fixed_point_passes[i].min_level > manager->level) {
+                continue;
+            }
+
+            size_t pass_changed_cnt = 0;
+
+            MiddleEndErr_t flag = RunASTPass(manager, &ast_fixed_point_passes[i], ast, &pass_changed_cnt);
+            if (flag != MIDDLE_END_OK) {
+                return flag;
+            }
+
+            changed_cnt += pass_changed_cnt;
+        }
+    } while (changed_cnt != 0 && ++iteration < PASS_MAX_ITERATIONS);
+
+    passes_cnt = sizeof(ast_final_passes) / sizeof(ast_final_passes[0]);
+
+    for (size_t i = 0; i < passes_cnt; i++) {
+        size_t pass_changed_cnt = 0;
+
+        MiddleEndErr_t flag = RunASTPass(manager, &ast_final_passes[i], ast, &pass_changed_cnt);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+MiddleEndErr_t PassManagerRunIR(PassManager* manager, IR_Module* module) {
+    assert( manager != NULL );
+    assert( module  != NULL );
+
+    size_t passes_cnt = sizeof(ir_passes) / sizeof(ir_passes[0]);
+
+    for (size_t i = 0; i < passes_cnt; i++) {
+        if (ir_passes[i].min_level > manager->level) {
+            continue;
+        }
+
+        MiddleEndErr_t flag = RunIRPass(manager, &ir_passes[i], module);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+
+        flag = IR_Verify(module);
+        if (flag != MIDDLE_END_OK) {
+            fprintf(stderr, "PassManager: module is broken after \"%s\"\n", ir_passes[i].name);
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+void PassManagerDump(const PassManager* manager, FILE* stream) {
+    assert( manager != NULL );
+    assert( stream  != NULL );
+
+    fprintf(stream, "%-24s %6s %9s %11s %-6s %11s\n", "pass", "runs", "changed", "size delta", "unit", "time, ms");
+
+    const PassStats* stats = (const PassStats*)manager->stats->data;
+    for (size_t i = 0; i < manager->stats->size; i++) {
+        fprintf(stream, "%-24s %6zu %9zu %+11ld %-6s %11.3f\n", stats[i].name, stats[i].runs,
+                stats[i].changed_cnt, stats[i].size_delta, stats[i].size_unit, stats[i].time_ms);
+    }
+}
+
+// ================================== RUNNING ==================================
+
+static MiddleEndErr_t RunASTPass(PassManager* manager, const AST_Pass* pass, AST* ast, size_t* changed_cnt) {
+    assert( manager     != NULL );
+    assert( pass        != NULL );
+    assert( ast         != NULL );
+    assert( changed_cnt != NULL );
+
+    size_t size_before = CountNodes(ast->root);
+    double start = NowMs();
+
+    MiddleEndErr_t flag = pass->run(ast, changed_cnt);
+    if (flag != MIDDLE_END_OK) {
+        fprintf(stderr, "PassManager: \"%s\" failed with %d\n", pass->name, flag);
+        return flag;
+    }
+
+    double time_ms = NowMs() - start;
+
+    PassStats* stats = GetStats(manager, pass->name, AST_SIZE_UNIT);
+    if (stats == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    stats->runs++;
+    stats->changed_cnt += *changed_cnt;
+    stats->size_delta  += (long)CountNodes(ast->root) - (long)size_before;
+    stats->time_ms     += time_ms;
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t RunIRPass(PassManager* manager, const IR_Pass* pass, IR_Module* module) {
+    assert( manager != NULL );
+    assert( pass    != NULL );
+    assert( module  != NULL );
+
+    size_t size_before = CountInstrs(module);
+    size_t changed_cnt = 0;
+    double start = NowMs();
+
+    MiddleEndErr_t flag = pass->run(module, &changed_cnt);
+    if (flag != MIDDLE_END_OK) {
+        fprintf(stderr, "PassManager: \"%s\" failed with %d\n", pass->name, flag);
+        return flag;
+    }
+
+    double time_ms = NowMs() - start;
+
+    PassStats* stats = GetStats(manager, pass->name, IR_SIZE_UNIT);
+    if (stats == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    stats->runs++;
+    stats->changed_cnt += changed_cnt;
+    stats->size_delta  += (long)CountInstrs(module) - (long)size_before;
+    stats->time_ms     += time_ms;
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t ToSSA(IR_Module* module, size_t* changed_cnt) {
+    assert( module      != NULL );
+    assert( changed_cnt != NULL );
+
+    *changed_cnt = 0;
+
+    return IR_ModuleToSSA(module);
+}
+
+static MiddleEndErr_t FromSSA(IR_Module* module, size_t* changed_cnt) {
+    assert( module      != NULL );
+    assert( changed_cnt != NULL );
+
+    *changed_cnt = 0;
+
+    return IR_ModuleFromSSA(module);
+}
+
+// ================================= STATISTICS =================================
+
+static PassStats* GetStats(PassManager* manager, const char* name, const char* size_unit) {
+    assert( manager   != NULL );
+    assert( name      != NULL );
+    assert( size_unit != NULL );
+
+    PassStats* stats = (PassStats*)manager->stats->data;
+    for (size_t i = 0; i < manager->stats->size; i++) {
+        if (strcmp(stats[i].name, name) == 0) {
+            return &stats[i];
+        }
+    }
+
+    PassStats new_stats = {
+        .name        = name,
+        .runs        = 0,
+        .changed_cnt = 0,
+        .size_delta  = 0,
+        .size_unit   = size_unit,
+        .time_ms     = 0
+    };
+
+    if (BufferPush(manager->stats, &new_stats, sizeof(PassStats)) != BUFFER_OK) {
+        return NULL;
+    }
+
+    return &((PassStats*)manager->stats->data)[manager->stats->size - 1];
+}
+
+static double NowMs() {
+    struct timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec * 1000 + (double)now.tv_nsec / 1000000;
+}
+
+static size_t CountNodes(const AST_Node* node) {
+    if (node == NULL) {
+        return 0;
+    }
+
+    return 1 + CountNodes(node->left) + CountNodes(node->right);
+}
+
+static size_t CountInstrs(const IR_Module* module) {
+    assert( module != NULL );
+
+    size_t cnt = 0;
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        IR_Block** blocks = (IR_Block**)functions[i]->blocks->data;
+
+        for (size_t j = 0; j < functions[i]->blocks->size; j++) {
+            cnt += blocks[j]->instrs->size;
+        }
+    }
+
+    return cnt;
+}
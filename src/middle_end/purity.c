@@ -0,0 +1,343 @@
+#include "../../include/middle_end/purity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct PureFunc {
+    AST_Node* func_dec;
+    bool pure;
+    Buffer_t* callees;      // AST_Node*, declarations of the called functions
+} PureFunc;
+
+static MiddleEndErr_t SelectPureFunctions(AST* ast, Buffer_t* func_decs, size_t min_recursive_calls);
+static MiddleEndErr_t CollectFunctions(AST* ast, Buffer_t* funcs);
+static void DestroyFunctions(Buffer_t* funcs);
+static bool HasPureSignature(const AST_Node* func_dec);
+static bool HasPureBody(AST* ast, const AST_Node* func_dec);
+static bool UsesOnlyLocals(AST* ast, const AST_Node* node, const Buffer_t* names);
+static bool CollectLocals(const AST_Node* params, const AST_Node* body, Buffer_t* names);
+static bool IsGlobalName(AST* ast, const char* name);
+
+static PureFunc* FindFunc(Buffer_t* funcs, const AST_Node* func_dec);
+static bool Reaches(Buffer_t* funcs, const PureFunc* from, const AST_Node* to);
+static size_t CountRecursiveCalls(AST* ast, Buffer_t* funcs, const PureFunc* func, const AST_Node* node);
+
+/*
+ * Pure function has only integer parameters, returns a value, does not print,
+ * does not read input, does not touch global variables and calls only pure functions,
+ * so its result depends on the arguments only. All of them are appended to func_decs.
+ */
+MiddleEndErr_t FindPureFunctions(AST* ast, Buffer_t* func_decs) {
+    return SelectPureFunctions(ast, func_decs, 0);
+}
+
+/*
+ * Pure functions, which call themselves (directly or not) at least twice, are appended to func_decs:
+ * they recompute the same results exponentially many times, single recursion would only pay for the lookups.
+ */
+MiddleEndErr_t FindMemoizableFunctions(AST* ast, Buffer_t* func_decs) {
+    return SelectPureFunctions(ast, func_decs, 2);
+}
+
+// ================================= FUNCTIONS =================================
+
+static MiddleEndErr_t SelectPureFunctions(AST* ast, Buffer_t* func_decs, size_t min_recursive_calls) {
+    assert( ast       != NULL );
+    assert( func_decs != NULL );
+
+    Buffer_t* funcs = BufferInit(0, sizeof(PureFunc));
+    if (funcs == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = CollectFunctions(ast, funcs);
+    if (flag != MIDDLE_END_OK) {
+        DestroyFunctions(funcs);
+        return flag;
+    }
+
+    PureFunc* data = (PureFunc*)funcs->data;
+
+    // a call of the impure function makes the caller impure
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = 0; i < funcs->size; i++) {
+            if (!data[i].pure) {
+                continue;
+            }
+
+            for (size_t j = 0; j < data[i].callees->size; j++) {
+                const PureFunc* callee = FindFunc(funcs, ((AST_Node**)data[i].callees->data)[j]);
+
+                if (callee == NULL || !callee->pure) {
+                    data[i].pure = false;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < funcs->size; i++) {
+        if (!data[i].pure) {
+            continue;
+        }
+
+        if (    min_recursive_calls == 0
+            ||  CountRecursiveCalls(ast, funcs, &data[i], data[i].func_dec->right->right) >= min_recursive_calls ) {
+            if (BufferPush(func_decs, &data[i].func_dec, sizeof(AST_Node*)) != BUFFER_OK) {
+                flag = MIDDLE_END_BUFFER_FAILED;
+                break;
+            }
+        }
+    }
+
+    DestroyFunctions(funcs);
+
+    return flag;
+}
+
+static MiddleEndErr_t CollectFunctions(AST* ast, Buffer_t* funcs) {
+    assert( ast   != NULL );
+    assert( funcs != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+        if (!AST_IsFuncDec(statement)) {
+            continue;
+        }
+
+        PureFunc func = {
+            .func_dec = statement,
+            .pure     = HasPureSignature(statement) && HasPureBody(ast, statement),
+            .callees  = BufferInit(0, sizeof(AST_Node*))
+        };
+
+        if (func.callees == NULL) {
+            return MIDDLE_END_BUFFER_FAILED;
+        }
+
+        MiddleEndErr_t flag = CollectCallees(ast, statement->right->right, func.callees);
+
+        if (flag == MIDDLE_END_OK && BufferPush(funcs, &func, sizeof(PureFunc)) != BUFFER_OK) {
+            flag = MIDDLE_END_BUFFER_FAILED;
+        }
+
+        if (flag != MIDDLE_END_OK) {
+            BufferDestroy(&func.callees);
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static void DestroyFunctions(Buffer_t* funcs) {
+    assert( funcs != NULL );
+
+    for (size_t i = 0; i < funcs->size; i++) {
+        BufferDestroy(&((PureFunc*)funcs->data)[i].callees);
+    }
+
+    BufferDestroy(&funcs);
+}
+
+/* arguments are compared as integers, the result is stored as a word */
+static bool HasPureSignature(const AST_Node* func_dec) {
+    assert( func_dec != NULL );
+
+    ConstType type = func_dec->data.declaration_type;
+    if (type == CONST_TYPE_VOID || type == CONST_TYPE_DOUBLE) {
+        return false;
+    }
+
+    const AST_Node* params = func_dec->right->left;
+    if (params == NULL) {
+        return false;
+    }
+
+    for (; params != NULL; params = params->left) {
+        if (params->data.declaration_type == CONST_TYPE_DOUBLE || params->data.declaration_type == CONST_TYPE_VOID) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool HasPureBody(AST* ast, const AST_Node* func_dec) {
+    assert( ast      != NULL );
+    assert( func_dec != NULL );
+
+    Buffer_t* names = BufferInit(0, sizeof(const char*));
+    if (names == NULL) {
+        return false;
+    }
+
+    bool pure =    CollectLocals(func_dec->right->left, func_dec->right->right, names)
+                && UsesOnlyLocals(ast, func_dec->right->right, names);
+
+    // local may shadow the global only in a part of the body, the rest would read the global
+    for (size_t i = 0; pure && i < names->size; i++) {
+        pure = !IsGlobalName(ast, ((const char**)names->data)[i]);
+    }
+
+    BufferDestroy(&names);
+
+    return pure;
+}
+
+static bool UsesOnlyLocals(AST* ast, const AST_Node* node, const Buffer_t* names) {
+    assert( ast   != NULL );
+    assert( names != NULL );
+
+    if (node == NULL) {
+        return true;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_PRINT) || AST_IsOperation(node, AST_ELEM_OPERATION_INPUT)) {
+        return false;
+    }
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL) && FindFuncDec(ast, node->right->data.variable) == NULL) {
+        return false;
+    }
+
+    if (node->type == AST_ELEM_TYPE_VARIABLE && !IsCallName(node)) {
+        for (size_t i = 0; i < names->size; i++) {
+            if (strcmp(((const char**)names->data)[i], node->data.variable) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    return UsesOnlyLocals(ast, node->left, names) && UsesOnlyLocals(ast, node->right, names);
+}
+
+static bool CollectLocals(const AST_Node* params, const AST_Node* body, Buffer_t* names) {
+    assert( names != NULL );
+
+    for (; params != NULL; params = params->left) {
+        if (BufferPush(names, &params->right->data.variable, sizeof(const char*)) != BUFFER_OK) {
+            return false;
+        }
+    }
+
+    if (body == NULL) {
+        return true;
+    }
+
+    if (AST_IsVarDec(body)) {
+        if (BufferPush(names, &AST_VarDecIdentifier(body)->data.variable, sizeof(const char*)) != BUFFER_OK) {
+            return false;
+        }
+    }
+
+    return CollectLocals(NULL, body->left, names) && CollectLocals(NULL, body->right, names);
+}
+
+static bool IsGlobalName(AST* ast, const char* name) {
+    assert( ast  != NULL );
+    assert( name != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsVarDec(statement) && strcmp(AST_VarDecIdentifier(statement)->data.variable, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ================================ CALL GRAPH ================================
+
+static PureFunc* FindFunc(Buffer_t* funcs, const AST_Node* func_dec) {
+    assert( funcs != NULL );
+
+    for (size_t i = 0; i < funcs->size; i++) {
+        if (((PureFunc*)funcs->data)[i].func_dec == func_dec) {
+            return &((PureFunc*)funcs->data)[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool Reaches(Buffer_t* funcs, const PureFunc* from, const AST_Node* to) {
+    assert( funcs != NULL );
+    assert( from  != NULL );
+    assert( to    != NULL );
+
+    Buffer_t* reached = BufferInit(0, sizeof(AST_Node*));
+    if (reached == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < from->callees->size; i++) {
+        BufferPush(reached, &((AST_Node**)from->callees->data)[i], sizeof(AST_Node*));
+    }
+
+    bool found = false;
+
+    for (size_t i = 0; i < reached->size; i++) {
+        AST_Node* callee_dec = ((AST_Node**)reached->data)[i];
+
+        if (callee_dec == to) {
+            found = true;
+            break;
+        }
+
+        const PureFunc* callee = FindFunc(funcs, callee_dec);
+        if (callee == NULL) {
+            continue;
+        }
+
+        for (size_t j = 0; j < callee->callees->size; j++) {
+            AST_Node* next = ((AST_Node**)callee->callees->data)[j];
+
+            if (!ContainsNode(reached, next)) {
+                BufferPush(reached, &next, sizeof(AST_Node*));
+            }
+        }
+    }
+
+    BufferDestroy(&reached);
+
+    return found;
+}
+
+/* calls in the subtree, which come back to the function */
+static size_t CountRecursiveCalls(AST* ast, Buffer_t* funcs, const PureFunc* func, const AST_Node* node) {
+    assert( ast   != NULL );
+    assert( funcs != NULL );
+    assert( func  != NULL );
+
+    if (node == NULL) {
+        return 0;
+    }
+
+    size_t cnt = CountRecursiveCalls(ast, funcs, func, node->left) + CountRecursiveCalls(ast, funcs, func, node->right);
+
+    if (AST_IsOperation(node, AST_ELEM_OPERATION_CALL)) {
+        const AST_Node* callee_dec = FindFuncDec(ast, node->right->data.variable);
+        const PureFunc* callee = callee_dec != NULL ? FindFunc(funcs, callee_dec) : NULL;
+
+        if (callee_dec == func->func_dec || (callee != NULL && Reaches(funcs, callee, func->func_dec))) {
+            ++cnt;
+        }
+    }
+
+    return cnt;
+}
@@ -0,0 +1,416 @@
+#include "../../include/middle_end/specialization.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../include/middle_end/middle_end.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+const size_t SPECIALIZE_BODY_BUDGET   = 300;    // nodes in the body of a cloned function
+const size_t SPECIALIZE_GROWTH_BUDGET = 2048;   // nodes added to the tree by all clones
+const size_t SPECIALIZE_MAX_CLONES    = 4;      // clones of one function
+const size_t SPECIALIZE_MIN_CALLS     = 2;      // call sites of one shape, a call in a loop counts for all of them
+const size_t SPECIALIZE_MAX_PARAMS    = 16;
+const int    SPECIALIZE_NAME_LEN      = 256;
+
+const char SPECIALIZE_SUFFIX[] = "__spec";
+
+typedef struct Specializer {
+    AST* ast;
+    size_t redirected_cnt;
+    size_t growth;              // nodes of all the clones in the tree
+    Buffer_t* shapes;           // ShapeUse of the call sites, which are found before the cloning
+    MiddleEndErr_t flag;
+} Specializer;
+
+typedef struct ShapeUse {
+    char* name;                 // name of the clone for the shape
+    size_t calls_cnt;
+} ShapeUse;
+
+typedef struct CallShape {
+    AST_Node* func_dec;
+    size_t params_cnt;
+    bool fixed[SPECIALIZE_MAX_PARAMS];      // argument is a constant, which the callee branches on
+    int values[SPECIALIZE_MAX_PARAMS];
+} CallShape;
+
+static void CountShapes(Specializer* spec, const AST_Node* node, bool in_loop);
+static ShapeUse* FindShape(const Specializer* spec, const char* name);
+static void SpecializeCalls(Specializer* spec, AST_Node* node);
+static bool GetCallShape(Specializer* spec, const AST_Node* call, CallShape* shape);
+static bool IsBranchedOn(const AST_Node* node, const char* name);
+
+static void CloneName(const CallShape* shape, char* name);
+static AST_Node* CloneFunction(Specializer* spec, const CallShape* shape, const char* name);
+static void RedirectCall(AST_Node* call, const CallShape* shape, const char* name);
+static size_t CountClones(AST* ast, const char* func_name);
+static size_t CloneGrowth(AST* ast);
+
+/*
+ * Call, which passes integer constants for the parameters the callee branches on, is redirected
+ * to the clone of the callee, where these parameters are locals initialized with the constants.
+ * Constant propagation and dead code elimination remove the branches from the clone then.
+ * Clone names keep the constants, so the same arguments find the same clone, also in the clone itself.
+ * Only the shapes of at least SPECIALIZE_MIN_CALLS call sites get a new clone.
+ */
+MiddleEndErr_t FunctionSpecialization(AST* ast, size_t* redirected_cnt) {
+    assert( ast != NULL );
+
+    Specializer spec = {
+        .ast            = ast,
+        .redirected_cnt = 0,
+        .growth         = CloneGrowth(ast),
+        .shapes         = BufferInit(0, sizeof(ShapeUse)),
+        .flag           = MIDDLE_END_OK
+    };
+
+    if (spec.shapes == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement)) {
+            CountShapes(&spec, statement->right->right, false);
+        }
+    }
+
+    for (AST_Node* link = ast->root; link != NULL && spec.flag == MIDDLE_END_OK; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement)) {
+            SpecializeCalls(&spec, statement->right->right);
+        }
+    }
+
+    ShapeUse* shapes = (ShapeUse*)spec.shapes->data;
+    for (size_t i = 0; i < spec.shapes->size; i++) {
+        free(shapes[i].name);
+    }
+
+    BufferDestroy(&spec.shapes);
+
+    if (redirected_cnt != NULL) {
+        *redirected_cnt = spec.redirected_cnt;
+    }
+
+    return spec.flag;
+}
+
+// ================================= CALL SITES =================================
+
+/* call in the loop runs many times, so it is counted as SPECIALIZE_MIN_CALLS call sites */
+static void CountShapes(Specializer* spec, const AST_Node* node, bool in_loop) {
+    assert( spec != NULL );
+
+    if (node == NULL || spec->flag != MIDDLE_END_OK) {
+        return;
+    }
+
+    bool children_in_loop = in_loop || AST_IsOperation(node, AST_ELEM_OPERATION_WHILE);
+
+    CountShapes(spec, node->left,  children_in_loop);
+    CountShapes(spec, node->right, children_in_loop);
+
+    CallShape shape = {};
+
+    if (!AST_IsOperation(node, AST_ELEM_OPERATION_CALL) || !GetCallShape(spec, node, &shape)) {
+        return;
+    }
+
+    char name[SPECIALIZE_NAME_LEN] = "";
+    CloneName(&shape, name);
+
+    ShapeUse* use = FindShape(spec, name);
+
+    if (use == NULL) {
+        ShapeUse new_use = {
+            .name      = strdup(name),
+            .calls_cnt = 0
+        };
+
+        if (new_use.name == NULL || BufferPush(spec->shapes, &new_use, sizeof(ShapeUse)) != BUFFER_OK) {
+            free(new_use.name);
+            spec->flag = MIDDLE_END_BUFFER_FAILED;
+            return;
+        }
+
+        use = &((ShapeUse*)spec->shapes->data)[spec->shapes->size - 1];
+    }
+
+    use->calls_cnt += in_loop ? SPECIALIZE_MIN_CALLS : 1;
+}
+
+static ShapeUse* FindShape(const Specializer* spec, const char* name) {
+    assert( spec != NULL );
+    assert( name != NULL );
+
+    ShapeUse* shapes = (ShapeUse*)spec->shapes->data;
+    for (size_t i = 0; i < spec->shapes->size; i++) {
+        if (strcmp(shapes[i].name, name) == 0) {
+            return &shapes[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void SpecializeCalls(Specializer* spec, AST_Node* node) {
+    assert( spec != NULL );
+
+    if (node == NULL || spec->flag != MIDDLE_END_OK) {
+        return;
+    }
+
+    SpecializeCalls(spec, node->left);
+    SpecializeCalls(spec, node->right);
+
+    CallShape shape = {};
+
+    if (!AST_IsOperation(node, AST_ELEM_OPERATION_CALL) || !GetCallShape(spec, node, &shape)) {
+        return;
+    }
+
+    char name[SPECIALIZE_NAME_LEN] = "";
+    CloneName(&shape, name);
+
+    // clones of the earlier rounds are reused by any call of their shape
+    if (FindFuncDec(spec->ast, name) == NULL) {
+        const ShapeUse* use = FindShape(spec, name);
+
+        if (use == NULL || use->calls_cnt < SPECIALIZE_MIN_CALLS || CloneFunction(spec, &shape, name) == NULL) {
+            return;
+        }
+    }
+
+    RedirectCall(node, &shape, name);
+
+    ++spec->redirected_cnt;
+}
+
+/* at least one argument stays: calls without arguments are not supported by the back ends */
+static bool GetCallShape(Specializer* spec, const AST_Node* call, CallShape* shape) {
+    assert( spec  != NULL );
+    assert( call  != NULL );
+    assert( shape != NULL );
+
+    AST_Node* func_dec = FindFuncDec(spec->ast, call->right->data.variable);
+    if (func_dec == NULL || strcmp(call->right->data.variable, "main") == 0) {
+        return false;
+    }
+
+    shape->func_dec = func_dec;
+    shape->params_cnt = 0;
+
+    size_t fixed_cnt = 0;
+
+    const AST_Node* param = func_dec->right->left;
+    const AST_Node* arg   = call->left;
+
+    for (; param != NULL && arg != NULL; param = param->left, arg = arg->left) {
+        if (shape->params_cnt == SPECIALIZE_MAX_PARAMS) {
+            return false;
+        }
+
+        size_t idx = shape->params_cnt++;
+
+        shape->fixed[idx] =    IsIntConst(arg->right)
+                            && param->data.declaration_type != CONST_TYPE_DOUBLE
+                            && IsBranchedOn(func_dec->right->right, param->right->data.variable);
+
+        if (shape->fixed[idx]) {
+            shape->values[idx] = arg->right->data.constant.data.int_const;
+            ++fixed_cnt;
+        }
+    }
+
+    return param == NULL && arg == NULL && fixed_cnt != 0 && fixed_cnt != shape->params_cnt;
+}
+
+/* name is read in the condition of an if or a while */
+static bool IsBranchedOn(const AST_Node* node, const char* name) {
+    assert( name != NULL );
+
+    if (node == NULL) {
+        return false;
+    }
+
+    if (    (AST_IsOperation(node, AST_ELEM_OPERATION_IF) || AST_IsOperation(node, AST_ELEM_OPERATION_WHILE))
+        &&  CountUses(node->left, name) != 0 ) {
+        return true;
+    }
+
+    return IsBranchedOn(node->left, name) || IsBranchedOn(node->right, name);
+}
+
+// =================================== CLONES ===================================
+
+/* "f__spec_1_3" is f with the parameter 1 equal to 3, "m" stands for the minus */
+static void CloneName(const CallShape* shape, char* name) {
+    assert( shape != NULL );
+    assert( name  != NULL );
+
+    int len = snprintf(name, SPECIALIZE_NAME_LEN, "%s%s", shape->func_dec->right->data.variable, SPECIALIZE_SUFFIX);
+
+    for (size_t i = 0; i < shape->params_cnt && len < SPECIALIZE_NAME_LEN; i++) {
+        if (!shape->fixed[i]) {
+            continue;
+        }
+
+        int value = shape->values[i];
+        len += snprintf(name + len, (size_t)(SPECIALIZE_NAME_LEN - len), "_%zu_%s%ld", i,
+                        value < 0 ? "m" : "", labs((long)value));
+    }
+}
+
+/* the clone goes right after the function, "int p = c;" opens its body for each fixed parameter */
+static AST_Node* CloneFunction(Specializer* spec, const CallShape* shape, const char* name) {
+    assert( spec  != NULL );
+    assert( shape != NULL );
+    assert( name  != NULL );
+
+    AST_Node* func_dec = shape->func_dec;
+    size_t body_size = SubtreeSize(func_dec->right->right);
+
+    if (    body_size > SPECIALIZE_BODY_BUDGET
+        ||  spec->growth + body_size > SPECIALIZE_GROWTH_BUDGET
+        ||  CountClones(spec->ast, func_dec->right->data.variable) >= SPECIALIZE_MAX_CLONES ) {
+        return NULL;
+    }
+
+    AST_Node* clone = AST_SubtreeCopy(func_dec);
+    char* clone_name = strdup(name);
+
+    if (clone == NULL || clone_name == NULL) {
+        if (clone != NULL) {
+            AST_SubtreeDestroy(clone);
+        }
+
+        free(clone_name);
+        spec->flag = MIDDLE_END_ERROR;
+        return NULL;
+    }
+
+    AST_Node* identifier = clone->right;
+
+    free(identifier->data.variable);
+    identifier->data.variable = clone_name;
+
+    AST_Node** param_slot = &identifier->left;
+    AST_Node*  param_parent = identifier;
+    AST_Node*  body = identifier->right;
+
+    for (size_t i = 0; i < shape->params_cnt; i++) {
+        AST_Node* param = *param_slot;
+
+        if (!shape->fixed[i]) {
+            param_parent = param;
+            param_slot = &param->left;
+            continue;
+        }
+
+        *param_slot = param->left;
+        if (param->left != NULL) {
+            param->left->parent = param_parent;
+        }
+
+        // the declaration of the parameter becomes the declaration of the local
+        AST_Node* value = AST_NodeInit(NULL, NULL, NULL, AST_ELEM_TYPE_CONST, CONST_TYPE_INT, shape->values[i]);
+        AST_Node* assignment = AST_NodeInit(NULL, param->right, value, AST_ELEM_TYPE_OPERATION,
+                                            AST_ELEM_OPERATION_ASSIGNMENT);
+
+        param->left  = NULL;
+        param->right = assignment;
+        assignment->parent = param;
+
+        body = AST_NodeInit(NULL, param, body, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+    }
+
+    identifier->right = body;
+    body->parent = identifier;
+
+    AST_Node* link = func_dec->parent;
+    while (!AST_IsOperation(link, AST_ELEM_OPERATION_SENTINEL)) {
+        link = link->parent;
+    }
+
+    link->right = AST_NodeInit(link, clone, link->right, AST_ELEM_TYPE_OPERATION, AST_ELEM_OPERATION_SENTINEL);
+
+    spec->growth += body_size;
+
+    return clone;
+}
+
+/* fixed arguments are dropped, the others keep their order */
+static void RedirectCall(AST_Node* call, const CallShape* shape, const char* name) {
+    assert( call  != NULL );
+    assert( shape != NULL );
+    assert( name  != NULL );
+
+    free(call->right->data.variable);
+    call->right->data.variable = strdup(name);
+
+    AST_Node** arg_slot = &call->left;
+    AST_Node*  arg_parent = call;
+
+    for (size_t i = 0; i < shape->params_cnt; i++) {
+        AST_Node* arg = *arg_slot;
+
+        if (!shape->fixed[i]) {
+            arg_parent = arg;
+            arg_slot = &arg->left;
+            continue;
+        }
+
+        *arg_slot = arg->left;
+        if (arg->left != NULL) {
+            arg->left->parent = arg_parent;
+        }
+
+        arg->left = NULL;
+        arg->parent = NULL;
+        AST_SubtreeDestroy(arg);
+    }
+}
+
+static size_t CountClones(AST* ast, const char* func_name) {
+    assert( ast       != NULL );
+    assert( func_name != NULL );
+
+    char prefix[SPECIALIZE_NAME_LEN] = "";
+    snprintf(prefix, SPECIALIZE_NAME_LEN, "%s%s", func_name, SPECIALIZE_SUFFIX);
+
+    size_t clones_cnt = 0;
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement) && strncmp(statement->right->data.variable, prefix, strlen(prefix)) == 0) {
+            ++clones_cnt;
+        }
+    }
+
+    return clones_cnt;
+}
+
+/* clones of the earlier rounds take their part of the growth budget */
+static size_t CloneGrowth(AST* ast) {
+    assert( ast != NULL );
+
+    size_t growth = 0;
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement) && strstr(statement->right->data.variable, SPECIALIZE_SUFFIX) != NULL) {
+            growth += SubtreeSize(statement->right->right);
+        }
+    }
+
+    return growth;
+}
@@ -0,0 +1,873 @@
+#include "../../include/middle_end/strength_reduction.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/middle_end/ir.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct SR_Setup {
+    IR_Function* func;
+    size_t value_cnt;       // values known at the last CollectDefs, newer ones are not described
+    size_t* def_block;      // IR_NO_BLOCK for the values without definition
+    size_t* def_idx;
+    bool* is_const;
+    int* imm;               // value of the constant
+    bool* non_negative;
+} SR_Setup;
+
+typedef struct SR_Scaled {
+    size_t value;
+    size_t scaled;          // value * factor, computed in the preheader
+} SR_Scaled;
+
+typedef struct SR_Product {
+    size_t product;
+    size_t member;          // member of the family, which is the product after the replacement
+} SR_Product;
+
+typedef struct SR_Induction {
+    size_t counter;         // phi of the header
+    size_t factor;          // common multiplier of the products, IR_NO_VALUE if there is no replacement
+    bool compared;          // members are compared with loop invariants
+    Buffer_t* members;      // size_t, the counter and the values counter + c, counter - c computed in the loop
+} SR_Induction;
+
+static MiddleEndErr_t FunctionStrengthReduction(IR_Function* func, size_t* reduced_cnt);
+static MiddleEndErr_t CollectDefs(SR_Setup* sr);
+static void SetupDestroy(SR_Setup* sr);
+
+static MiddleEndErr_t ReduceLoop(SR_Setup* sr, const IR_Loop* loop, size_t preheader, size_t* reduced_cnt);
+static MiddleEndErr_t FindInduction(SR_Setup* sr, const IR_Loop* loop, size_t preheader, SR_Induction* ind);
+static MiddleEndErr_t CollectMembers(SR_Setup* sr, const IR_Loop* loop, SR_Induction* ind);
+static size_t* StepOperand(const SR_Setup* sr, const SR_Induction* ind, IR_Instr* instr);
+static MiddleEndErr_t ReplaceInduction(SR_Setup* sr, size_t preheader, const SR_Induction* ind, size_t* reduced_cnt);
+static MiddleEndErr_t CollectScaled(SR_Setup* sr, const SR_Induction* ind, size_t init, Buffer_t* scaled);
+static MiddleEndErr_t AddScaled(Buffer_t* scaled, size_t value);
+static SR_Scaled* FindScaled(const Buffer_t* scaled, size_t value);
+static MiddleEndErr_t EmitScaled(SR_Setup* sr, IR_Block* preheader, size_t value, size_t factor, size_t* scaled);
+static MiddleEndErr_t EmitConst(SR_Setup* sr, IR_Block* preheader, int imm, ConstType type, size_t* value);
+static bool ScaledFits(const SR_Setup* sr, size_t value, size_t factor);
+
+static void FindNonNegative(SR_Setup* sr);
+static bool IsNonNegativeDef(const SR_Setup* sr, IR_Instr* instr);
+static MiddleEndErr_t SimplifyArithmetic(SR_Setup* sr, size_t* reduced_cnt);
+static MiddleEndErr_t SimplifyInstr(SR_Setup* sr, IR_Block* block, size_t idx, size_t* reduced_cnt);
+
+static IR_Instr* Def(const SR_Setup* sr, size_t value);
+static bool IsConst(const SR_Setup* sr, size_t value);
+static bool IsInvariant(const SR_Setup* sr, const IR_Loop* loop, size_t value);
+static bool IsSameFactor(const SR_Setup* sr, size_t factor, size_t other);
+static bool IsMember(const SR_Induction* ind, size_t value);
+static bool UsesMember(const SR_Induction* ind, IR_Instr* instr);
+static bool IsCompare(IR_Opcode opcode);
+static int ExactLog2(int value);
+
+/*
+ * Loop counter i = phi(init, i + c), which is read only by comparisons with loop invariants
+ * and by multiplications i * k, is replaced by the counter of the products: phi(init * k, i + c * k).
+ * The values i + d of the unrolled steps go with it and become i * k + d * k.
+ * The comparisons use the bounds multiplied by k, it keeps their result for constant k > 1,
+ * the loop invariant k is taken only for the counter, which is not compared.
+ * After that multiplications and divisions by constants become shifts and copies where it is exact:
+ * division turns into a shift only for the non-negative dividend, shift rounds negative ones down.
+ */
+MiddleEndErr_t StrengthReduction(IR_Module* module, size_t* reduced_cnt) {
+    assert( module      != NULL );
+    assert( reduced_cnt != NULL );
+
+    *reduced_cnt = 0;
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        // the counter and its step are found by the single definitions
+        if (!functions[i]->is_ssa) {
+            continue;
+        }
+
+        MiddleEndErr_t flag = FunctionStrengthReduction(functions[i], reduced_cnt);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t FunctionStrengthReduction(IR_Function* func, size_t* reduced_cnt) {
+    assert( func        != NULL );
+    assert( reduced_cnt != NULL );
+
+    SR_Setup sr = {
+        .func         = func,
+        .value_cnt    = 0,
+        .def_block    = NULL,
+        .def_idx      = NULL,
+        .is_const     = NULL,
+        .imm          = NULL,
+        .non_negative = NULL
+    };
+
+    Buffer_t* loops = BufferInit(0, sizeof(IR_Loop));
+    if (loops == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = IR_FindLoops(func, loops);
+    if (flag == MIDDLE_END_OK) {
+        flag = CollectDefs(&sr);
+    }
+
+    IR_Loop* loop_array = (IR_Loop*)loops->data;
+    for (size_t i = 0; i < loops->size && flag == MIDDLE_END_OK; i++) {
+        size_t preheader = IR_LoopPreheader(func, &loop_array[i]);
+        if (preheader != IR_NO_BLOCK) {
+            flag = ReduceLoop(&sr, &loop_array[i], preheader, reduced_cnt);
+        }
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        flag = SimplifyArithmetic(&sr, reduced_cnt);
+        IR_RemoveNops(func);
+    }
+
+    IR_LoopsDestroy(&loops);
+    SetupDestroy(&sr);
+
+    return flag;
+}
+
+/* definitions, constants and signs of the values existing now */
+static MiddleEndErr_t CollectDefs(SR_Setup* sr) {
+    assert( sr != NULL );
+
+    SetupDestroy(sr);
+
+    size_t value_cnt = IR_ValueCount(sr->func);
+
+    sr->value_cnt    = value_cnt;
+    sr->def_block    = (size_t*)calloc(value_cnt + 1, sizeof(size_t));
+    sr->def_idx      = (size_t*)calloc(value_cnt + 1, sizeof(size_t));
+    sr->is_const     = (bool*)  calloc(value_cnt + 1, sizeof(bool));
+    sr->imm          = (int*)   calloc(value_cnt + 1, sizeof(int));
+    sr->non_negative = (bool*)  calloc(value_cnt + 1, sizeof(bool));
+
+    if (   sr->def_block == NULL || sr->def_idx      == NULL || sr->is_const == NULL
+        || sr->imm       == NULL || sr->non_negative == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    for (size_t i = 0; i < value_cnt; i++) {
+        sr->def_block[i] = IR_NO_BLOCK;
+    }
+
+    for (size_t i = 0; i < IR_BlockCount(sr->func); i++) {
+        IR_Block* block = IR_GetBlock(sr->func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+            if (instr->dst == IR_NO_VALUE) {
+                continue;
+            }
+
+            sr->def_block[instr->dst] = i;
+            sr->def_idx[instr->dst]   = j;
+
+            if (instr->opcode == IR_OP_CONST) {
+                sr->is_const[instr->dst] = true;
+                sr->imm[instr->dst]      = instr->imm;
+            }
+        }
+    }
+
+    FindNonNegative(sr);
+
+    return MIDDLE_END_OK;
+}
+
+static void SetupDestroy(SR_Setup* sr) {
+    assert( sr != NULL );
+
+    FREE(sr->def_block);
+    FREE(sr->def_idx);
+    FREE(sr->is_const);
+    FREE(sr->imm);
+    FREE(sr->non_negative);
+
+    sr->value_cnt = 0;
+}
+
+// ============================== INDUCTION VARIABLES ==============================
+
+static MiddleEndErr_t ReduceLoop(SR_Setup* sr, const IR_Loop* loop, size_t preheader, size_t* reduced_cnt) {
+    assert( sr          != NULL );
+    assert( loop        != NULL );
+    assert( reduced_cnt != NULL );
+
+    IR_Block* header = IR_GetBlock(sr->func, loop->header);
+
+    // the preheader and the single latch
+    if (header->preds->size != 2) {
+        return MIDDLE_END_OK;
+    }
+
+    Buffer_t* members = BufferInit(0, sizeof(size_t));
+    if (members == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < IR_InstrCount(header); i++) {
+        IR_Instr* phi = IR_GetInstr(header, i);
+        if (phi->opcode != IR_OP_PHI) {
+            break;
+        }
+
+        members->size = 0;
+
+        SR_Induction ind = {
+            .counter  = phi->dst,
+            .factor   = IR_NO_VALUE,
+            .compared = false,
+            .members  = members
+        };
+
+        flag = FindInduction(sr, loop, preheader, &ind);
+
+        if (flag == MIDDLE_END_OK && ind.factor != IR_NO_VALUE) {
+            flag = ReplaceInduction(sr, preheader, &ind, reduced_cnt);
+            if (flag == MIDDLE_END_OK) {
+                flag = CollectDefs(sr);
+            }
+        }
+    }
+
+    BufferDestroy(&members);
+
+    return flag;
+}
+
+/*
+ * The members of the counter family are read only by the steps of the family, by the comparisons
+ * with loop invariants and by the multiplications with the same factor, all of them in the loop.
+ * The constant factor must be above 1, the invariant one is taken only if nothing compares
+ * the members: its sign is unknown, so the scaled bounds could turn the comparisons over.
+ */
+static MiddleEndErr_t FindInduction(SR_Setup* sr, const IR_Loop* loop, size_t preheader, SR_Induction* ind) {
+    assert( sr   != NULL );
+    assert( loop != NULL );
+    assert( ind  != NULL );
+
+    if (IR_GetValue(sr->func, ind->counter)->type != CONST_TYPE_INT) {
+        return MIDDLE_END_OK;
+    }
+
+    MiddleEndErr_t flag = CollectMembers(sr, loop, ind);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t factor = IR_NO_VALUE;
+    bool compared = false;
+
+    for (size_t i = 0; i < IR_BlockCount(sr->func); i++) {
+        IR_Block* block = IR_GetBlock(sr->func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            // the family goes round the loop through the phi of the counter only
+            if (instr->opcode == IR_OP_PHI) {
+                const IR_PhiArg* phi_args = (const IR_PhiArg*)instr->phi_args->data;
+
+                for (size_t k = 0; k < instr->phi_args->size; k++) {
+                    bool is_next = instr->dst == ind->counter && phi_args[k].block != preheader;
+
+                    if (IsMember(ind, phi_args[k].value) != is_next) {
+                        return MIDDLE_END_OK;
+                    }
+                }
+                continue;
+            }
+
+            if (!UsesMember(ind, instr)) {
+                continue;
+            }
+
+            if (!loop->body[i]) {
+                return MIDDLE_END_OK;
+            }
+
+            if (StepOperand(sr, ind, instr) != NULL) {
+                continue;
+            }
+
+            size_t other = IsMember(ind, instr->args[0]) ? instr->args[1] : instr->args[0];
+
+            if (other == IR_NO_VALUE || IsMember(ind, other) || !IsInvariant(sr, loop, other)) {
+                return MIDDLE_END_OK;
+            }
+
+            if (IsCompare(instr->opcode)) {
+                compared = true;
+                continue;
+            }
+
+            if (instr->opcode != IR_OP_MUL || (factor != IR_NO_VALUE && !IsSameFactor(sr, factor, other))) {
+                return MIDDLE_END_OK;
+            }
+
+            factor = other;
+        }
+    }
+
+    if (factor == IR_NO_VALUE || IR_GetValue(sr->func, factor)->type != CONST_TYPE_INT) {
+        return MIDDLE_END_OK;
+    }
+
+    if (IsConst(sr, factor) ? sr->imm[factor] <= 1 : compared) {
+        return MIDDLE_END_OK;
+    }
+
+    ind->factor   = factor;
+    ind->compared = compared;
+
+    return MIDDLE_END_OK;
+}
+
+/* the counter and the values, which differ from it by constants, as the steps of the unrolled loop do */
+static MiddleEndErr_t CollectMembers(SR_Setup* sr, const IR_Loop* loop, SR_Induction* ind) {
+    assert( sr   != NULL );
+    assert( loop != NULL );
+    assert( ind  != NULL );
+
+    if (BufferPush(ind->members, &ind->counter, sizeof(size_t)) != BUFFER_OK) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = 0; i < IR_BlockCount(sr->func); i++) {
+            if (!loop->body[i]) {
+                continue;
+            }
+
+            IR_Block* block = IR_GetBlock(sr->func, i);
+
+            for (size_t j = 0; j < IR_InstrCount(block); j++) {
+                IR_Instr* instr = IR_GetInstr(block, j);
+
+                if (IsMember(ind, instr->dst) || StepOperand(sr, ind, instr) == NULL) {
+                    continue;
+                }
+
+                if (BufferPush(ind->members, &instr->dst, sizeof(size_t)) != BUFFER_OK) {
+                    return MIDDLE_END_BUFFER_FAILED;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* constant of member + c, c + member and member - c, NULL for the other instructions */
+static size_t* StepOperand(const SR_Setup* sr, const SR_Induction* ind, IR_Instr* instr) {
+    assert( sr    != NULL );
+    assert( ind   != NULL );
+    assert( instr != NULL );
+
+    if (instr->opcode != IR_OP_ADD && instr->opcode != IR_OP_SUB) {
+        return NULL;
+    }
+
+    if (IsMember(ind, instr->args[0]) && IsConst(sr, instr->args[1])) {
+        return &instr->args[1];
+    }
+
+    if (instr->opcode == IR_OP_ADD && IsConst(sr, instr->args[0]) && IsMember(ind, instr->args[1])) {
+        return &instr->args[0];
+    }
+
+    return NULL;
+}
+
+/*
+ * Every member becomes its product with the factor: the initial value, the constants of the steps
+ * and the bounds are scaled in the preheader and the multiplications are replaced by their members.
+ * The scaled values are emitted before the first rewrite, so the failure leaves only unused
+ * instructions there. The family, which constants do not fit int after the scaling, stays.
+ * Adds the number of removed multiplications to reduced_cnt.
+ */
+static MiddleEndErr_t ReplaceInduction(SR_Setup* sr, size_t preheader, const SR_Induction* ind, size_t* reduced_cnt) {
+    assert( sr          != NULL );
+    assert( ind         != NULL );
+    assert( reduced_cnt != NULL );
+
+    IR_Function* func = sr->func;
+    IR_Block* target = IR_GetBlock(func, preheader);
+    IR_Instr* phi = Def(sr, ind->counter);
+
+    IR_PhiArg* init = NULL;
+    IR_PhiArg* phi_args = (IR_PhiArg*)phi->phi_args->data;
+    for (size_t i = 0; i < phi->phi_args->size; i++) {
+        if (phi_args[i].block == preheader) {
+            init = &phi_args[i];
+        }
+    }
+
+    if (init == NULL) {
+        return MIDDLE_END_OK;
+    }
+
+    Buffer_t* scaled   = BufferInit(0, sizeof(SR_Scaled));
+    Buffer_t* products = BufferInit(0, sizeof(SR_Product));
+
+    MiddleEndErr_t flag = scaled != NULL && products != NULL ? CollectScaled(sr, ind, init->value, scaled)
+                                                             : MIDDLE_END_BUFFER_FAILED;
+
+    SR_Scaled* pairs = flag == MIDDLE_END_OK ? (SR_Scaled*)scaled->data : NULL;
+
+    bool fits = true;
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < scaled->size; i++) {
+        fits = fits && ScaledFits(sr, pairs[i].value, ind->factor);
+    }
+
+    for (size_t i = 0; flag == MIDDLE_END_OK && fits && i < scaled->size; i++) {
+        flag = EmitScaled(sr, target, pairs[i].value, ind->factor, &pairs[i].scaled);
+    }
+
+    for (size_t i = 0; flag == MIDDLE_END_OK && fits && i < IR_BlockCount(func); i++) {
+        IR_Block* block = IR_GetBlock(func, i);
+
+        for (size_t j = 0; flag == MIDDLE_END_OK && j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+            size_t* step = StepOperand(sr, ind, instr);
+
+            if (step != NULL) {
+                *step = FindScaled(scaled, *step)->scaled;
+
+            } else if (IsCompare(instr->opcode) && UsesMember(ind, instr)) {
+                size_t* bound = IsMember(ind, instr->args[0]) ? &instr->args[1] : &instr->args[0];
+                *bound = FindScaled(scaled, *bound)->scaled;
+
+            } else if (instr->opcode == IR_OP_MUL && UsesMember(ind, instr)) {
+                SR_Product product = {
+                    .product = instr->dst,
+                    .member  = IsMember(ind, instr->args[0]) ? instr->args[0] : instr->args[1]
+                };
+
+                if (BufferPush(products, &product, sizeof(SR_Product)) != BUFFER_OK) {
+                    flag = MIDDLE_END_BUFFER_FAILED;
+                }
+            }
+        }
+    }
+
+    if (flag == MIDDLE_END_OK && fits) {
+        init->value = FindScaled(scaled, init->value)->scaled;
+
+        const SR_Product* product_pairs = (const SR_Product*)products->data;
+        for (size_t i = 0; i < products->size; i++) {
+            IR_InstrClear(Def(sr, product_pairs[i].product));
+            IR_ReplaceUses(func, product_pairs[i].product, product_pairs[i].member);
+        }
+
+        *reduced_cnt += products->size;
+
+        // the values hold the scaled family now, they are not the source variable anymore
+        const size_t* member_values = (const size_t*)ind->members->data;
+        for (size_t i = 0; i < ind->members->size; i++) {
+            FREE(IR_GetValue(func, member_values[i])->name);
+        }
+    }
+
+    if (scaled != NULL) {
+        BufferDestroy(&scaled);
+    }
+    if (products != NULL) {
+        BufferDestroy(&products);
+    }
+
+    return flag;
+}
+
+/* the initial value, the constants of the steps and the bounds, each one once */
+static MiddleEndErr_t CollectScaled(SR_Setup* sr, const SR_Induction* ind, size_t init, Buffer_t* scaled) {
+    assert( sr     != NULL );
+    assert( ind    != NULL );
+    assert( scaled != NULL );
+
+    MiddleEndErr_t flag = AddScaled(scaled, init);
+
+    for (size_t i = 0; flag == MIDDLE_END_OK && i < IR_BlockCount(sr->func); i++) {
+        IR_Block* block = IR_GetBlock(sr->func, i);
+
+        for (size_t j = 0; flag == MIDDLE_END_OK && j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+            size_t* step = StepOperand(sr, ind, instr);
+
+            if (step != NULL) {
+                flag = AddScaled(scaled, *step);
+
+            } else if (IsCompare(instr->opcode) && UsesMember(ind, instr)) {
+                flag = AddScaled(scaled, IsMember(ind, instr->args[0]) ? instr->args[1] : instr->args[0]);
+            }
+        }
+    }
+
+    return flag;
+}
+
+static MiddleEndErr_t AddScaled(Buffer_t* scaled, size_t value) {
+    assert( scaled != NULL );
+
+    if (FindScaled(scaled, value) != NULL) {
+        return MIDDLE_END_OK;
+    }
+
+    SR_Scaled pair = {
+        .value  = value,
+        .scaled = IR_NO_VALUE
+    };
+
+    return BufferPush(scaled, &pair, sizeof(SR_Scaled)) == BUFFER_OK ? MIDDLE_END_OK : MIDDLE_END_BUFFER_FAILED;
+}
+
+static SR_Scaled* FindScaled(const Buffer_t* scaled, size_t value) {
+    assert( scaled != NULL );
+
+    SR_Scaled* pairs = (SR_Scaled*)scaled->data;
+    for (size_t i = 0; i < scaled->size; i++) {
+        if (pairs[i].value == value) {
+            return &pairs[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * value * factor at the end of the preheader, constants are multiplied at once,
+ * the other constants are made there again: their definitions may be in the loop
+ */
+static MiddleEndErr_t EmitScaled(SR_Setup* sr, IR_Block* preheader, size_t value, size_t factor, size_t* scaled) {
+    assert( sr        != NULL );
+    assert( preheader != NULL );
+    assert( scaled    != NULL );
+    assert( ScaledFits(sr, value, factor) );
+
+    ConstType type = IR_GetValue(sr->func, value)->type;
+
+    if (IsConst(sr, value) && IsConst(sr, factor)) {
+        return EmitConst(sr, preheader, (int)((long)sr->imm[value] * sr->imm[factor]), type, scaled);
+    }
+
+    size_t left  = value;
+    size_t right = factor;
+
+    MiddleEndErr_t flag = MIDDLE_END_OK;
+
+    if (IsConst(sr, value)) {
+        flag = EmitConst(sr, preheader, sr->imm[value], type, &left);
+    }
+    if (flag == MIDDLE_END_OK && IsConst(sr, factor)) {
+        flag = EmitConst(sr, preheader, sr->imm[factor], type, &right);
+    }
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t result = IR_ValueAdd(sr->func, NULL, type);
+
+    flag = IR_Insert(preheader, IR_InstrCount(preheader) - 1, IR_InstrMake(IR_OP_MUL, type, result, left, right));
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    *scaled = result;
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t EmitConst(SR_Setup* sr, IR_Block* preheader, int imm, ConstType type, size_t* value) {
+    assert( sr        != NULL );
+    assert( preheader != NULL );
+    assert( value     != NULL );
+
+    size_t result = IR_ValueAdd(sr->func, NULL, type);
+
+    IR_Instr constant = IR_InstrMake(IR_OP_CONST, type, result, IR_NO_VALUE, IR_NO_VALUE);
+    constant.imm = imm;
+
+    MiddleEndErr_t flag = IR_Insert(preheader, IR_InstrCount(preheader) - 1, constant);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    *value = result;
+    return MIDDLE_END_OK;
+}
+
+/* product of the constants must stay the int of the instruction */
+static bool ScaledFits(const SR_Setup* sr, size_t value, size_t factor) {
+    assert( sr != NULL );
+
+    if (!IsConst(sr, value) || !IsConst(sr, factor)) {
+        return true;
+    }
+
+    long product = (long)sr->imm[value] * sr->imm[factor];
+
+    return INT_MIN <= product && product <= INT_MAX;
+}
+
+// ============================== ARITHMETIC ==============================
+
+/* the largest set of values, which are non-negative when all its members are, counters from zero stay in it */
+static void FindNonNegative(SR_Setup* sr) {
+    assert( sr != NULL );
+
+    for (size_t i = 0; i < sr->value_cnt; i++) {
+        sr->non_negative[i] = sr->def_block[i] != IR_NO_BLOCK;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = 0; i < IR_BlockCount(sr->func); i++) {
+            IR_Block* block = IR_GetBlock(sr->func, i);
+
+            for (size_t j = 0; j < IR_InstrCount(block); j++) {
+                IR_Instr* instr = IR_GetInstr(block, j);
+
+                if (instr->dst != IR_NO_VALUE && sr->non_negative[instr->dst] && !IsNonNegativeDef(sr, instr)) {
+                    sr->non_negative[instr->dst] = false;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+static bool IsNonNegativeDef(const SR_Setup* sr, IR_Instr* instr) {
+    assert( sr    != NULL );
+    assert( instr != NULL );
+
+    switch (instr->opcode) {
+    case IR_OP_CONST:
+        return instr->imm >= 0;
+
+    case IR_OP_COPY:
+        return sr->non_negative[instr->args[0]];
+
+    case IR_OP_ADD:
+    case IR_OP_MUL:
+    case IR_OP_DIV:
+    case IR_OP_SHL:
+    case IR_OP_SHR:
+        return sr->non_negative[instr->args[0]] && sr->non_negative[instr->args[1]];
+
+    case IR_OP_LT:
+    case IR_OP_GT:
+    case IR_OP_LE:
+    case IR_OP_GE:
+    case IR_OP_EE:
+    case IR_OP_NE:
+    case IR_OP_LAND:
+    case IR_OP_LOR:
+        return true;
+
+    case IR_OP_PHI: {
+        const IR_PhiArg* phi_args = (const IR_PhiArg*)instr->phi_args->data;
+        for (size_t i = 0; i < instr->phi_args->size; i++) {
+            if (!sr->non_negative[phi_args[i].value]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    case IR_OP_NOP:
+    case IR_OP_PARAM:
+    case IR_OP_SUB:
+    case IR_OP_INPUT:
+    case IR_OP_PRINT:
+    case IR_OP_CALL:
+    case IR_OP_JUMP:
+    case IR_OP_BRANCH:
+    case IR_OP_RETURN:
+    default:
+        return false;
+    }
+}
+
+/* adds the number of simplified instructions to reduced_cnt */
+static MiddleEndErr_t SimplifyArithmetic(SR_Setup* sr, size_t* reduced_cnt) {
+    assert( sr          != NULL );
+    assert( reduced_cnt != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(sr->func); i++) {
+        IR_Block* block = IR_GetBlock(sr->func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            MiddleEndErr_t flag = SimplifyInstr(sr, block, j, reduced_cnt);
+            if (flag != MIDDLE_END_OK) {
+                return flag;
+            }
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+/* x * 0, x * 1, x / 1, x * 2^k and non-negative x / 2^k, the shift amount is inserted before the instruction */
+static MiddleEndErr_t SimplifyInstr(SR_Setup* sr, IR_Block* block, size_t idx, size_t* reduced_cnt) {
+    assert( sr          != NULL );
+    assert( block       != NULL );
+    assert( reduced_cnt != NULL );
+
+    IR_Instr* instr = IR_GetInstr(block, idx);
+    if (instr->opcode != IR_OP_MUL && instr->opcode != IR_OP_DIV) {
+        return MIDDLE_END_OK;
+    }
+
+    size_t operand = instr->args[0];
+    size_t divisor = instr->args[1];
+
+    if (instr->opcode == IR_OP_MUL && !IsConst(sr, divisor)) {
+        operand = instr->args[1];
+        divisor = instr->args[0];
+    }
+
+    if (!IsConst(sr, divisor)) {
+        return MIDDLE_END_OK;
+    }
+
+    int factor = sr->imm[divisor];
+
+    if (factor == 1) {
+        size_t dst = instr->dst;
+        IR_InstrClear(instr);
+        IR_ReplaceUses(sr->func, dst, operand);
+        ++*reduced_cnt;
+        return MIDDLE_END_OK;
+    }
+
+    if (factor == 0 && instr->opcode == IR_OP_MUL) {
+        *instr = IR_InstrMake(IR_OP_CONST, instr->type, instr->dst, IR_NO_VALUE, IR_NO_VALUE);
+        ++*reduced_cnt;
+        return MIDDLE_END_OK;
+    }
+
+    int shift = ExactLog2(factor);
+    if (shift <= 0) {
+        return MIDDLE_END_OK;
+    }
+
+    if (instr->opcode == IR_OP_DIV && !(operand < sr->value_cnt && sr->non_negative[operand])) {
+        return MIDDLE_END_OK;
+    }
+
+    IR_Opcode opcode = instr->opcode == IR_OP_MUL ? IR_OP_SHL : IR_OP_SHR;
+
+    size_t amount = IR_ValueAdd(sr->func, NULL, instr->type);
+    IR_Instr shifted = IR_InstrMake(opcode, instr->type, instr->dst, operand, amount);
+
+    IR_Instr constant = IR_InstrMake(IR_OP_CONST, instr->type, amount, IR_NO_VALUE, IR_NO_VALUE);
+    constant.imm = shift;
+
+    MiddleEndErr_t flag = IR_Insert(block, idx, constant);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    *IR_GetInstr(block, idx + 1) = shifted;
+    ++*reduced_cnt;
+
+    return MIDDLE_END_OK;
+}
+
+// ============================== HELPERS ==============================
+
+static IR_Instr* Def(const SR_Setup* sr, size_t value) {
+    assert( sr != NULL );
+    assert( value < sr->value_cnt && sr->def_block[value] != IR_NO_BLOCK );
+
+    return IR_GetInstr(IR_GetBlock(sr->func, sr->def_block[value]), sr->def_idx[value]);
+}
+
+static bool IsConst(const SR_Setup* sr, size_t value) {
+    assert( sr != NULL );
+
+    return value < sr->value_cnt && sr->is_const[value];
+}
+
+/* constant or the value defined out of the loop */
+static bool IsInvariant(const SR_Setup* sr, const IR_Loop* loop, size_t value) {
+    assert( sr   != NULL );
+    assert( loop != NULL );
+
+    if (IsConst(sr, value)) {
+        return true;
+    }
+
+    return value < sr->value_cnt && sr->def_block[value] != IR_NO_BLOCK && !loop->body[sr->def_block[value]];
+}
+
+static bool IsSameFactor(const SR_Setup* sr, size_t factor, size_t other) {
+    assert( sr != NULL );
+
+    return factor == other || (IsConst(sr, factor) && IsConst(sr, other) && sr->imm[factor] == sr->imm[other]);
+}
+
+static bool IsMember(const SR_Induction* ind, size_t value) {
+    assert( ind != NULL );
+
+    const size_t* members = (const size_t*)ind->members->data;
+    for (size_t i = 0; i < ind->members->size; i++) {
+        if (members[i] == value) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool UsesMember(const SR_Induction* ind, IR_Instr* instr) {
+    assert( ind   != NULL );
+    assert( instr != NULL );
+
+    for (size_t i = 0; i < IR_OperandCount(instr); i++) {
+        if (IsMember(ind, *IR_Operand(instr, i))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool IsCompare(IR_Opcode opcode) {
+    return IR_OP_LT <= opcode && opcode <= IR_OP_NE;
+}
+
+/* k for value == 2^k, -1 for the other values */
+static int ExactLog2(int value) {
+    if (value <= 0 || (value & (value - 1)) != 0) {
+        return -1;
+    }
+
+    int shift = 0;
+    while ((value >> shift) != 1) {
+        shift++;
+    }
+
+    return shift;
+}
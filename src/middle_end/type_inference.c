@@ -0,0 +1,431 @@
+#include "../../include/middle_end/type_inference.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "../../include/ast/ast.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct TI_Binding {
+    const char* name;
+    ConstType type;
+} TI_Binding;
+
+typedef struct TI_Setup {
+    AST* ast;
+    Buffer_t* bindings;     // TI_Binding, visible variables, inner ones are at the end
+    const AST_Node* func;   // declaration of the checked function
+    size_t error_cnt;
+} TI_Setup;
+
+static void CheckChain(TI_Setup* ti, AST_Node* link);
+static void CheckStatement(TI_Setup* ti, AST_Node* statement);
+static void CheckFunction(TI_Setup* ti, AST_Node* func_dec);
+static void CheckVarDec(TI_Setup* ti, AST_Node* var_dec);
+static void CheckAssignment(TI_Setup* ti, AST_Node* assignment);
+static void CheckReturn(TI_Setup* ti, AST_Node* return_node);
+
+static ConstType InferExpression(TI_Setup* ti, AST_Node* node);
+static ConstType InferValue(TI_Setup* ti, AST_Node* node);
+static ConstType InferCall(TI_Setup* ti, AST_Node* call);
+
+static void Bind(TI_Setup* ti, const char* name, ConstType type);
+static ConstType LookUp(TI_Setup* ti, AST_Node* variable);
+static AST_Node* FindFunction(const AST* ast, const char* name);
+static ConstType CommonType(ConstType left, ConstType right);
+static void Error(TI_Setup* ti, const char* message, const char* name);
+
+/*
+ * Every expression node gets the type of its value in value_type:
+ * arithmetic is done in the widest type of the operands, but not narrower than int,
+ * comparisons and logic give int. Assignments, returns and call arguments get
+ * the type the value is converted to, so the back ends choose the opcodes without runtime checks.
+ */
+MiddleEndErr_t TypeInference(AST* ast, size_t* error_cnt) {
+    assert( ast       != NULL );
+    assert( error_cnt != NULL );
+
+    TI_Setup ti = {
+        .ast       = ast,
+        .bindings  = BufferInit(0, sizeof(TI_Binding)),
+        .func      = NULL,
+        .error_cnt = 0
+    };
+
+    if (ti.bindings == NULL) {
+        return MIDDLE_END_BUFFER_FAILED;
+    }
+
+    CheckChain(&ti, ast->root);
+
+    BufferDestroy(&ti.bindings);
+
+    *error_cnt = ti.error_cnt;
+
+    return ti.error_cnt == 0 ? MIDDLE_END_OK : MIDDLE_END_TYPE_ERROR;
+}
+
+// ================================= STATEMENTS =================================
+
+static void CheckChain(TI_Setup* ti, AST_Node* link) {
+    assert( ti != NULL );
+
+    size_t visible = ti->bindings->size;
+
+    for (; link != NULL; link = AST_ChainNext(link)) {
+        CheckStatement(ti, AST_ChainStatement(link));
+    }
+
+    ti->bindings->size = visible; // block scope ends
+}
+
+static void CheckStatement(TI_Setup* ti, AST_Node* statement) {
+    assert( ti        != NULL );
+    assert( statement != NULL );
+
+    if (AST_IsOperation(statement, AST_ELEM_OPERATION_SENTINEL)) {
+        CheckChain(ti, statement);
+
+    } else if (AST_IsFuncDec(statement)) {
+        CheckFunction(ti, statement);
+
+    } else if (AST_IsVarDec(statement)) {
+        CheckVarDec(ti, statement);
+
+    } else if (   AST_IsOperation(statement, AST_ELEM_OPERATION_IF)
+               || AST_IsOperation(statement, AST_ELEM_OPERATION_WHILE)) {
+        InferValue(ti, statement->left);
+        CheckChain(ti, statement->right);
+
+        AST_Node* else_part = AST_IsOperation(statement, AST_ELEM_OPERATION_IF) ? AST_ChainElse(statement->right)
+                                                                                : NULL;
+        if (AST_IsOperation(else_part, AST_ELEM_OPERATION_IF)) {
+            CheckStatement(ti, else_part);
+        } else if (else_part != NULL) {
+            CheckChain(ti, else_part->right);
+        }
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_ASSIGNMENT)) {
+        CheckAssignment(ti, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_PRINT)) {
+        statement->value_type = CONST_TYPE_VOID;
+        InferValue(ti, statement->right);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_RETURN)) {
+        CheckReturn(ti, statement);
+
+    } else if (AST_IsOperation(statement, AST_ELEM_OPERATION_BREAK)) {
+        statement->value_type = CONST_TYPE_VOID;
+
+    } else {
+        InferExpression(ti, statement); // value of the expression statement is dropped, it may be void
+    }
+}
+
+static void CheckFunction(TI_Setup* ti, AST_Node* func_dec) {
+    assert( ti       != NULL );
+    assert( func_dec != NULL );
+
+    AST_Node* identifier = func_dec->right;
+    size_t visible = ti->bindings->size;
+
+    func_dec->value_type   = func_dec->data.declaration_type;
+    identifier->value_type = func_dec->data.declaration_type;
+
+    for (AST_Node* param = identifier->left; param != NULL; param = param->left) {
+        if (param->data.declaration_type == CONST_TYPE_VOID) {
+            Error(ti, "void parameter", param->right->data.variable);
+        }
+
+        param->value_type        = param->data.declaration_type;
+        param->right->value_type = param->data.declaration_type;
+
+        Bind(ti, param->right->data.variable, param->data.declaration_type);
+    }
+
+    const AST_Node* outer = ti->func;
+    ti->func = func_dec;
+
+    CheckChain(ti, identifier->right);
+
+    ti->func = outer;
+    ti->bindings->size = visible;
+}
+
+static void CheckVarDec(TI_Setup* ti, AST_Node* var_dec) {
+    assert( ti      != NULL );
+    assert( var_dec != NULL );
+
+    AST_Node* identifier  = AST_VarDecIdentifier(var_dec);
+    AST_Node* initializer = AST_VarDecInitializer(var_dec);
+    ConstType type = var_dec->data.declaration_type;
+
+    if (type == CONST_TYPE_VOID) {
+        Error(ti, "void variable", identifier->data.variable);
+    }
+
+    // initializer sees the variables of the enclosing scope
+    if (initializer != NULL) {
+        InferValue(ti, initializer);
+        var_dec->right->value_type = type;
+    }
+
+    var_dec->value_type    = type;
+    identifier->value_type = type;
+
+    Bind(ti, identifier->data.variable, type);
+}
+
+/* x = y = expr, the value is converted to the type of every target */
+static void CheckAssignment(TI_Setup* ti, AST_Node* assignment) {
+    assert( ti         != NULL );
+    assert( assignment != NULL );
+
+    InferValue(ti, assignment->right);
+
+    AST_Node* target = assignment->left;
+    while (target->right != NULL) {
+        target->value_type = LookUp(ti, target->right);
+        target = target->left;
+    }
+
+    assignment->value_type = LookUp(ti, target);
+}
+
+static void CheckReturn(TI_Setup* ti, AST_Node* return_node) {
+    assert( ti          != NULL );
+    assert( return_node != NULL );
+
+    ConstType type = ti->func != NULL ? ti->func->data.declaration_type : CONST_TYPE_INT;
+
+    return_node->value_type = type;
+
+    if (return_node->right == NULL) {
+        return;
+    }
+
+    if (type == CONST_TYPE_VOID) {
+        Error(ti, "void function returns a value", ti->func->right->data.variable);
+    }
+
+    InferValue(ti, return_node->right);
+}
+
+// ================================ EXPRESSIONS ================================
+
+static ConstType InferExpression(TI_Setup* ti, AST_Node* node) {
+    assert( ti   != NULL );
+    assert( node != NULL );
+
+    ConstType type = CONST_TYPE_UNDEFINED;
+
+    switch (node->type) {
+    case AST_ELEM_TYPE_CONST:
+        type = node->data.constant.type;
+        break;
+
+    case AST_ELEM_TYPE_VARIABLE:
+        type = LookUp(ti, node);
+        break;
+
+    case AST_ELEM_TYPE_OPERATION:
+        switch (node->data.operation) {
+        case AST_ELEM_OPERATION_ADD:
+        case AST_ELEM_OPERATION_SUB:
+        case AST_ELEM_OPERATION_MUL:
+        case AST_ELEM_OPERATION_DIV: {
+            ConstType left  = InferValue(ti, node->left);
+            ConstType right = InferValue(ti, node->right);
+            type = CommonType(left, right);
+            break;
+        }
+
+        case AST_ELEM_OPERATION_LT:
+        case AST_ELEM_OPERATION_GT:
+        case AST_ELEM_OPERATION_LE:
+        case AST_ELEM_OPERATION_GE:
+        case AST_ELEM_OPERATION_EE:
+        case AST_ELEM_OPERATION_NE:
+        case AST_ELEM_OPERATION_LAND:
+        case AST_ELEM_OPERATION_LOR:
+            InferValue(ti, node->left);
+            InferValue(ti, node->right);
+            type = CONST_TYPE_INT;
+            break;
+
+        // both values are converted to their common type
+        case AST_ELEM_OPERATION_SELECT: {
+            InferValue(ti, node->left);
+            ConstType then_type = InferValue(ti, node->right->left);
+            ConstType else_type = InferValue(ti, node->right->right);
+            type = CommonType(then_type, else_type);
+            node->right->value_type = type;
+            break;
+        }
+
+        case AST_ELEM_OPERATION_INPUT:
+            type = CONST_TYPE_INT;
+            break;
+
+        case AST_ELEM_OPERATION_CALL:
+            type = InferCall(ti, node);
+            break;
+
+        case AST_ELEM_OPERATION_UNDEFINED:
+        case AST_ELEM_OPERATION_SENTINEL:
+        case AST_ELEM_OPERATION_PRINT:
+        case AST_ELEM_OPERATION_ASSIGNMENT:
+        case AST_ELEM_OPERATION_IF:
+        case AST_ELEM_OPERATION_ELSE:
+        case AST_ELEM_OPERATION_WHILE:
+        case AST_ELEM_OPERATION_BREAK:
+        case AST_ELEM_OPERATION_RETURN:
+        default:
+            Error(ti, "statement is used as an expression", NULL);
+            break;
+        }
+        break;
+
+    case AST_ELEM_TYPE_UNDEFINED:
+    case AST_ELEM_TYPE_DECLARATION:
+    default:
+        Error(ti, "declaration is used as an expression", NULL);
+        break;
+    }
+
+    node->value_type = type;
+
+    return type;
+}
+
+/* expression, which value is used */
+static ConstType InferValue(TI_Setup* ti, AST_Node* node) {
+    assert( ti != NULL );
+
+    if (node == NULL) {
+        Error(ti, "missing operand", NULL);
+        return CONST_TYPE_UNDEFINED;
+    }
+
+    ConstType type = InferExpression(ti, node);
+    if (type == CONST_TYPE_VOID) {
+        Error(ti, "void value is used", AST_IsOperation(node, AST_ELEM_OPERATION_CALL)
+                                        ? node->right->data.variable : NULL);
+    }
+
+    return type;
+}
+
+/* every argument link gets the type of its parameter */
+static ConstType InferCall(TI_Setup* ti, AST_Node* call) {
+    assert( ti   != NULL );
+    assert( call != NULL );
+
+    const char* name = call->right->data.variable;
+
+    AST_Node* func_dec = FindFunction(ti->ast, name);
+    if (func_dec == NULL) {
+        Error(ti, "call of the unknown function", name);
+    }
+
+    AST_Node* param = func_dec != NULL ? func_dec->right->left : NULL;
+
+    for (AST_Node* arg = call->left; arg != NULL; arg = arg->left) {
+        InferValue(ti, arg->right);
+
+        if (param != NULL) {
+            arg->value_type = param->data.declaration_type;
+            param = param->left;
+        } else if (func_dec != NULL) {
+            Error(ti, "too many arguments", name);
+            func_dec = NULL;
+        }
+    }
+
+    if (param != NULL) {
+        Error(ti, "too few arguments", name);
+    }
+
+    call->right->value_type = func_dec != NULL ? func_dec->data.declaration_type : CONST_TYPE_INT;
+
+    return call->right->value_type;
+}
+
+// =================================== HELPERS ===================================
+
+static void Bind(TI_Setup* ti, const char* name, ConstType type) {
+    assert( ti   != NULL );
+    assert( name != NULL );
+
+    TI_Binding binding = {
+        .name = name,
+        .type = type
+    };
+
+    BufferPush(ti->bindings, &binding, sizeof(TI_Binding));
+}
+
+static ConstType LookUp(TI_Setup* ti, AST_Node* variable) {
+    assert( ti       != NULL );
+    assert( variable != NULL );
+
+    const TI_Binding* bindings = (const TI_Binding*)ti->bindings->data;
+    for (size_t i = ti->bindings->size; i-- > 0; ) {
+        if (strcmp(bindings[i].name, variable->data.variable) == 0) {
+            variable->value_type = bindings[i].type;
+            return bindings[i].type;
+        }
+    }
+
+    Error(ti, "unknown variable", variable->data.variable);
+
+    variable->value_type = CONST_TYPE_INT;
+
+    return CONST_TYPE_INT;
+}
+
+static AST_Node* FindFunction(const AST* ast, const char* name) {
+    assert( ast  != NULL );
+    assert( name != NULL );
+
+    for (AST_Node* link = ast->root; link != NULL; link = AST_ChainNext(link)) {
+        AST_Node* statement = AST_ChainStatement(link);
+
+        if (AST_IsFuncDec(statement) && strcmp(statement->right->data.variable, name) == 0) {
+            return statement;
+        }
+    }
+
+    return NULL;
+}
+
+/* char and short are promoted to int as in C */
+static ConstType CommonType(ConstType left, ConstType right) {
+    if (left == CONST_TYPE_DOUBLE || right == CONST_TYPE_DOUBLE) {
+        return CONST_TYPE_DOUBLE;
+    }
+
+    if (left == CONST_TYPE_LONG || right == CONST_TYPE_LONG) {
+        return CONST_TYPE_LONG;
+    }
+
+    return CONST_TYPE_INT;
+}
+
+static void Error(TI_Setup* ti, const char* message, const char* name) {
+    assert( ti      != NULL );
+    assert( message != NULL );
+
+    const char* func_name = ti->func != NULL ? ti->func->right->data.variable : "global scope";
+
+    if (name != NULL) {
+        fprintf(stderr, "TypeInference: %s: %s \"%s\"\n", func_name, message, name);
+    } else {
+        fprintf(stderr, "TypeInference: %s: %s\n", func_name, message);
+    }
+
+    ti->error_cnt++;
+}
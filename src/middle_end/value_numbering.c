@@ -0,0 +1,266 @@
+#include "../../include/middle_end/value_numbering.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "../../include/utils.h"
+#include "../../include/middle_end/ir.h"
+#include "../../clibs/Buffer/include/buffer.h"
+
+typedef struct VN_Expr {
+    IR_Opcode opcode;
+    ConstType type;
+    size_t args[2];
+    int imm;
+    size_t value;           // first value, which computed the expression
+} VN_Expr;
+
+typedef struct VN_Setup {
+    IR_Function* func;
+    size_t* leader;         // value, which replaces the redundant one
+    Buffer_t* available;    // VN_Expr, expressions of the dominating blocks, inner ones are at the end
+    Buffer_t** dom_children;
+    size_t removed_cnt;
+} VN_Setup;
+
+static MiddleEndErr_t FunctionValueNumbering(IR_Function* func, size_t* removed_cnt);
+static void NumberBlock(VN_Setup* vn, size_t id);
+static bool NumberInstr(VN_Setup* vn, IR_Instr* instr);
+static bool NumberPhi(VN_Setup* vn, IR_Instr* phi);
+static void ReplaceOperands(VN_Setup* vn);
+
+static size_t Leader(const VN_Setup* vn, size_t value);
+static bool IsNumbered(IR_Opcode opcode);
+
+/*
+ * Dominator based value numbering on SSA form: pure expression, which was already computed
+ * in the dominating code with the same operands, and copies are replaced by the first value.
+ * Variable reads are copies in IR, so reads without a store in between share one value.
+ */
+MiddleEndErr_t ValueNumbering(IR_Module* module, size_t* removed_cnt) {
+    assert( module      != NULL );
+    assert( removed_cnt != NULL );
+
+    *removed_cnt = 0;
+
+    IR_Function** functions = (IR_Function**)module->functions->data;
+    for (size_t i = 0; i < module->functions->size; i++) {
+        // without SSA one value may have several definitions
+        if (!functions[i]->is_ssa) {
+            continue;
+        }
+
+        MiddleEndErr_t flag = FunctionValueNumbering(functions[i], removed_cnt);
+        if (flag != MIDDLE_END_OK) {
+            return flag;
+        }
+    }
+
+    return MIDDLE_END_OK;
+}
+
+static MiddleEndErr_t FunctionValueNumbering(IR_Function* func, size_t* removed_cnt) {
+    assert( func        != NULL );
+    assert( removed_cnt != NULL );
+
+    MiddleEndErr_t flag = IR_ComputeDominators(func);
+    if (flag != MIDDLE_END_OK) {
+        return flag;
+    }
+
+    size_t value_cnt = IR_ValueCount(func);
+    size_t block_cnt = IR_BlockCount(func);
+
+    VN_Setup vn = {
+        .func         = func,
+        .leader       = (size_t*)calloc(value_cnt + 1, sizeof(size_t)),
+        .available    = BufferInit(0, sizeof(VN_Expr)),
+        .dom_children = (Buffer_t**)calloc(block_cnt + 1, sizeof(Buffer_t*)),
+        .removed_cnt  = 0
+    };
+
+    if (vn.leader != NULL && vn.available != NULL && vn.dom_children != NULL) {
+        for (size_t i = 0; i < block_cnt && flag == MIDDLE_END_OK; i++) {
+            vn.dom_children[i] = BufferInit(0, sizeof(size_t));
+            if (vn.dom_children[i] == NULL) {
+                flag = MIDDLE_END_BUFFER_FAILED;
+            }
+        }
+    } else {
+        flag = MIDDLE_END_BUFFER_FAILED;
+    }
+
+    if (flag == MIDDLE_END_OK) {
+        for (size_t i = 0; i < value_cnt; i++) {
+            vn.leader[i] = i;
+        }
+
+        for (size_t i = 1; i < block_cnt; i++) {
+            IR_Block* block = IR_GetBlock(func, i);
+            BufferPush(vn.dom_children[block->idom], &block->id, sizeof(size_t));
+        }
+
+        NumberBlock(&vn, 0);
+        ReplaceOperands(&vn);
+        IR_RemoveNops(func);
+
+        *removed_cnt += vn.removed_cnt;
+    }
+
+    if (vn.dom_children != NULL) {
+        for (size_t i = 0; i < block_cnt; i++) {
+            if (vn.dom_children[i] != NULL) {
+                BufferDestroy(&vn.dom_children[i]);
+            }
+        }
+        FREE(vn.dom_children);
+    }
+    if (vn.available != NULL) {
+        BufferDestroy(&vn.available);
+    }
+    FREE(vn.leader);
+
+    return flag;
+}
+
+static void NumberBlock(VN_Setup* vn, size_t id) {
+    assert( vn != NULL );
+
+    IR_Block* block = IR_GetBlock(vn->func, id);
+    size_t available_size = vn->available->size;
+
+    for (size_t i = 0; i < IR_InstrCount(block); i++) {
+        IR_Instr* instr = IR_GetInstr(block, i);
+
+        bool is_redundant = instr->opcode == IR_OP_PHI ? NumberPhi(vn, instr) : NumberInstr(vn, instr);
+        if (is_redundant) {
+            IR_InstrClear(instr);
+            vn->removed_cnt++;
+        }
+    }
+
+    const size_t* children = (const size_t*)vn->dom_children[id]->data;
+    for (size_t i = 0; i < vn->dom_children[id]->size; i++) {
+        NumberBlock(vn, children[i]);
+    }
+
+    vn->available->size = available_size; // expressions of the block do not dominate its siblings
+}
+
+/* returns true, if the instruction repeats the available value */
+static bool NumberInstr(VN_Setup* vn, IR_Instr* instr) {
+    assert( vn    != NULL );
+    assert( instr != NULL );
+
+    for (size_t i = 0; i < IR_OperandCount(instr); i++) {
+        size_t* operand = IR_Operand(instr, i);
+        *operand = Leader(vn, *operand);
+    }
+
+    if (instr->opcode == IR_OP_COPY) {
+        vn->leader[instr->dst] = instr->args[0];
+        return true;
+    }
+
+    if (!IsNumbered(instr->opcode)) {
+        return false;
+    }
+
+    VN_Expr expr = {
+        .opcode = instr->opcode,
+        .type   = instr->type,
+        .args   = {instr->args[0], instr->args[1]},
+        .imm    = instr->opcode == IR_OP_CONST ? instr->imm : 0,
+        .value  = instr->dst
+    };
+
+    if (IR_IsCommutative(expr.opcode) && expr.args[0] > expr.args[1]) {
+        expr.args[0] = instr->args[1];
+        expr.args[1] = instr->args[0];
+    }
+
+    const VN_Expr* available = (const VN_Expr*)vn->available->data;
+    for (size_t i = 0; i < vn->available->size; i++) {
+        if (    available[i].opcode  == expr.opcode  && available[i].type    == expr.type
+             && available[i].args[0] == expr.args[0] && available[i].args[1] == expr.args[1]
+             && available[i].imm     == expr.imm ) {
+            vn->leader[instr->dst] = available[i].value;
+            return true;
+        }
+    }
+
+    BufferPush(vn->available, &expr, sizeof(VN_Expr));
+
+    return false;
+}
+
+/* phi with the same value from every predecessor is that value */
+static bool NumberPhi(VN_Setup* vn, IR_Instr* phi) {
+    assert( vn  != NULL );
+    assert( phi != NULL );
+
+    size_t same = IR_NO_VALUE;
+
+    const IR_PhiArg* phi_args = (const IR_PhiArg*)phi->phi_args->data;
+    for (size_t i = 0; i < phi->phi_args->size; i++) {
+        size_t value = Leader(vn, phi_args[i].value);
+
+        if (value == phi->dst || value == same) {
+            continue;
+        }
+        if (same != IR_NO_VALUE) {
+            return false;
+        }
+
+        same = value;
+    }
+
+    if (same == IR_NO_VALUE) {
+        return false;
+    }
+
+    vn->leader[phi->dst] = same;
+
+    return true;
+}
+
+/* phi arguments and uses in the loops are met before the definitions are numbered */
+static void ReplaceOperands(VN_Setup* vn) {
+    assert( vn != NULL );
+
+    for (size_t i = 0; i < IR_BlockCount(vn->func); i++) {
+        IR_Block* block = IR_GetBlock(vn->func, i);
+
+        for (size_t j = 0; j < IR_InstrCount(block); j++) {
+            IR_Instr* instr = IR_GetInstr(block, j);
+
+            for (size_t k = 0; k < IR_OperandCount(instr); k++) {
+                size_t* operand = IR_Operand(instr, k);
+                *operand = Leader(vn, *operand);
+            }
+
+            if (instr->opcode == IR_OP_PHI) {
+                IR_PhiArg* phi_args = (IR_PhiArg*)instr->phi_args->data;
+                for (size_t k = 0; k < instr->phi_args->size; k++) {
+                    phi_args[k].value = Leader(vn, phi_args[k].value);
+                }
+            }
+        }
+    }
+}
+
+static size_t Leader(const VN_Setup* vn, size_t value) {
+    assert( vn != NULL );
+
+    while (vn->leader[value] != value) {
+        value = vn->leader[value];
+    }
+
+    return value;
+}
+
+/* division is numbered too: the first one stops the processor before the repeated one */
+static bool IsNumbered(IR_Opcode opcode) {
+    return opcode == IR_OP_CONST || IR_IsBinary(opcode);
+}
@@ -0,0 +1,730 @@
+#include "../../include/spu/spu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#define FREE(ptr) free(ptr); ptr = NULL;
+
+const size_t SPU_INITIAL_CAPACITY = 64;
+const size_t SPU_MAX_STACK_SIZE   = 1 << 20;    // cells of the data stack
+const size_t SPU_MAX_CALL_DEPTH   = 1 << 20;    // calls of the recursive program
+const size_t SPU_MAX_RAM_SIZE     = 1 << 24;    // cells of RAM of the recursive program
+const size_t SPU_MAX_STEPS        = 1ul << 36;
+
+static const char* const spu_instruction_names[SPU_INSTRUCTIONS_CNT] = {
+    "UNDEF", "IN",   "OUT",  "PUSH", "POP",   "PUSHR", "POPR", "ADD",  "SUB",  "MUL",
+    "DIV",   "SQRT", "JA",   "JAE",  "JB",    "JBE",   "JE",   "JNE",  "JMP",  "CALL",
+    "RET",   "HLT",  "PUSHM","POPM", "MAIN",  "SHL",   "SHR",  "FADD", "FSUB", "FMUL",
+    "FDIV",  "FJA",  "FJAE", "FJB",  "FJBE",  "FJE",   "FJNE", "ITOF", "FTOI", "FPUSH",
+    "FOUT",  "SELECT","PUSHL", "POPL"
+};
+
+static SPU_Err_t Execute(SPU* spu, InstructionType instruction, FILE* in, FILE* out);
+static SPU_Err_t Arithmetic(SPU* spu, InstructionType instruction);
+static SPU_Err_t FloatArithmetic(SPU* spu, InstructionType instruction);
+static SPU_Err_t ConditionalJump(SPU* spu, InstructionType instruction);
+static SPU_Err_t Select(SPU* spu);
+static SPU_Err_t Call(SPU* spu);
+static SPU_Err_t Memory(SPU* spu, InstructionType instruction);
+static SPU_Err_t FrameMemory(SPU* spu, InstructionType instruction);
+static bool Condition(InstructionType jump, long a, long b);
+
+static SPU_Err_t Fetch(SPU* spu, int* word);
+static SPU_Err_t FetchRegister(SPU* spu, size_t* reg);
+static SPU_Err_t Push(SPU* spu, long value);
+static SPU_Err_t Pop(SPU* spu, long* value);
+static SPU_Err_t RamCell(SPU* spu, long address, long** cell);
+static SPU_Err_t Grow(void** data, size_t* capacity, size_t elem_size, size_t min_capacity, size_t max_capacity);
+
+static double ToDouble(long cell);
+static long FromDouble(double value);
+
+/*
+ * File is start ip, code size and the code, then the call depth and RAM size of the program.
+ * The bounded program gets the exact call stack and RAM, the recursive one grows them up to the maximums.
+ */
+SPU_Err_t SPU_Load(SPU* spu, const char* file_name) {
+    assert( spu       != NULL );
+    assert( file_name != NULL );
+
+    memset(spu, 0, sizeof(SPU));
+
+    FILE* fp = fopen(file_name, "rb");
+    if (fp == NULL) {
+        return SPU_FOPEN_FAILED;
+    }
+
+    size_t header[2] = {};
+    if (fread(header, sizeof(size_t), 2, fp) != 2) {
+        fclose(fp);
+        return SPU_FREAD_FAILED;
+    }
+
+    spu->ip        = header[0];
+    spu->code_size = header[1];
+
+    spu->code = (int*)calloc(spu->code_size + 1, sizeof(int));
+    if (spu->code == NULL) {
+        fclose(fp);
+        return SPU_ALLOC_FAILED;
+    }
+
+    if (fread(spu->code, sizeof(int), spu->code_size, fp) != spu->code_size) {
+        fclose(fp);
+        SPU_Destroy(spu);
+        return SPU_FREAD_FAILED;
+    }
+
+    // bytecode of the old compilers has no bounds
+    size_t bounds[2] = {};
+    if (fread(bounds, sizeof(size_t), 2, fp) == 2) {
+        spu->call_depth_bound = bounds[0];
+        spu->ram_bound        = bounds[1];
+    }
+
+    fclose(fp);
+
+    bool bounded = spu->call_depth_bound != 0;
+
+    SPU_Err_t flag = Grow((void**)&spu->stack, &spu->stack_capacity, sizeof(long),
+                          SPU_INITIAL_CAPACITY, SPU_MAX_STACK_SIZE);
+    if (flag == SPU_OK) {
+        flag = Grow((void**)&spu->calls, &spu->call_capacity, sizeof(size_t),
+                    bounded ? spu->call_depth_bound : SPU_INITIAL_CAPACITY, SPU_MAX_CALL_DEPTH);
+    }
+    if (flag == SPU_OK) {
+        flag = Grow((void**)&spu->ram, &spu->ram_capacity, sizeof(long),
+                    bounded ? spu->ram_bound : SPU_INITIAL_CAPACITY, SPU_MAX_RAM_SIZE);
+    }
+
+    if (flag != SPU_OK) {
+        SPU_Destroy(spu);
+    }
+
+    return flag;
+}
+
+SPU_Err_t SPU_Destroy(SPU* spu) {
+    assert( spu != NULL );
+
+    FREE(spu->code);
+    FREE(spu->stack);
+    FREE(spu->calls);
+    FREE(spu->ram);
+
+    spu->code_size      = 0;
+    spu->stack_capacity = 0;
+    spu->call_capacity  = 0;
+    spu->ram_capacity   = 0;
+
+    return SPU_OK;
+}
+
+/* runs until HLT, the statistics stay in the processor after an error too */
+SPU_Err_t SPU_Run(SPU* spu, FILE* in, FILE* out) {
+    assert( spu  != NULL );
+    assert( in   != NULL );
+    assert( out  != NULL );
+
+    while (true) {
+        if (spu->stats.steps++ == SPU_MAX_STEPS) {
+            return SPU_STEPS_LIMIT;
+        }
+
+        int word = 0;
+        SPU_Err_t flag = Fetch(spu, &word);
+        if (flag != SPU_OK) {
+            return flag;
+        }
+
+        if (word <= UNDEF || (size_t)word >= SPU_INSTRUCTIONS_CNT) {
+            return SPU_INVALID_INSTRUCTION;
+        }
+
+        InstructionType instruction = (InstructionType)word;
+        spu->stats.executed[instruction]++;
+
+        if (instruction == HLT) {
+            return SPU_OK;
+        }
+
+        flag = Execute(spu, instruction, in, out);
+        if (flag != SPU_OK) {
+            return flag;
+        }
+    }
+}
+
+// ================================ INSTRUCTIONS ================================
+
+static SPU_Err_t Execute(SPU* spu, InstructionType instruction, FILE* in, FILE* out) {
+    assert( spu != NULL );
+
+    long value = 0;
+    int  word  = 0;
+    SPU_Err_t flag = SPU_OK;
+
+    switch (instruction) {
+    case PUSH:
+        flag = Fetch(spu, &word);
+        return flag == SPU_OK ? Push(spu, word) : flag;
+
+    // the words of the double are its bytes, the low one first
+    case FPUSH: {
+        int words[2] = {};
+        flag = Fetch(spu, &words[0]);
+        if (flag == SPU_OK) {
+            flag = Fetch(spu, &words[1]);
+        }
+
+        double number = 0;
+        memcpy(&number, words, sizeof(number));
+
+        return flag == SPU_OK ? Push(spu, FromDouble(number)) : flag;
+    }
+
+    case POP:
+        return Pop(spu, &value);
+
+    case PUSHR:
+    case POPR: {
+        size_t reg = 0;
+        flag = FetchRegister(spu, &reg);
+        if (flag != SPU_OK) {
+            return flag;
+        }
+
+        return instruction == PUSHR ? Push(spu, spu->regs[reg]) : Pop(spu, &spu->regs[reg]);
+    }
+
+    case PUSHM:
+    case POPM:
+        return Memory(spu, instruction);
+
+    case PUSHL:
+    case POPL:
+        return FrameMemory(spu, instruction);
+
+    case ADD:
+    case SUB:
+    case MUL:
+    case DIV:
+    case SHL:
+    case SHR:
+        return Arithmetic(spu, instruction);
+
+    case FADD:
+    case FSUB:
+    case FMUL:
+    case FDIV:
+        return FloatArithmetic(spu, instruction);
+
+    case SQRT:
+        flag = Pop(spu, &value);
+        return flag == SPU_OK ? Push(spu, (long)sqrt((double)value)) : flag;
+
+    case ITOF:
+        flag = Pop(spu, &value);
+        return flag == SPU_OK ? Push(spu, FromDouble((double)value)) : flag;
+
+    case FTOI:
+        flag = Pop(spu, &value);
+        return flag == SPU_OK ? Push(spu, (long)ToDouble(value)) : flag;
+
+    case IN:
+        if (fscanf(in, "%ld", &value) != 1) {
+            return SPU_INPUT_FAILED;
+        }
+        return Push(spu, value);
+
+    case OUT:
+        flag = Pop(spu, &value);
+        if (flag == SPU_OK) {
+            fprintf(out, "%ld\n", value);
+        }
+        return flag;
+
+    case FOUT:
+        flag = Pop(spu, &value);
+        if (flag == SPU_OK) {
+            fprintf(out, "%g\n", ToDouble(value));
+        }
+        return flag;
+
+    case JA:
+    case JAE:
+    case JB:
+    case JBE:
+    case JE:
+    case JNE:
+    case FJA:
+    case FJAE:
+    case FJB:
+    case FJBE:
+    case FJE:
+    case FJNE:
+        return ConditionalJump(spu, instruction);
+
+    case JMP:
+        flag = Fetch(spu, &word);
+        spu->ip = (size_t)word;
+        return flag;
+
+    case CALL:
+        return Call(spu);
+
+    case RET:
+        if (spu->call_depth == 0) {
+            return SPU_STACK_UNDERFLOW;
+        }
+        spu->ip = spu->calls[--spu->call_depth];
+        return SPU_OK;
+
+    case SELECT:
+        return Select(spu);
+
+    case MAIN:
+        return SPU_OK;
+
+    case UNDEF:
+    case HLT:
+    default:
+        return SPU_INVALID_INSTRUCTION;
+    }
+}
+
+/* the right operand is on the top */
+static SPU_Err_t Arithmetic(SPU* spu, InstructionType instruction) {
+    assert( spu != NULL );
+
+    long a = 0, b = 0;
+
+    SPU_Err_t flag = Pop(spu, &b);
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &a);
+    }
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    switch (instruction) {
+    case ADD:   return Push(spu, (long)((unsigned long)a + (unsigned long)b));
+    case SUB:   return Push(spu, (long)((unsigned long)a - (unsigned long)b));
+    case MUL:   return Push(spu, (long)((unsigned long)a * (unsigned long)b));
+    case SHL:   return Push(spu, (long)((unsigned long)a << (b & 63)));
+    case SHR:   return Push(spu, a >> (b & 63));
+
+    case DIV:
+        if (b == 0) {
+            return SPU_DIVISION_BY_ZERO;
+        }
+        return Push(spu, a / b);
+
+    case UNDEF:     case IN:    case OUT:   case PUSH:  case POP:   case PUSHR: case POPR:
+    case SQRT:      case JA:    case JAE:   case JB:    case JBE:   case JE:    case JNE:
+    case JMP:       case CALL:  case RET:   case HLT:   case PUSHM: case POPM:  case MAIN:
+    case FADD:      case FSUB:  case FMUL:  case FDIV:  case FJA:   case FJAE:  case FJB:
+    case FJBE:      case FJE:   case FJNE:  case ITOF:  case FTOI:  case FPUSH: case FOUT:
+    case SELECT:    case PUSHL: case POPL:
+    default:
+        return SPU_INVALID_INSTRUCTION;
+    }
+}
+
+static SPU_Err_t FloatArithmetic(SPU* spu, InstructionType instruction) {
+    assert( spu != NULL );
+
+    long a = 0, b = 0;
+
+    SPU_Err_t flag = Pop(spu, &b);
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &a);
+    }
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    double left  = ToDouble(a);
+    double right = ToDouble(b);
+
+    switch (instruction) {
+    case FADD:  return Push(spu, FromDouble(left + right));
+    case FSUB:  return Push(spu, FromDouble(left - right));
+    case FMUL:  return Push(spu, FromDouble(left * right));
+    case FDIV:  return Push(spu, FromDouble(left / right));
+
+    case UNDEF:     case IN:    case OUT:   case PUSH:  case POP:   case PUSHR: case POPR:
+    case ADD:       case SUB:   case MUL:   case DIV:   case SQRT:  case JA:    case JAE:
+    case JB:        case JBE:   case JE:    case JNE:   case JMP:   case CALL:  case RET:
+    case HLT:       case PUSHM: case POPM:  case MAIN:  case SHL:   case SHR:   case FJA:
+    case FJAE:      case FJB:   case FJBE:  case FJE:   case FJNE:  case ITOF:  case FTOI:
+    case FPUSH:     case FOUT:  case SELECT: case PUSHL: case POPL:
+    default:
+        return SPU_INVALID_INSTRUCTION;
+    }
+}
+
+/* b is popped first, the jump is taken if "b OP a" holds */
+static SPU_Err_t ConditionalJump(SPU* spu, InstructionType instruction) {
+    assert( spu != NULL );
+
+    int target = 0;
+    long a = 0, b = 0;
+
+    SPU_Err_t flag = Fetch(spu, &target);
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &b);
+    }
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &a);
+    }
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    if (Condition(instruction, a, b)) {
+        spu->ip = (size_t)target;
+    }
+
+    return SPU_OK;
+}
+
+/*
+ * SELECT jump: the stack is [then, else, a, b], b is on the top.
+ * Leaves then, if the jump would be taken on a and b, and else otherwise.
+ */
+static SPU_Err_t Select(SPU* spu) {
+    assert( spu != NULL );
+
+    int jump = 0;
+    long values[2] = {};
+    long a = 0, b = 0;
+
+    SPU_Err_t flag = Fetch(spu, &jump);
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &b);
+    }
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &a);
+    }
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &values[1]);
+    }
+    if (flag == SPU_OK) {
+        flag = Pop(spu, &values[0]);
+    }
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    if (!((JA <= jump && jump <= JNE) || (FJA <= jump && jump <= FJNE))) {
+        return SPU_INVALID_INSTRUCTION;
+    }
+
+    return Push(spu, Condition((InstructionType)jump, a, b) ? values[0] : values[1]);
+}
+
+static SPU_Err_t Call(SPU* spu) {
+    assert( spu != NULL );
+
+    int target = 0;
+    SPU_Err_t flag = Fetch(spu, &target);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    if (spu->call_depth == spu->call_capacity) {
+        // the bounded program can not go deeper than its bound
+        if (spu->call_depth_bound != 0) {
+            return SPU_CALL_OVERFLOW;
+        }
+
+        flag = Grow((void**)&spu->calls, &spu->call_capacity, sizeof(size_t),
+                    spu->call_capacity * 2, SPU_MAX_CALL_DEPTH);
+        if (flag != SPU_OK) {
+            return SPU_CALL_OVERFLOW;
+        }
+    }
+
+    spu->calls[spu->call_depth++] = spu->ip;
+    spu->ip = (size_t)target;
+
+    if (spu->call_depth > spu->stats.max_call_depth) {
+        spu->stats.max_call_depth = spu->call_depth;
+    }
+
+    return SPU_OK;
+}
+
+/* PUSHM [REG] and POPM [REG] address the cell by the value of the register */
+static SPU_Err_t Memory(SPU* spu, InstructionType instruction) {
+    assert( spu != NULL );
+
+    size_t reg = 0;
+    SPU_Err_t flag = FetchRegister(spu, &reg);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    long* cell = NULL;
+    flag = RamCell(spu, spu->regs[reg], &cell);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    return instruction == PUSHM ? Push(spu, *cell) : Pop(spu, cell);
+}
+
+/* PUSHL n and POPL n address the cell n of the frame, which starts at RBX */
+static SPU_Err_t FrameMemory(SPU* spu, InstructionType instruction) {
+    assert( spu != NULL );
+
+    int offset = 0;
+    SPU_Err_t flag = Fetch(spu, &offset);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    long* cell = NULL;
+    flag = RamCell(spu, spu->regs[RBX] + offset, &cell);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    return instruction == PUSHL ? Push(spu, *cell) : Pop(spu, cell);
+}
+
+static bool Condition(InstructionType jump, long a, long b) {
+    double fa = ToDouble(a);
+    double fb = ToDouble(b);
+
+    switch (jump) {
+    case JA:    return b >  a;
+    case JAE:   return b >= a;
+    case JB:    return b <  a;
+    case JBE:   return b <= a;
+    case JE:    return b == a;
+    case JNE:   return b != a;
+
+    case FJA:   return fb >  fa;
+    case FJAE:  return fb >= fa;
+    case FJB:   return fb <  fa;
+    case FJBE:  return fb <= fa;
+    case FJE:   return !(fb < fa) && !(fb > fa);
+    case FJNE:  return fb < fa || fb > fa;
+
+    case UNDEF:     case IN:    case OUT:   case PUSH:  case POP:   case PUSHR: case POPR:
+    case ADD:       case SUB:   case MUL:   case DIV:   case SQRT:  case JMP:   case CALL:
+    case RET:       case HLT:   case PUSHM: case POPM:  case MAIN:  case SHL:   case SHR:
+    case FADD:      case FSUB:  case FMUL:  case FDIV:  case ITOF:  case FTOI:  case FPUSH:
+    case FOUT:      case SELECT: case PUSHL: case POPL:
+    default:
+        return false;
+    }
+}
+
+// =================================== STATE ===================================
+
+static SPU_Err_t Fetch(SPU* spu, int* word) {
+    assert( spu  != NULL );
+    assert( word != NULL );
+
+    if (spu->ip >= spu->code_size) {
+        return SPU_INVALID_ADDRESS;
+    }
+
+    *word = spu->code[spu->ip++];
+
+    return SPU_OK;
+}
+
+static SPU_Err_t FetchRegister(SPU* spu, size_t* reg) {
+    assert( spu != NULL );
+    assert( reg != NULL );
+
+    int word = 0;
+    SPU_Err_t flag = Fetch(spu, &word);
+    if (flag != SPU_OK) {
+        return flag;
+    }
+
+    if (word < RAX || word > RCX) {
+        return SPU_INVALID_REGISTER;
+    }
+
+    *reg = (size_t)word;
+
+    return SPU_OK;
+}
+
+static SPU_Err_t Push(SPU* spu, long value) {
+    assert( spu != NULL );
+
+    if (spu->stack_size == spu->stack_capacity) {
+        SPU_Err_t flag = Grow((void**)&spu->stack, &spu->stack_capacity, sizeof(long),
+                              spu->stack_capacity * 2, SPU_MAX_STACK_SIZE);
+        if (flag != SPU_OK) {
+            return SPU_STACK_OVERFLOW;
+        }
+    }
+
+    spu->stack[spu->stack_size++] = value;
+
+    return SPU_OK;
+}
+
+static SPU_Err_t Pop(SPU* spu, long* value) {
+    assert( spu   != NULL );
+    assert( value != NULL );
+
+    if (spu->stack_size == 0) {
+        return SPU_STACK_UNDERFLOW;
+    }
+
+    *value = spu->stack[--spu->stack_size];
+
+    return SPU_OK;
+}
+
+/* RAM of the recursive program grows to the touched cell */
+static SPU_Err_t RamCell(SPU* spu, long address, long** cell) {
+    assert( spu  != NULL );
+    assert( cell != NULL );
+
+    if (address < 0) {
+        return SPU_INVALID_ADDRESS;
+    }
+
+    size_t index = (size_t)address;
+
+    if (index >= spu->ram_capacity) {
+        if (spu->call_depth_bound != 0) {
+            return SPU_RAM_OVERFLOW;
+        }
+
+        size_t capacity = spu->ram_capacity * 2 > index + 1 ? spu->ram_capacity * 2 : index + 1;
+
+        SPU_Err_t flag = Grow((void**)&spu->ram, &spu->ram_capacity, sizeof(long), capacity, SPU_MAX_RAM_SIZE);
+        if (flag != SPU_OK) {
+            return SPU_RAM_OVERFLOW;
+        }
+    }
+
+    if (index + 1 > spu->stats.ram_cells) {
+        spu->stats.ram_cells = index + 1;
+    }
+
+    *cell = &spu->ram[index];
+
+    return SPU_OK;
+}
+
+/* new cells are zeros */
+static SPU_Err_t Grow(void** data, size_t* capacity, size_t elem_size, size_t min_capacity, size_t max_capacity) {
+    assert( data     != NULL );
+    assert( capacity != NULL );
+
+    if (min_capacity > max_capacity) {
+        return SPU_ALLOC_FAILED;
+    }
+
+    if (min_capacity <= *capacity && *data != NULL) {
+        return SPU_OK;
+    }
+
+    size_t new_capacity = min_capacity != 0 ? min_capacity : 1;
+
+    void* new_data = realloc(*data, new_capacity * elem_size);
+    if (new_data == NULL) {
+        return SPU_ALLOC_FAILED;
+    }
+
+    memset((char*)new_data + *capacity * elem_size, 0, (new_capacity - *capacity) * elem_size);
+
+    *data = new_data;
+    *capacity = new_capacity;
+
+    return SPU_OK;
+}
+
+static double ToDouble(long cell) {
+    double value = 0;
+    memcpy(&value, &cell, sizeof(value));
+
+    return value;
+}
+
+static long FromDouble(double value) {
+    long cell = 0;
+    memcpy(&cell, &value, sizeof(cell));
+
+    return cell;
+}
+
+// ==================================== DUMP ====================================
+
+const char* SPU_InstructionName(size_t instruction) {
+    return instruction < SPU_INSTRUCTIONS_CNT ? spu_instruction_names[instruction] : "?";
+}
+
+const char* SPU_ErrorName(SPU_Err_t error) {
+    switch (error) {
+    case SPU_OK:                    return "ok";
+    case SPU_FOPEN_FAILED:          return "can not open the bytecode";
+    case SPU_FREAD_FAILED:          return "can not read the bytecode";
+    case SPU_ALLOC_FAILED:          return "out of memory";
+    case SPU_INVALID_INSTRUCTION:   return "invalid instruction";
+    case SPU_INVALID_ADDRESS:       return "invalid address";
+    case SPU_INVALID_REGISTER:      return "invalid register";
+    case SPU_STACK_UNDERFLOW:       return "stack underflow";
+    case SPU_STACK_OVERFLOW:        return "stack overflow";
+    case SPU_CALL_OVERFLOW:         return "call stack overflow";
+    case SPU_RAM_OVERFLOW:          return "RAM overflow";
+    case SPU_DIVISION_BY_ZERO:      return "division by zero";
+    case SPU_INPUT_FAILED:          return "input failed";
+    case SPU_STEPS_LIMIT:           return "steps limit";
+    default:                        return "unknown error";
+    }
+}
+
+/* executed instructions, the most frequent first */
+void SPU_DumpStats(const SPU* spu, FILE* fp) {
+    assert( spu != NULL );
+    assert( fp  != NULL );
+
+    fprintf(fp, "steps: %zu\n", spu->stats.steps);
+
+    fprintf(fp, "call depth: %zu", spu->stats.max_call_depth);
+    if (spu->call_depth_bound != 0) {
+        fprintf(fp, " of %zu", spu->call_depth_bound);
+    }
+
+    fprintf(fp, "\nRAM: %zu cells", spu->stats.ram_cells);
+    if (spu->call_depth_bound != 0) {
+        fprintf(fp, " of %zu", spu->ram_bound);
+    }
+    fprintf(fp, "\n");
+
+    bool printed[SPU_INSTRUCTIONS_CNT] = {};
+
+    for (size_t i = 0; i < SPU_INSTRUCTIONS_CNT; i++) {
+        size_t most = SPU_INSTRUCTIONS_CNT;
+
+        for (size_t j = 0; j < SPU_INSTRUCTIONS_CNT; j++) {
+            if (    !printed[j] && spu->stats.executed[j] != 0
+                &&  (most == SPU_INSTRUCTIONS_CNT || spu->stats.executed[j] > spu->stats.executed[most]) ) {
+                most = j;
+            }
+        }
+
+        if (most == SPU_INSTRUCTIONS_CNT) {
+            break;
+        }
+
+        printed[most] = true;
+        fprintf(fp, "%8zu %s\n", spu->stats.executed[most], SPU_InstructionName(most));
+    }
+}
@@ -9,6 +9,23 @@
 
 const int INITIAL_CAPACITY = 8;
 
+static SymbolBinding* Bindings(SymbolTable* table);
+static SymbolBinding* InnermostBinding(SymbolTable* table, const char* symbol_name);
+static SymbolTableErr_t NewBinding(SymbolTable* table, size_t* binding);
+static void Unbind(SymbolTable* table, size_t binding);
+static void SetBranchActive(SymbolTable* table, Scope* scope, bool active);
+static SymbolBinding* InlineBinding(SymbolTable* table, const Scope* scope, const char* symbol_name);
+
+/*
+ * Each name has one slot in the map with its innermost binding, the binding keeps the one it shadows.
+ * The scope logs its bindings, they are undone on the exit, so the lookup takes one hash
+ * at any depth of the scopes. Bindings of the branch, which is put aside, stay in the stacks,
+ * but they are skipped, until the branch is back.
+ * The first symbols of the scope are also kept in its inline array, so the small scope
+ * checks the redeclaration by the comparison of the names without the hashing.
+ * All the bindings are in the map, whatever the size of their scope: the lookup of the name,
+ * which is not in the current scope, would have to search the inline arrays of all the outer ones.
+ */
 SymbolTable* SymbolTableInit() {
     SymbolTable* table = (SymbolTable*)calloc(1, sizeof(SymbolTable));
     if (table == NULL) {
@@ -16,16 +33,25 @@ SymbolTable* SymbolTableInit() {
     }
 
     table->current_scope = NULL;
+    table->free_scopes   = NULL;
+    table->free_bindings = SYM_TAB_NO_BINDING;
 
+    table->names    = HashTableInit();
+    table->bindings = BufferInit(0, sizeof(SymbolBinding));
     table->end_scopes = StackInit(INITIAL_CAPACITY, sizeof(Scope*), "end_scopes");
-    if (table->end_scopes == NULL) {
-        FREE(table);
-        return NULL;
-    }
 
-    if (SymbolTableEnterScope(table) != SYM_TAB_OK) {
+    if (    table->names == NULL || table->bindings == NULL || table->end_scopes == NULL
+        ||  SymbolTableEnterScope(table) != SYM_TAB_OK ) {
+        if (table->names != NULL) {
+            HashTableDestroy(&table->names);
+        }
+        if (table->bindings != NULL) {
+            BufferDestroy(&table->bindings);
+        }
+        if (table->end_scopes != NULL) {
+            StackDestroy(&table->end_scopes);
+        }
         FREE(table);
-        StackDestroy(&table->end_scopes);
         return NULL;
     }
 
@@ -34,23 +60,27 @@ SymbolTable* SymbolTableInit() {
     return table;
 }
 
+/* exited scopes are kept in the pool, so the nested blocks take no memory after the first ones */
 SymbolTableErr_t SymbolTableEnterScope(SymbolTable* table) {
     assert( table != NULL );
 
-    Scope* new_scope = (Scope*)calloc(1, sizeof(Scope));
-    if (new_scope == NULL) {
-        return SYM_TAB_CALLOC_SCOPE_FAILED;
+    Scope* new_scope = table->free_scopes;
+
+    if (new_scope != NULL) {
+        table->free_scopes = new_scope->prev;
+    } else {
+        new_scope = (Scope*)calloc(1, sizeof(Scope));
+        if (new_scope == NULL) {
+            return SYM_TAB_CALLOC_SCOPE_FAILED;
+        }
     }
 
     new_scope->prev = table->current_scope;
     table->current_scope = new_scope;
 
-    new_scope->symbols = HashTableInit();
-    if (new_scope->symbols == NULL) {
-        FREE(new_scope);
-        return SYM_TAB_HASH_TABLE_FAILED;
-    }
-
+    new_scope->active = true;
+    new_scope->symbols_cnt = 0;
+    new_scope->last_binding = SYM_TAB_NO_BINDING;
     new_scope->scope_ram_offset = 0;
 
     if (new_scope->prev != NULL) {
@@ -62,13 +92,44 @@ SymbolTableErr_t SymbolTableEnterScope(SymbolTable* table) {
     return SYM_TAB_OK;
 }
 
+/* block shares the frame of the enclosing scope: its symbols take the next free cells of it */
+SymbolTableErr_t SymbolTableEnterBlock(SymbolTable* table) {
+    assert( table != NULL );
+    assert( table->current_scope != NULL );
+
+    Scope* outer = table->current_scope;
+
+    SymbolTableErr_t flag = SymbolTableEnterScope(table);
+    if (flag != SYM_TAB_OK) {
+        return flag;
+    }
+
+    table->current_scope->level            = outer->level;
+    table->current_scope->scope_ram_offset = outer->scope_ram_offset;
+
+    return SYM_TAB_OK;
+}
+
 SymbolTableErr_t SymbolTableExitScope(SymbolTable* table) {
     assert( table != NULL );
 
     Scope* cur_scope = table->current_scope;
 
     cur_scope->level = 0;
-    HashTableDestroy(&cur_scope->symbols);
+
+    while (cur_scope->last_binding != SYM_TAB_NO_BINDING) {
+        size_t binding = cur_scope->last_binding;
+        cur_scope->last_binding = Bindings(table)[binding].scope_next;
+
+        Unbind(table, binding);
+    }
+
+    size_t inline_cnt = cur_scope->symbols_cnt < SCOPE_INLINE_SYMBOLS ? cur_scope->symbols_cnt : SCOPE_INLINE_SYMBOLS;
+    while (inline_cnt > 0) {
+        Unbind(table, cur_scope->inline_bindings[--inline_cnt]);
+    }
+
+    cur_scope->symbols_cnt = 0;
 
     if (cur_scope->prev == table->global_scope && !StackEmpty(table->end_scopes)) {
         Scope** scope_ptr = (Scope**)StackPop(table->end_scopes);
@@ -78,12 +139,14 @@ SymbolTableErr_t SymbolTableExitScope(SymbolTable* table) {
 
         table->current_scope = *scope_ptr;
         FREE(scope_ptr);
+
+        SetBranchActive(table, table->current_scope, true);
     } else {
         table->current_scope = cur_scope->prev;
     }
 
-    cur_scope->prev = NULL;
-    FREE(cur_scope);
+    cur_scope->prev = table->free_scopes;
+    table->free_scopes = cur_scope;
 
     return SYM_TAB_OK;
 }
@@ -97,9 +160,17 @@ SymbolTableErr_t SymbolTableDestroy(SymbolTable** table_ptr) {
     while (table->current_scope != NULL) {
         SymbolTableExitScope(table);
     }
-    
+
     table->global_scope = NULL;
 
+    while (table->free_scopes != NULL) {
+        Scope* scope = table->free_scopes;
+        table->free_scopes = scope->prev;
+        FREE(scope);
+    }
+
+    HashTableDestroy(&table->names);
+    BufferDestroy(&table->bindings);
     StackDestroy(&table->end_scopes);
 
     FREE(*table_ptr);
@@ -114,6 +185,8 @@ SymbolTableErr_t SymbolTableNewBranch(SymbolTable* table) {
         return SYM_TAB_STACK_FAILED;
     }
 
+    SetBranchActive(table, table->current_scope, false);
+
     table->current_scope = table->global_scope;
 
     return SYM_TAB_OK;
@@ -125,7 +198,7 @@ SymbolTableErr_t SymbolTableDelBranch(SymbolTable* table) {
     while (table->current_scope->prev != table->global_scope) {
         SymbolTableExitScope(table);
     }
-    
+
     SymbolTableExitScope(table);
 
     return SYM_TAB_OK;
@@ -135,51 +208,179 @@ SymbolData* SymbolTableLookUpCurrentScope(SymbolTable* table, const char* symbol
     assert( table != NULL );
     assert( symbol_name != NULL );
 
-    return (SymbolData*)HashTableFind(table->current_scope->symbols, 
-                                      symbol_name, strlen(symbol_name) + 1);
+    Scope* scope = table->current_scope;
+    SymbolBinding* binding = NULL;
+
+    if (scope->symbols_cnt <= SCOPE_INLINE_SYMBOLS) {
+        binding = InlineBinding(table, scope, symbol_name);
+    } else {
+        binding = InnermostBinding(table, symbol_name);
+    }
+
+    return binding != NULL && binding->scope == scope ? &binding->data : NULL;
 }
 
+/* the returned data stays valid until the next insert */
 SymbolData* SymbolTableLookUp(SymbolTable* table, const char* symbol_name) {
     assert( table != NULL );
     assert( symbol_name != NULL );
 
-    Scope* cur_scope = table->current_scope;
-    while (cur_scope != NULL) {
-        SymbolData* symbol_data = (SymbolData*)HashTableFind(cur_scope->symbols, 
-                                                             symbol_name, strlen(symbol_name) + 1);
-        if (symbol_data != NULL) {
-            return symbol_data;
-        }
+    SymbolBinding* binding = InnermostBinding(table, symbol_name);
 
-        cur_scope = cur_scope->prev;
-    }
-    
-    return NULL;
+    return binding != NULL ? &binding->data : NULL;
 }
 
+/* the name, which is already declared in the current scope, keeps its first symbol */
 SymbolTableErr_t SymbolTableInsert(SymbolTable* table,       const char* symbol_name,
-                                   SymbolType   symbol_type, DataType data_type, 
+                                   SymbolType   symbol_type, DataType data_type,
                                    void*        ast_node,    size_t symbol_ram_offset) {
     assert( table != NULL );
     assert( symbol_name != NULL );
 
     if (SymbolTableLookUpCurrentScope(table, symbol_name) != NULL) {
-        fprintf(stderr, "Symbol %s already declared in this scope\n", symbol_name); // DUMP
-        return SYM_TAB_OK;
+        return SYM_TAB_REDECLARED;
+    }
+
+    size_t* innermost = (size_t*)HashTableFind(table->names, symbol_name, strlen(symbol_name) + 1);
+
+    if (innermost == NULL) {
+        size_t no_binding = SYM_TAB_NO_BINDING;
+
+        if (HashTableInsert(table->names, symbol_name, strlen(symbol_name) + 1,
+                            &no_binding, sizeof(size_t)) != HASH_TABLE_OK) {
+            return SYM_TAB_HASH_TABLE_FAILED;
+        }
+
+        innermost = (size_t*)HashTableFind(table->names, symbol_name, strlen(symbol_name) + 1);
+    }
+
+    size_t binding = 0;
+
+    SymbolTableErr_t flag = NewBinding(table, &binding);
+    if (flag != SYM_TAB_OK) {
+        return flag;
     }
 
-    SymbolData symbol_data = {
-        .symbol_type = symbol_type,
-        .data_type = data_type,
-        .scope_level = table->current_scope->level,
-        .ast_node = ast_node,
-        .symbol_ram_offset = symbol_ram_offset
+    Scope* scope = table->current_scope;
+
+    Bindings(table)[binding] = {
+        .name = symbol_name,
+        .data = {
+            .symbol_type = symbol_type,
+            .data_type = data_type,
+            .scope_level = scope->level,
+            .ast_node = ast_node,
+            .symbol_ram_offset = symbol_ram_offset
+        },
+        .scope      = scope,
+        .innermost  = innermost,
+        .shadowed   = *innermost,
+        .scope_next = SYM_TAB_NO_BINDING
     };
 
-    if (HashTableInsert(table->current_scope->symbols, symbol_name, strlen(symbol_name) + 1, 
-                        &symbol_data, sizeof(SymbolData)) != HASH_TABLE_OK) {
-        return SYM_TAB_HASH_TABLE_FAILED;
+    *innermost = binding;
+
+    if (scope->symbols_cnt < SCOPE_INLINE_SYMBOLS) {
+        scope->inline_bindings[scope->symbols_cnt] = binding;
+    } else {
+        Bindings(table)[binding].scope_next = scope->last_binding;
+        scope->last_binding = binding;
     }
 
+    scope->symbols_cnt++;
+
     return SYM_TAB_OK;
 }
+
+// ================================== BINDINGS ==================================
+
+static SymbolBinding* Bindings(SymbolTable* table) {
+    assert( table != NULL );
+
+    return (SymbolBinding*)table->bindings->data;
+}
+
+/* bindings of the branch, which is put aside, are skipped */
+static SymbolBinding* InnermostBinding(SymbolTable* table, const char* symbol_name) {
+    assert( table != NULL );
+    assert( symbol_name != NULL );
+
+    const size_t* innermost = (const size_t*)HashTableFind(table->names, symbol_name, strlen(symbol_name) + 1);
+    if (innermost == NULL) {
+        return NULL;
+    }
+
+    size_t binding = *innermost;
+    while (binding != SYM_TAB_NO_BINDING && !Bindings(table)[binding].scope->active) {
+        binding = Bindings(table)[binding].shadowed;
+    }
+
+    return binding != SYM_TAB_NO_BINDING ? &Bindings(table)[binding] : NULL;
+}
+
+/* few symbols are found faster by the comparison of the names than by the hashing */
+static SymbolBinding* InlineBinding(SymbolTable* table, const Scope* scope, const char* symbol_name) {
+    assert( table       != NULL );
+    assert( scope       != NULL );
+    assert( symbol_name != NULL );
+
+    for (size_t i = 0; i < scope->symbols_cnt && i < SCOPE_INLINE_SYMBOLS; i++) {
+        SymbolBinding* binding = &Bindings(table)[scope->inline_bindings[i]];
+
+        if (strcmp(binding->name, symbol_name) == 0) {
+            return binding;
+        }
+    }
+
+    return NULL;
+}
+
+/* the bindings of the exited scopes are taken again */
+static SymbolTableErr_t NewBinding(SymbolTable* table, size_t* binding) {
+    assert( table   != NULL );
+    assert( binding != NULL );
+
+    if (table->free_bindings != SYM_TAB_NO_BINDING) {
+        *binding = table->free_bindings;
+        table->free_bindings = Bindings(table)[*binding].scope_next;
+
+        return SYM_TAB_OK;
+    }
+
+    SymbolBinding empty = {};
+
+    if (BufferPush(table->bindings, &empty, sizeof(SymbolBinding)) != BUFFER_OK) {
+        return SYM_TAB_BUFFER_FAILED;
+    }
+
+    *binding = table->bindings->size - 1;
+
+    return SYM_TAB_OK;
+}
+
+/* binding is the innermost one of its name, unless the scopes of the branches were mixed */
+static void Unbind(SymbolTable* table, size_t binding) {
+    assert( table != NULL );
+
+    SymbolBinding* bindings = Bindings(table);
+
+    size_t* link = bindings[binding].innermost;
+    while (*link != binding) {
+        link = &bindings[*link].shadowed;
+    }
+
+    *link = bindings[binding].shadowed;
+
+    bindings[binding].scope = NULL;
+    bindings[binding].scope_next = table->free_bindings;
+    table->free_bindings = binding;
+}
+
+/* scopes of the branch from the given one to the global scope */
+static void SetBranchActive(SymbolTable* table, Scope* scope, bool active) {
+    assert( table != NULL );
+
+    for (; scope != NULL && scope != table->global_scope; scope = scope->prev) {
+        scope->active = active;
+    }
+}
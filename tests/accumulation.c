@@ -0,0 +1,53 @@
+int sum_from(int n, int base) {
+    if (n == 0) {
+        return base;
+    }
+
+    return n + sum_from(n - 1, base);
+}
+
+int two_bases(int n) {
+    if (n == 0) {
+        return 2;
+    }
+
+    if (n == 1) {
+        return 5;
+    }
+
+    return two_bases(n - 2) * n;
+}
+
+int alternate(int a, int b, int n) {
+    if (n == 0) {
+        return a - b;
+    }
+
+    return a + alternate(b, a, n - 1);
+}
+
+int rotate(int a, int b, int c, int n) {
+    if (n == 0) {
+        return a * 100 + b * 10 + c;
+    }
+
+    return rotate(b, c, a, n - 1) + n;
+}
+
+int main() {
+    int three = 0;
+    while (three * three < 9) {
+        three = three + 1;
+    }
+
+    print(sum_from(three + 7, 100));
+    print(sum_from(0, three));
+    print(two_bases(three + 3));
+    print(two_bases(three + 4));
+    print(alternate(three, 10, 4));
+    print(alternate(three, 10, 5));
+    print(rotate(1, 2, three, 4));
+    print(rotate(1, 2, three, 5));
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+int twice(int n) {
+    return n + n;
+}
+
+int g = twice(3);
+
+int main() {
+    print(1);
+
+    return 0;
+}
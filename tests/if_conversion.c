@@ -0,0 +1,80 @@
+int safe_ratio(int a, int b) {
+    int r = 0;
+
+    if (b != 0) {
+        r = a / b;
+    } else {
+        r = a;
+    }
+
+    print(r);
+
+    return r;
+}
+
+int smaller(int a, int b) {
+    int m = 0;
+
+    if (a < b) {
+        m = a;
+    } else {
+        m = b;
+    }
+
+    print(m);
+
+    return m;
+}
+
+int sign(int x) {
+    int s = 0;
+
+    if (x < 0) {
+        s = 0 - 1;
+    } else if (x == 0) {
+        s = 0;
+    } else {
+        int one = 1;
+        s = one;
+    }
+
+    print(s);
+
+    return s;
+}
+
+int clamp_div(int a, int b) {
+    int q = 0;
+
+    if (b == 0) {
+        q = 0;
+    } else if (a / b > 10) {
+        q = 10;
+    } else {
+        q = a / b;
+    }
+
+    print(q);
+
+    return q;
+}
+
+int main() {
+    int three = 0;
+    while (three * three < 9) {
+        three = three + 1;
+    }
+
+    int r = safe_ratio(7 * three, three);
+    r = safe_ratio(three, three - 3);
+    r = smaller(three, 5);
+    r = smaller(three + 5, 5);
+    r = sign(three - 4);
+    r = sign(three - 3);
+    r = sign(three);
+    r = clamp_div(100, three);
+    r = clamp_div(100, three - 3);
+    r = clamp_div(20, three);
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+int scale(int x) {
+    int t = x * 2;
+
+    return t + 1;
+}
+
+int twice(int t) {
+    int x = scale(t);
+
+    return x + scale(x);
+}
+
+int main() {
+    int x = 5;
+    int t = 7;
+
+    int r = scale(t);
+    print(r);
+    print(x);
+    print(t);
+
+    int y = twice(x);
+    print(y);
+
+    if (x > 0) {
+        int x = scale(x + 1);
+        int t = twice(x);
+        print(x);
+        print(t);
+    }
+
+    print(x + t);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+int inclusive_short(int n) {
+    int i = 1;
+    int s = 0;
+
+    while (i <= 5) {
+        s = s + i * n;
+        i = i + 1;
+    }
+
+    print(s);
+    print(i);
+
+    return 0;
+}
+
+int inclusive_long(int n) {
+    int i = 0;
+    int s = 0;
+
+    while (i <= 102) {
+        s = s + i + n;
+        i = i + 1;
+    }
+
+    print(s);
+    print(i);
+
+    return 0;
+}
+
+int stepped(int n) {
+    int i = 2;
+    int s = 0;
+
+    while (i < 100) {
+        int t = i * n;
+        s = s + t;
+        i = 3 + i;
+    }
+
+    print(s);
+    print(i);
+
+    return 0;
+}
+
+int stepped_inclusive(int n) {
+    int i = 0;
+    int s = 0;
+
+    while (i <= 60) {
+        s = s * 2 + i - n;
+        s = s - s / 1000 * 1000;
+        i = i + 5;
+    }
+
+    print(s);
+    print(i);
+
+    return 0;
+}
+
+int empty_range(int n) {
+    int i = 10;
+    int s = n;
+
+    while (i <= 9) {
+        s = s + 1;
+        i = i + 1;
+    }
+
+    print(s);
+    print(i);
+
+    return 0;
+}
+
+int main() {
+    int r = inclusive_short(3);
+    r = inclusive_long(2);
+    r = stepped(1);
+    r = stepped_inclusive(7);
+    r = empty_range(4);
+
+    return r;
+}
@@ -0,0 +1,14 @@
+int square(int n) {
+    return n * n;
+}
+
+int main() {
+    print(2147483647 + 1);
+
+    int big = 65536;
+    print(big * big);
+
+    print(square(100000));
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#!/bin/bash
+# runs from the root of the repo after lang_script.sh:
+# each tests/NAME.c is compiled in every mode, its output must be tests/NAME.txt
+
+modes=("-O0" "-O1" "-O2" "-O2 -memo" "-O2 -ir" "-O2 -ir -ssa")
+
+root=$(pwd)
+work=$(mktemp -d)
+failed=0
+
+for test in tests/*.c; do
+    name=$(basename "$test" .c)
+
+    for mode in "${modes[@]}"; do
+        cp "$test" "$work/syntax_test.c"
+
+        if ! (cd "$work" && "$root/lang" $mode > /dev/null 2>&1 && "$root/spu" bytecode.bin > output.txt 2>&1) \
+           || ! diff -q "$work/output.txt" "tests/$name.txt" > /dev/null; then
+            echo "FAIL $name $mode"
+            failed=1
+        fi
+    done
+done
+
+rm -rf "$work"
+
+if [ $failed -eq 0 ]; then
+    echo "all tests passed"
+fi
+
+exit $failed
@@ -0,0 +1,26 @@
+int p(int x) {
+    print(x);
+
+    return x;
+}
+
+int main() {
+    if (p(0) && p(1)) {
+        print(10);
+    }
+
+    if (p(2) || p(3)) {
+        print(20);
+    }
+
+    int a = p(4) && p(0);
+    int b = p(0) || p(5);
+    print(a + b);
+
+    int d = 0;
+    if (d != 0 && 10 / d > 1) {
+        print(30);
+    }
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+int walk(int n, int mode) {
+    if (n == 0) {
+        return 0;
+    }
+
+    if (mode == 1) {
+        print(n);
+    }
+
+    if (mode == 2) {
+        print(n * 10);
+    }
+
+    return walk(n - 1, mode) + n;
+}
+
+int countdown(int n, int step) {
+    print(n);
+
+    while (n > step) {
+        n = n - step;
+    }
+
+    if (n <= 0) {
+        return n;
+    }
+
+    return countdown(n - 1, 2);
+}
+
+int main() {
+    int three = 0;
+    while (three * three < 9) {
+        three = three + 1;
+    }
+
+    print(walk(three, 1));
+    print(walk(three - 1, 1));
+    print(walk(three - 1, 2));
+
+    int i = 0;
+    while (i < 2) {
+        print(walk(1, 3));
+        print(countdown(9 + i, 4));
+        i = i + 1;
+    }
+
+    return 0;
+}
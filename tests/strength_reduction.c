@@ -0,0 +1,54 @@
+int scaled_sum(int n) {
+    int i = 0;
+    int s = 0;
+
+    while (i < 1000) {
+        s = s + i * 4;
+        i = i + 1;
+    }
+
+    print(s + n);
+
+    return 0;
+}
+
+int countdown(int n) {
+    int s = 0;
+
+    while (n > 0) {
+        s = s + n * 3;
+        n = n - 1;
+    }
+
+    print(s);
+
+    return 0;
+}
+
+int invariant_factor(int limit, int square) {
+    int k = 0;
+    while (k * k < square) {
+        k = k + 1;
+    }
+
+    int i = 0;
+    int s = 0;
+
+    while (s < limit) {
+        s = s + i * k + 1;
+        i = i + 1;
+    }
+
+    print(s);
+
+    return 0;
+}
+
+int main() {
+    int r = scaled_sum(0);
+    r = countdown(500);
+    r = invariant_factor(100000, 49);
+    r = invariant_factor(50, 0);
+
+    return r;
+}